@@ -6,10 +6,56 @@ import socket
 CURRENT_REQUEST_VERSION = 1
 MAX_REQUEST_DATA_SIZE = 32
 MAX_PACKET_SIZE = 48
+MAX_REPLY_DATA_SIZE = 1024
+MAX_REPLY_SIZE = 16 + MAX_REPLY_DATA_SIZE
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
     WriteMemory = 2
+    ReadCallStats = 3
+    StartMemoryScan = 4
+    MemoryScan = 5
+    ReadMemoryScanResults = 6
+    AddMemoryWatch = 7
+    RemoveMemoryWatch = 8
+    ReadMemoryWatchHits = 9
+
+class ScanValueType(enum.IntEnum):
+    U8 = 0
+    U16 = 1
+    U32 = 2
+    U64 = 3
+    Float = 4
+    Double = 5
+
+class ScanComparison(enum.IntEnum):
+    Equal = 0
+    NotEqual = 1
+    Less = 2
+    LessOrEqual = 3
+    Greater = 4
+    GreaterOrEqual = 5
+    Changed = 6
+    Unchanged = 7
+    Increased = 8
+    Decreased = 9
+    IncreasedBy = 10
+    DecreasedBy = 11
+
+SCAN_VALUE_FORMATS = {
+    ScanValueType.U8: "B",
+    ScanValueType.U16: "H",
+    ScanValueType.U32: "I",
+    ScanValueType.U64: "Q",
+    ScanValueType.Float: "f",
+    ScanValueType.Double: "d",
+}
+MEMORY_SCAN_RESULT_SIZE = 16
+MAX_MEMORY_SCAN_RESULTS = MAX_REPLY_DATA_SIZE // MEMORY_SCAN_RESULT_SIZE
+MEMORY_WATCH_READ = 1 << 0
+MEMORY_WATCH_WRITE = 1 << 1
+MEMORY_WATCH_HIT_SIZE = 28
+MAX_MEMORY_WATCH_HITS = MAX_REPLY_DATA_SIZE // MEMORY_WATCH_HIT_SIZE
 
 CITRA_PORT = 45987
 
@@ -17,6 +63,7 @@ class Citra:
     def __init__(self, address="127.0.0.1", port=CITRA_PORT):
         self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
         self.address = address
+        self.scan_value_type = ScanValueType.U32
 
     def is_connected(self):
         return self.socket is not None
@@ -90,6 +137,128 @@ class Citra:
                 return False
         return True
 
+    def read_call_stats(self):
+        """
+        Returns the SVC and service command statistics of the session as a JSON string.
+        """
+        result = bytes()
+        while True:
+            request_data = struct.pack("I", len(result))
+            request, request_id = self._generate_header(RequestType.ReadCallStats, len(request_data))
+            request += request_data
+            self.socket.sendto(request, (self.address, CITRA_PORT))
+
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ReadCallStats)
+
+            if reply_data is None:
+                return None
+            result += reply_data
+            if len(reply_data) < MAX_REQUEST_DATA_SIZE:
+                return result.decode()
+
+    def _send_request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_REPLY_SIZE)
+        return self._read_and_validate_header(raw_reply, request_id, request_type)
+
+    def start_memory_scan(self, value_type):
+        """
+        Starts a search of the emulated RAM for a value whose initial value is unknown.
+        Returns the number of candidates.
+        >>> c.start_memory_scan(ScanValueType.U32) > 0
+        True
+        """
+        reply_data = self._send_request(RequestType.StartMemoryScan, struct.pack("I", value_type))
+        if not reply_data:
+            return None
+        self.scan_value_type = ScanValueType(value_type)
+        return struct.unpack("Q", reply_data)[0]
+
+    def memory_scan(self, comparison, value=0):
+        """
+        Keeps the candidates of the current search that match the comparison, value is of the
+        type the search was started with. Returns the number of remaining candidates.
+        """
+        raw_value = struct.pack(SCAN_VALUE_FORMATS[self.scan_value_type], value).ljust(8, b"\0")
+        request_data = struct.pack("I", comparison) + raw_value
+        reply_data = self._send_request(RequestType.MemoryScan, request_data)
+        if not reply_data:
+            return None
+        return struct.unpack("Q", reply_data)[0]
+
+    def read_memory_scan_results(self, first=0, count=100):
+        """
+        Returns up to count candidates of the current search, starting with the first-th one, as
+        (physical address, virtual address or None, value) tuples.
+        """
+        value_format = SCAN_VALUE_FORMATS[self.scan_value_type]
+        value_size = struct.calcsize(value_format)
+        results = []
+        while count > 0:
+            request_count = min(count, MAX_MEMORY_SCAN_RESULTS)
+            request_data = struct.pack("II", first, request_count)
+            reply_data = self._send_request(RequestType.ReadMemoryScanResults, request_data)
+            if reply_data is None:
+                return None
+
+            for offset in range(0, len(reply_data), MEMORY_SCAN_RESULT_SIZE):
+                physical_address, virtual_address = struct.unpack_from("II", reply_data, offset)
+                value = struct.unpack(value_format, reply_data[offset + 8:offset + 8 + value_size])[0]
+                results.append((physical_address, virtual_address or None, value))
+
+            received = len(reply_data) // MEMORY_SCAN_RESULT_SIZE
+            if received < request_count:
+                break
+            first += received
+            count -= received
+        return results
+
+    def _memory_watch_request(self, request_type, address, size, read, write):
+        flags = (MEMORY_WATCH_READ if read else 0) | (MEMORY_WATCH_WRITE if write else 0)
+        request_data = struct.pack("III", address, size, flags)
+        return self._send_request(request_type, request_data) is not None
+
+    def add_memory_watch(self, address, size, read=True, write=True):
+        """
+        Starts recording the reads and/or writes of the CPU to a range of the current process.
+        Only the pages of the range are slowed down.
+        """
+        return self._memory_watch_request(RequestType.AddMemoryWatch, address, size, read, write)
+
+    def remove_memory_watch(self, address, size, read=True, write=True):
+        """
+        Stops recording the accesses to a range added with the same arguments.
+        """
+        return self._memory_watch_request(RequestType.RemoveMemoryWatch, address, size, read, write)
+
+    def read_memory_watch_hits(self, count=100):
+        """
+        Removes up to count of the oldest recorded accesses to the watched ranges, and returns
+        them as (tick, pc, address, size, is_write, value) tuples.
+        """
+        hits = []
+        while count > 0:
+            request_count = min(count, MAX_MEMORY_WATCH_HITS)
+            reply_data = self._send_request(RequestType.ReadMemoryWatchHits,
+                                            struct.pack("I", request_count))
+            if reply_data is None:
+                return None
+
+            for offset in range(0, len(reply_data), MEMORY_WATCH_HIT_SIZE):
+                tick, value, pc, address, size_and_flags = struct.unpack_from("QQIII", reply_data, offset)
+                is_write = (size_and_flags >> 8) & MEMORY_WATCH_WRITE != 0
+                hits.append((tick, pc, address, size_and_flags & 0xFF, is_write, value))
+
+            received = len(reply_data) // MEMORY_WATCH_HIT_SIZE
+            if received < request_count:
+                break
+            count -= received
+        return hits
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
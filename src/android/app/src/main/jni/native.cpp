@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <regex>
 #include <thread>
@@ -43,6 +44,7 @@
 #include "jni/ndk_motion.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filterer.h"
+#include "video_core/video_core.h"
 
 namespace {
 
@@ -197,7 +199,7 @@ static Core::System::ResultStatus RunCitra(const std::string& filepath) {
     LoadDiskCacheProgress(VideoCore::LoadCallbackStage::Prepare, 0, 0);
 
     std::unique_ptr<Frontend::GraphicsContext> cpu_context;
-    system.Renderer().Rasterizer()->LoadDiskResources(stop_run, &LoadDiskCacheProgress);
+    VideoCore::LoadDiskResources(stop_run, &LoadDiskCacheProgress);
 
     LoadDiskCacheProgress(VideoCore::LoadCallbackStage::Complete, 0, 0);
 
@@ -241,8 +243,11 @@ static Core::System::ResultStatus RunCitra(const std::string& filepath) {
             SCOPE_EXIT({ Settings::values.volume = volume; });
             Settings::values.volume = 0;
 
+            // Wake up regularly to run the work other threads queue for the emulation thread
+            system.RunQueuedWork();
             std::unique_lock<std::mutex> pause_lock(paused_mutex);
-            running_cv.wait(pause_lock, [] { return !pause_emulation || stop_run; });
+            running_cv.wait_for(pause_lock, std::chrono::milliseconds(10),
+                                [] { return !pause_emulation || stop_run; });
             window->PollEvents();
         }
     }
@@ -286,7 +291,8 @@ void Java_org_citra_citra_1emu_NativeLibrary_NotifyOrientationChange(JNIEnv* env
                                                                      jint rotation) {
     Settings::values.layout_option = static_cast<Settings::LayoutOption>(layout_option);
     if (VideoCore::g_renderer) {
-        VideoCore::g_renderer->UpdateCurrentFramebufferLayout(!(rotation % 2));
+        VideoCore::RunOnRenderer(
+            [rotation] { VideoCore::g_renderer->UpdateCurrentFramebufferLayout(!(rotation % 2)); });
     }
     InputManager::screen_rotation = rotation;
     Camera::NDK::g_rotation = rotation;
@@ -296,7 +302,8 @@ void Java_org_citra_citra_1emu_NativeLibrary_SwapScreens(JNIEnv* env, [[maybe_un
                                                          jboolean swap_screens, jint rotation) {
     Settings::values.swap_screen = swap_screens;
     if (VideoCore::g_renderer) {
-        VideoCore::g_renderer->UpdateCurrentFramebufferLayout(!(rotation % 2));
+        VideoCore::RunOnRenderer(
+            [rotation] { VideoCore::g_renderer->UpdateCurrentFramebufferLayout(!(rotation % 2)); });
     }
     InputManager::screen_rotation = rotation;
     Camera::NDK::g_rotation = rotation;
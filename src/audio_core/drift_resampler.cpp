@@ -0,0 +1,107 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/audio_types.h"
+#include "audio_core/drift_resampler.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+void DriftResampler::SetOutputSampleRate(unsigned int sample_rate) {
+    nominal_ratio = static_cast<double>(native_sample_rate) / static_cast<double>(sample_rate);
+    ratio = nominal_ratio;
+}
+
+std::size_t DriftResampler::Update(std::size_t queued, std::size_t target, std::size_t num_out) {
+    target = std::max<std::size_t>(target, 1);
+    const double time_delta = static_cast<double>(num_out) / native_sample_rate; // seconds
+
+    // After running dry, wait for the FIFO to refill up to the target before resuming. Otherwise
+    // the FIFO would stay (nearly) empty and every burst of jitter would cause another underrun.
+    if (priming && queued >= target) {
+        priming = false;
+    }
+
+    // Track how much of the time is spent refilling; this tells whether emulation keeps up.
+    constexpr double starve_time_scale = 1.0; // seconds
+    const double starve_gain = 1.0 - std::exp(-time_delta / starve_time_scale);
+    starve_level += starve_gain * ((priming ? 1.0 : 0.0) - starve_level);
+
+    // The DSP produces audio in bursts of whole frames, so smooth out the fill level before
+    // reacting to it. The time-scale determines how responsive this filter is.
+    constexpr double lpf_time_scale = 0.100; // seconds
+    const double lpf_gain = 1.0 - std::exp(-time_delta / lpf_time_scale);
+    const double current_level = static_cast<double>(queued) / static_cast<double>(target);
+    fill_level += lpf_gain * (current_level - fill_level);
+
+    // Consume slightly faster when the FIFO is above target and slightly slower when below it.
+    // The integral term settles on the actual clock drift, so that the FIFO converges to the
+    // target instead of some fixed offset from it. The correction is kept small enough for the
+    // pitch change to be inaudible.
+    constexpr double proportional_gain = 0.01;
+    constexpr double integral_gain = 0.005; // per second
+    const double error = fill_level - 1.0;
+    drift = std::clamp(drift + integral_gain * error * time_delta, -max_drift, max_drift);
+    const double correction = std::clamp(proportional_gain * error + drift, -max_drift, max_drift);
+    ratio = nominal_ratio * (1.0 + correction);
+
+    LOG_TRACE(Audio, "queued:{:5} target:{:5} ratio:{:0.6f} fill:{:0.6f}", queued, target, ratio,
+              fill_level);
+
+    if (priming) {
+        return 0;
+    }
+    return static_cast<std::size_t>(position + ratio * static_cast<double>(num_out));
+}
+
+std::size_t DriftResampler::Process(const s16* in, std::size_t num_in, s16* out,
+                                    std::size_t num_out) {
+    std::size_t consumed = 0;
+    std::size_t written = 0;
+    while (true) {
+        // Shift in the input frames that the read position has moved past.
+        while (position >= 1.0 && consumed < num_in) {
+            history[0] = history[1];
+            history[1] = {in[consumed * 2 + 0], in[consumed * 2 + 1]};
+            ++consumed;
+            position -= 1.0;
+        }
+        if (written == num_out || position >= 1.0) {
+            break;
+        }
+
+        for (std::size_t channel = 0; channel < 2; ++channel) {
+            const double a = history[0][channel];
+            const double b = history[1][channel];
+            out[written * 2 + channel] = static_cast<s16>(std::lround(a + (b - a) * position));
+        }
+        ++written;
+        position += ratio;
+    }
+    if (written < num_out && !priming) {
+        LOG_TRACE(Audio, "Output FIFO ran dry");
+        priming = true;
+    }
+    return written;
+}
+
+bool DriftResampler::IsStarved() const {
+    // Drift alone never drains the FIFO, so frequently refilling it means emulation is running
+    // noticeably slower than full speed.
+    return starve_level > 0.05;
+}
+
+void DriftResampler::Clear() {
+    ratio = nominal_ratio;
+    fill_level = 1.0;
+    drift = 0.0;
+    starve_level = 0.0;
+    priming = true;
+    position = 0.0;
+    history = {};
+}
+
+} // namespace AudioCore
@@ -0,0 +1,64 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Low-latency alternative to TimeStretcher. Instead of stretching audio through a large backlog,
+ * this resamples straight out of the output FIFO and nudges the conversion ratio by a small amount
+ * to keep the FIFO close to a target fill level. This compensates for clock drift between the
+ * emulated DSP and the host audio device, but only works while emulation runs near full speed.
+ */
+class DriftResampler {
+public:
+    /// Largest relative deviation from the nominal conversion ratio used to correct drift
+    static constexpr double max_drift = 0.01;
+
+    void SetOutputSampleRate(unsigned int sample_rate);
+
+    /**
+     * Updates the conversion ratio for the next output period from the FIFO fill level.
+     * @param queued   Number of frames currently waiting in the FIFO
+     * @param target   Number of frames that should ideally be waiting in the FIFO
+     * @param num_out  Number of frames that are going to be requested from Process
+     * @returns Number of input frames Process needs to produce `num_out` output frames
+     */
+    std::size_t Update(std::size_t queued, std::size_t target, std::size_t num_out);
+
+    /// @param in       Input sample buffer
+    /// @param num_in   Number of input frames in `in`
+    /// @param out      Output sample buffer
+    /// @param num_out  Desired number of output frames in `out`
+    /// @returns Actual number of frames written to `out`
+    std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+
+    /// Returns true if the FIFO keeps running dry, i.e. emulation is not keeping up.
+    bool IsStarved() const;
+
+    /// Resets the resampler. Output only resumes once the FIFO has been filled up to the target.
+    void Clear();
+
+private:
+    double nominal_ratio = 1.0;
+    double ratio = 1.0;
+    /// Low-pass filtered FIFO fill level relative to the target (1.0 means on target)
+    double fill_level = 1.0;
+    /// Estimated relative drift between the DSP and the host audio device
+    double drift = 0.0;
+    /// Low-pass filtered fraction of time spent waiting for the FIFO to refill
+    double starve_level = 0.0;
+    /// Whether output is paused until the FIFO reaches the target again
+    bool priming = true;
+    /// Fractional read position between the two frames of history
+    double position = 0.0;
+    std::array<std::array<s16, 2>, 2> history{};
+};
+
+} // namespace AudioCore
@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
 #include "core/settings.h"
@@ -21,6 +23,7 @@ void DspInterface::SetSink(const std::string& sink_id, const std::string& audio_
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
     time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+    drift_resampler.SetOutputSampleRate(sink->GetNativeSampleRate());
 }
 
 Sink& DspInterface::GetSink() {
@@ -38,11 +41,38 @@ void DspInterface::EnableStretching(bool enable) {
     perform_time_stretching = enable;
 }
 
+void DspInterface::EnableLowLatency(bool enable, u32 target_ms) {
+    // The FIFO holds audio at the native sample rate, so the target does not depend on the sink.
+    const std::size_t target = enable ? std::clamp<std::size_t>(
+                                            target_ms * native_sample_rate / 1000, 1,
+                                            fifo.Capacity() / 2)
+                                      : 0;
+    low_latency_target = target;
+}
+
+DspInterface::OutputStats DspInterface::GetAndResetOutputStats() {
+    return {output_underruns.exchange(0), output_overruns.exchange(0)};
+}
+
+std::size_t DspInterface::GetOutputBufferLevel() const {
+    return fifo.Size();
+}
+
+void DspInterface::PushToFifo(const void* frames, std::size_t num_frames) {
+    if (fifo.Push(frames, num_frames) < num_frames) {
+        ++output_overruns;
+    }
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink)
         return;
 
-    fifo.Push(frame.data(), frame.size());
+    if (sink->IsRealTime()) {
+        PushToFifo(frame.data(), frame.size());
+    } else {
+        sink->PushSamples(frame[0].data(), frame.size());
+    }
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioFrame(std::move(frame));
@@ -53,16 +83,79 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
     if (!sink)
         return;
 
-    fifo.Push(&sample, 1);
+    if (sink->IsRealTime()) {
+        PushToFifo(sample.data(), 1);
+    } else {
+        sink->PushSamples(sample.data(), 1);
+    }
 
     if (Core::System::GetInstance().VideoDumper().IsDumping()) {
         Core::System::GetInstance().VideoDumper().AddAudioSample(std::move(sample));
     }
 }
 
+std::size_t DspInterface::OutputLowLatency(s16* buffer, std::size_t num_frames,
+                                           std::size_t target) {
+    std::size_t queued = fifo.Size();
+
+    // Far too much audio has piled up (e.g. after a stall of the sink), drop the excess instead of
+    // slowly resampling it away.
+    if (queued > 4 * target) {
+        const std::size_t excess = queued - target;
+        resample_buffer.resize(excess * 2);
+        queued -= fifo.Pop(resample_buffer.data(), excess);
+        ++output_overruns;
+    }
+
+    const std::size_t num_in = drift_resampler.Update(queued, target, num_frames);
+    if (num_in == 0) {
+        return 0;
+    }
+    resample_buffer.resize(num_in * 2);
+    const std::size_t popped = fifo.Pop(resample_buffer.data(), num_in);
+    return drift_resampler.Process(resample_buffer.data(), popped, buffer, num_frames);
+}
+
+void DspInterface::UpdateLowLatencyFallback(std::size_t target, std::size_t num_frames) {
+    if (target == 0) {
+        low_latency_fallback = false;
+        return;
+    }
+
+    if (!low_latency_fallback) {
+        // Drift compensation can not make up for emulation running slow, stretch instead.
+        if (perform_time_stretching && drift_resampler.IsStarved()) {
+            LOG_DEBUG(Audio, "Emulation is not keeping up, falling back to audio stretching");
+            low_latency_fallback = true;
+            fallback_frames = 0;
+            time_stretcher.Clear();
+        }
+        return;
+    }
+
+    // Give the stretcher some time to settle before checking whether emulation is back to
+    // (nearly) full speed, to avoid rapidly switching back and forth.
+    constexpr std::size_t min_fallback_frames = 2 * native_sample_rate;
+    fallback_frames += num_frames;
+    if (!perform_time_stretching ||
+        (fallback_frames >= min_fallback_frames &&
+         time_stretcher.GetStretchRatio() >= 1.0 - DriftResampler::max_drift)) {
+        LOG_DEBUG(Audio, "Emulation is back to full speed, resuming low-latency output");
+        low_latency_fallback = false;
+        flushing_time_stretcher = perform_time_stretching.load();
+        drift_resampler.Clear();
+    }
+}
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
+    const std::size_t target = low_latency_target;
+    UpdateLowLatencyFallback(target, num_frames);
+    const bool low_latency = target != 0 && !low_latency_fallback;
+
     std::size_t frames_written;
-    if (perform_time_stretching) {
+    if (low_latency && !flushing_time_stretcher) {
+        frames_written = OutputLowLatency(buffer, num_frames, target);
+    } else if (perform_time_stretching && !low_latency) {
         const std::vector<s16> in{fifo.Pop()};
         const std::size_t num_in{in.size() / 2};
         frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
@@ -79,6 +172,12 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
     }
 
+    const bool starved = frames_written < num_frames;
+    if (starved && !output_starved) {
+        ++output_underruns;
+    }
+    output_starved = starved;
+
     // Hold last emitted frame; this prevents popping.
     for (std::size_t i = frames_written; i < num_frames; i++) {
         std::memcpy(buffer + 2 * i, &last_frame[0], 2 * sizeof(s16));
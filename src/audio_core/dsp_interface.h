@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <boost/serialization/access.hpp>
 #include "audio_core/audio_types.h"
+#include "audio_core/drift_resampler.h"
 #include "audio_core/time_stretch.h"
 #include "common/common_types.h"
 #include "common/ring_buffer.h"
@@ -99,6 +101,26 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /**
+     * Enable/Disable the low-latency output mode. In this mode, the output FIFO is kept close to
+     * the target size by drift-compensated resampling. Audio stretching is only used as a
+     * fallback while emulation runs well below full speed.
+     * @param target_ms Amount of audio to keep buffered ahead of the sink, in milliseconds
+     */
+    void EnableLowLatency(bool enable, u32 target_ms);
+
+    struct OutputStats {
+        /// Number of times the sink requested more audio than was available
+        u32 underruns;
+        /// Number of times audio was dropped because the output FIFO was full
+        u32 overruns;
+    };
+
+    /// Returns the output statistics accumulated since the last call, and resets them.
+    OutputStats GetAndResetOutputStats();
+
+    /// Returns the number of audio frames currently queued for the sink.
+    std::size_t GetOutputBufferLevel() const;
 
 protected:
     void OutputFrame(StereoFrame16 frame);
@@ -107,12 +129,29 @@ protected:
 private:
     void FlushResidualStretcherAudio();
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    std::size_t OutputLowLatency(s16* buffer, std::size_t num_frames, std::size_t target);
+    void UpdateLowLatencyFallback(std::size_t target, std::size_t num_frames);
+    void PushToFifo(const void* frames, std::size_t num_frames);
 
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
+    /// Target size of the output FIFO in frames, or 0 if the low-latency mode is disabled
+    std::atomic<std::size_t> low_latency_target = 0;
+    std::atomic<u32> output_underruns = 0;
+    std::atomic<u32> output_overruns = 0;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
+
+    // The following are only accessed from the sink thread.
+    DriftResampler drift_resampler;
+    std::vector<s16> resample_buffer;
+    /// Whether the low-latency mode is temporarily falling back to audio stretching
+    bool low_latency_fallback = false;
+    /// Number of frames output since the fallback started
+    std::size_t fallback_frames = 0;
+    /// Whether the previous callback ran out of audio
+    bool output_starved = false;
     std::unique_ptr<Sink> sink;
 
     template <class Archive>
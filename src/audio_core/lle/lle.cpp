@@ -9,6 +9,8 @@
 #include "audio_core/lle/lle.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/microprofile.h"
+#include "common/scope_exit.h"
 #include "common/swap.h"
 #include "common/thread.h"
 #include "core/core.h"
@@ -18,6 +20,8 @@
 
 namespace AudioCore {
 
+MICROPROFILE_DEFINE(Audio_Teakra, "Audio", "Teakra", MP_RGB(100, 200, 100));
+
 enum class SegmentType : u8 {
     ProgramA = 0,
     ProgramB = 1,
@@ -149,8 +153,13 @@ struct DspLle::Impl final {
     static constexpr u32 TeakraSlice = 16384;
 
     void TeakraThread() {
+        MicroProfileOnThreadCreate("Teakra");
+        SCOPE_EXIT({ MicroProfileOnThreadExit(); });
         while (true) {
-            teakra.Run(TeakraSlice);
+            {
+                MICROPROFILE_SCOPE(Audio_Teakra);
+                teakra.Run(TeakraSlice);
+            }
             teakra_slice_barrier.Sync();
             if (stop_signal) {
                 if (stop_generation == teakra_slice_barrier.Generation())
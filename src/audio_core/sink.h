@@ -30,6 +30,22 @@ public:
      * @param sample_count Number of samples.
      */
     virtual void SetCallback(std::function<void(s16*, std::size_t)> cb) = 0;
+
+    /**
+     * Whether this sink pulls samples at the pace of a host audio device through its callback.
+     * Sinks that do not (e.g. file output) are instead handed every sample through PushSamples as
+     * soon as the DSP produces it, without buffering or time stretching.
+     */
+    virtual bool IsRealTime() const {
+        return true;
+    }
+
+    /**
+     * Feeds samples to a sink that is not real-time.
+     * @param samples Samples in interleaved stereo PCM16 format.
+     * @param sample_count Number of samples.
+     */
+    virtual void PushSamples(const s16* samples, std::size_t sample_count) {}
 };
 
 } // namespace AudioCore
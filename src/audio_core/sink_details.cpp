@@ -8,6 +8,7 @@
 #include <vector>
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
+#include "audio_core/wave_sink.h"
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
@@ -51,6 +52,12 @@ constexpr SinkDetails sink_details[] = {
                     return std::make_unique<NullSink>(device_id);
                 },
                 [] { return std::vector<std::string>{"null"}; }},
+    // Never auto-selected: renders to a file whose path is given as the device ID.
+    SinkDetails{"wave",
+                [](std::string_view device_id) -> std::unique_ptr<Sink> {
+                    return std::make_unique<WaveSink>(device_id);
+                },
+                [] { return std::vector<std::string>{auto_device_name}; }},
 };
 
 const SinkDetails& GetSinkDetails(std::string_view sink_id) {
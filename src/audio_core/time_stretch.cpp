@@ -66,6 +66,10 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
     return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
 }
 
+double TimeStretcher::GetStretchRatio() const {
+    return stretch_ratio;
+}
+
 void TimeStretcher::Clear() {
     sound_touch->clear();
 }
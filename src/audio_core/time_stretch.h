@@ -29,6 +29,9 @@ public:
     /// @returns Actual number of frames written to `out`
     std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
 
+    /// Returns the current (low-pass filtered) ratio of input to output speed
+    double GetStretchRatio() const;
+
     void Clear();
 
     void Flush();
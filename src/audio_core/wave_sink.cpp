@@ -0,0 +1,145 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include "audio_core/audio_types.h"
+#include "audio_core/wave_sink.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr u16 num_channels = 2;
+constexpr u16 bits_per_sample = 16;
+constexpr u32 bytes_per_frame = num_channels * bits_per_sample / 8;
+
+struct WaveHeader {
+    std::array<char, 4> riff_magic;
+    u32_le riff_size;
+    std::array<char, 4> wave_magic;
+    std::array<char, 4> fmt_magic;
+    u32_le fmt_size;
+    u16_le format;
+    u16_le channels;
+    u32_le sample_rate;
+    u32_le byte_rate;
+    u16_le block_align;
+    u16_le bits_per_sample;
+    std::array<char, 4> data_magic;
+    u32_le data_size;
+};
+static_assert(sizeof(WaveHeader) == 44, "WaveHeader has incorrect size");
+
+/// Largest amount of whole frames whose RIFF size still fits in 32 bits
+constexpr u32 max_data_size =
+    (std::numeric_limits<u32>::max() - (sizeof(WaveHeader) - 8)) / bytes_per_frame *
+    bytes_per_frame;
+
+/// Amount of data after which the header is rewritten, so that a killed process leaves a
+/// playable file. This is about one second of audio.
+constexpr u32 header_update_interval = native_sample_rate * bytes_per_frame;
+
+WaveHeader MakeHeader(u32 data_size) {
+    WaveHeader header{};
+    header.riff_magic = {'R', 'I', 'F', 'F'};
+    header.riff_size = sizeof(WaveHeader) - 8 + data_size;
+    header.wave_magic = {'W', 'A', 'V', 'E'};
+    header.fmt_magic = {'f', 'm', 't', ' '};
+    header.fmt_size = 16;
+    header.format = 1; // PCM
+    header.channels = num_channels;
+    header.sample_rate = native_sample_rate;
+    header.byte_rate = native_sample_rate * bytes_per_frame;
+    header.block_align = bytes_per_frame;
+    header.bits_per_sample = bits_per_sample;
+    header.data_magic = {'d', 'a', 't', 'a'};
+    header.data_size = data_size;
+    return header;
+}
+
+} // Anonymous namespace
+
+struct WaveSink::Impl {
+    FileUtil::IOFile file;
+    u32 data_size = 0;
+    u32 header_data_size = 0;
+
+    /// Patches the sizes in the header, then returns to the end of the data
+    void UpdateHeader() {
+        file.Seek(0, SEEK_SET);
+        file.WriteObject(MakeHeader(data_size));
+        file.Seek(0, SEEK_END);
+        file.Flush();
+        header_data_size = data_size;
+    }
+};
+
+WaveSink::WaveSink(std::string_view path) : impl(std::make_unique<Impl>()) {
+    std::string filename{path};
+    if (filename.empty() || filename == auto_device_name) {
+        filename = FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) + "audio.wav";
+    }
+
+    if (!FileUtil::CreateFullPath(filename)) {
+        LOG_ERROR(Audio_Sink, "Could not create path {}", filename);
+    }
+
+    impl->file = FileUtil::IOFile(filename, "wb");
+    if (!impl->file.IsOpen()) {
+        LOG_CRITICAL(Audio_Sink, "Could not open {} for writing", filename);
+        return;
+    }
+
+    // The sizes are patched in periodically and once the sink is destroyed.
+    impl->file.WriteObject(MakeHeader(0));
+    LOG_INFO(Audio_Sink, "Writing audio output to {}", filename);
+}
+
+WaveSink::~WaveSink() {
+    if (!impl->file.IsOpen())
+        return;
+
+    impl->UpdateHeader();
+    impl->file.Close();
+}
+
+unsigned int WaveSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void WaveSink::SetCallback(std::function<void(s16*, std::size_t)>) {}
+
+bool WaveSink::IsRealTime() const {
+    return false;
+}
+
+void WaveSink::PushSamples(const s16* samples, std::size_t sample_count) {
+    if (!impl->file.IsOpen())
+        return;
+
+    // WAV files can't hold more than 4 GiB, stop recording once that is reached
+    const std::size_t max_frames = (max_data_size - impl->data_size) / bytes_per_frame;
+    const std::size_t frame_count = std::min(sample_count, max_frames);
+    const std::size_t written = impl->file.WriteArray(samples, frame_count * num_channels);
+    impl->data_size += static_cast<u32>(written * sizeof(s16));
+
+    if (frame_count < sample_count) {
+        LOG_WARNING(Audio_Sink, "Audio output reached the maximum WAV file size, stopping");
+        impl->UpdateHeader();
+        impl->file.Close();
+        return;
+    }
+    if (impl->data_size - impl->header_data_size >= header_update_interval) {
+        impl->UpdateHeader();
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,37 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Sink that renders audio to a WAV file instead of a host audio device. Samples are written as
+ * soon as the DSP produces them, so the output is deterministic and is not paced to real time.
+ */
+class WaveSink final : public Sink {
+public:
+    /// @param path Path of the file to write, or "auto" to write to the dump directory.
+    explicit WaveSink(std::string_view path);
+    ~WaveSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void SetCallback(std::function<void(s16*, std::size_t)> cb) override;
+
+    bool IsRealTime() const override;
+
+    void PushSamples(const s16* samples, std::size_t sample_count) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace AudioCore
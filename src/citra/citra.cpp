@@ -15,6 +15,7 @@
 #include "common/detached_tasks.h"
 #include "common/file_util.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
@@ -31,6 +32,7 @@
 #include "input_common/main.h"
 #include "network/network.h"
 #include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
 
 #undef _UNICODE
 #include <getopt.h>
@@ -61,6 +63,11 @@ static void PrintHelp(const char* argv0) {
                  "-a, --movie-record-author=AUTHOR Sets the author of the movie to be recorded\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "-t, --trace-out=FILE  Write a Chrome trace of the profiling scopes recorded in\n"
+                 "                       the last frames before exit to FILE\n"
+                 "-b, --binary-log=FILE  Record the log messages to the binary log FILE, which\n"
+                 "                       citra-log-decoder turns into text\n"
+                 "-B, --binary-log-filter=FILTER  Log filter of the binary log (default *:Trace)\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -191,6 +198,9 @@ int main(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    std::string trace_out;
+    std::string binary_log;
+    std::string binary_log_filter = "*:Trace";
 
     InitializeLogging();
 
@@ -221,6 +231,9 @@ int main(int argc, char** argv) {
         {"movie-record-author", required_argument, 0, 'a'},
         {"movie-play", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
+        {"trace-out", required_argument, 0, 't'},
+        {"binary-log", required_argument, 0, 'b'},
+        {"binary-log-filter", required_argument, 0, 'B'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -228,7 +241,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:t:b:B:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -297,6 +310,15 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 't':
+                trace_out = optarg;
+                break;
+            case 'b':
+                binary_log = optarg;
+                break;
+            case 'B':
+                binary_log_filter = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -324,6 +346,19 @@ int main(int argc, char** argv) {
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
+    if (!trace_out.empty()) {
+        Common::Profiling::EnableTraceCapture();
+    }
+
+    if (!binary_log.empty()) {
+        Log::Filter filter(Log::Level::Trace);
+        filter.ParseFilterString(binary_log_filter);
+        if (!Log::StartBinaryLog(binary_log, filter)) {
+            LOG_CRITICAL(Frontend, "Failed to open binary log {}", binary_log);
+            return -1;
+        }
+    }
+    SCOPE_EXIT({ Log::StopBinaryLog(); });
 
     if (filepath.empty()) {
         LOG_CRITICAL(Frontend, "Failed to load ROM: No ROM specified");
@@ -445,7 +480,7 @@ int main(int argc, char** argv) {
     });
 
     std::atomic_bool stop_run;
-    system.Renderer().Rasterizer()->LoadDiskResources(
+    VideoCore::LoadDiskResources(
         stop_run, [](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
             LOG_DEBUG(Frontend, "Loading stage {} progress {} {}", static_cast<u32>(stage), value,
                       total);
@@ -484,6 +519,15 @@ int main(int argc, char** argv) {
     Network::Shutdown();
     InputCommon::Shutdown();
 
+    // Write the trace before shutting down, as exiting threads discard their profiling data
+    if (!trace_out.empty()) {
+        if (Common::Profiling::WriteChromeTrace(trace_out)) {
+            LOG_INFO(Frontend, "Wrote profiling trace to {}", trace_out);
+        } else {
+            LOG_ERROR(Frontend, "Failed to write profiling trace to {}", trace_out);
+        }
+    }
+
     system.Shutdown();
 
     detached_tasks.WaitForAllTasks();
@@ -131,11 +131,26 @@ use_vsync_new =
 # 0: Off, 1 (default. On)
 use_disk_shader_cache =
 
+# Emulate the GPU on a separate thread, so that it runs in parallel with the CPU emulation
+# 0 (default): Off, 1: On
+use_async_gpu =
+
+# Compile new shaders in the background and draw with a generic shader until they are ready.
+# On Vulkan, new pipelines are also built in the background, skipping the draws that need them.
+# Reduces stuttering when new effects appear, at the cost of slower rendering meanwhile.
+# 0 (default): Off, 1: On
+async_shader_compilation =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
 resolution_factor =
 
+# Host memory budget of the texture cache, in MiB. When it is exceeded, the least recently used
+# textures are written back to emulated memory and freed at the end of the frame.
+# 0 (default): Unlimited, Otherwise the budget in MiB
+surface_cache_budget =
+
 # Texture filter name
 texture_filter_name =
 
@@ -236,7 +251,8 @@ enable_dsp_lle_thread =
 
 
 # Which audio output engine to use.
-# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
+# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available),
+# wave: Render to a WAV file as fast as the emulated DSP produces audio
 output_engine =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -245,8 +261,20 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Whether or not to use the low-latency audio output mode.
+# Keeps only a small amount of audio buffered and compensates for drift by slightly resampling it.
+# Audio stretching, if enabled, is only used while emulation runs well below full speed.
+# 0 (default): No, 1: Yes
+enable_low_latency_audio =
+
+# Amount of audio to keep buffered in low-latency mode, in milliseconds.
+# Lower values reduce latency but may cause crackling. Default: 20
+audio_latency_target =
+
 # Which audio device to use.
 # auto (default): Auto-select
+# For the wave output engine, this is the path of the file to write (auto: audio.wav in the dump
+# directory). Volume and audio stretching are not applied to it.
 output_device =
 
 # Output volume.
@@ -318,6 +346,10 @@ log_filter = *:Info
 [Debugging]
 # Record frame time data, can be found in the log directory. Boolean value
 record_frame_times =
+# Write per-frame telemetry (frame times, CPU/GPU time, shader compiles, surface cache hits and
+# misses, audio buffer level) to a file in the log directory.
+# 0 (default): Disabled, 1: CSV, 2: JSON (one object per line)
+frame_telemetry_format =
 # Port for listening to GDB connections.
 use_gdbstub=false
 gdbstub_port=24689
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <QApplication>
 #include <QDragEnterEvent>
 #include <QHBoxLayout>
@@ -54,7 +55,7 @@ void EmuThread::run() {
     emit LoadProgress(VideoCore::LoadCallbackStage::Prepare, 0, 0);
 
     Core::System& system = Core::System::GetInstance();
-    system.Renderer().Rasterizer()->LoadDiskResources(
+    VideoCore::LoadDiskResources(
         stop_run, [this](VideoCore::LoadCallbackStage stage, std::size_t value, std::size_t total) {
             emit LoadProgress(stage, value, total);
         });
@@ -106,8 +107,11 @@ void EmuThread::run() {
 
             was_active = false;
         } else {
+            // Wake up regularly to run the work other threads queue for the emulation thread
+            system.RunQueuedWork();
             std::unique_lock lock{running_mutex};
-            running_cv.wait(lock, [this] { return IsRunning() || exec_step || stop_run; });
+            running_cv.wait_for(lock, std::chrono::milliseconds(10),
+                                [this] { return IsRunning() || exec_step || stop_run; });
         }
     }
 
@@ -113,6 +113,10 @@ void Config::ReadAudioValues() {
                                    .toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting(QStringLiteral("enable_audio_stretching"), true).toBool();
+    Settings::values.enable_low_latency_audio =
+        ReadSetting(QStringLiteral("enable_low_latency_audio"), false).toBool();
+    Settings::values.audio_latency_target =
+        static_cast<u16>(ReadSetting(QStringLiteral("audio_latency_target"), 20).toUInt());
     Settings::values.audio_device_id =
         ReadSetting(QStringLiteral("output_device"), QStringLiteral("auto"))
             .toString()
@@ -326,6 +330,8 @@ void Config::ReadDebuggingValues() {
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     Settings::values.record_frame_times =
         qt_config->value(QStringLiteral("record_frame_times"), false).toBool();
+    Settings::values.frame_telemetry_format = static_cast<Settings::FrameTelemetryFormat>(
+        qt_config->value(QStringLiteral("frame_telemetry_format"), 0).toInt());
     Settings::values.use_gdbstub = ReadSetting(QStringLiteral("use_gdbstub"), false).toBool();
     Settings::values.gdbstub_port = ReadSetting(QStringLiteral("gdbstub_port"), 24689).toInt();
     Settings::values.renderer_debug = ReadSetting(QStringLiteral("renderer_debug"), false).toBool();
@@ -489,6 +495,9 @@ void Config::ReadRendererValues() {
             .toUInt());
     Settings::values.physical_device = ReadSetting(QStringLiteral("physical_device"), 0).toUInt();
     Settings::values.async_command_recording = ReadSetting(QStringLiteral("async_command_recording"), true).toBool();
+    Settings::values.use_async_gpu = ReadSetting(QStringLiteral("use_async_gpu"), false).toBool();
+    Settings::values.async_shader_compilation =
+        ReadSetting(QStringLiteral("async_shader_compilation"), false).toBool();
     Settings::values.spirv_shader_gen = ReadSetting(QStringLiteral("spirv_shader_gen"), false).toBool();
     Settings::values.use_hw_renderer =
         ReadSetting(QStringLiteral("use_hw_renderer"), true).toBool();
@@ -508,6 +517,8 @@ void Config::ReadRendererValues() {
     Settings::values.use_vsync_new = ReadSetting(QStringLiteral("use_vsync_new"), true).toBool();
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting(QStringLiteral("resolution_factor"), 1).toInt());
+    Settings::values.surface_cache_budget =
+        ReadSetting(QStringLiteral("surface_cache_budget"), 0).toUInt();
     Settings::values.frame_limit = ReadSetting(QStringLiteral("frame_limit"), 100).toInt();
     Settings::values.use_frame_limit_alternate =
         ReadSetting(QStringLiteral("use_frame_limit_alternate"), false).toBool();
@@ -752,6 +763,10 @@ void Config::SaveAudioValues() {
                  QStringLiteral("auto"));
     WriteSetting(QStringLiteral("enable_audio_stretching"),
                  Settings::values.enable_audio_stretching, true);
+    WriteSetting(QStringLiteral("enable_low_latency_audio"),
+                 Settings::values.enable_low_latency_audio, false);
+    WriteSetting(QStringLiteral("audio_latency_target"), Settings::values.audio_latency_target,
+                 20);
     WriteSetting(QStringLiteral("output_device"),
                  QString::fromStdString(Settings::values.audio_device_id), QStringLiteral("auto"));
     WriteSetting(QStringLiteral("volume"), Settings::values.volume, 1.0f);
@@ -893,6 +908,8 @@ void Config::SaveDebuggingValues() {
 
     // Intentionally not using the QT default setting as this is intended to be changed in the ini
     qt_config->setValue(QStringLiteral("record_frame_times"), Settings::values.record_frame_times);
+    qt_config->setValue(QStringLiteral("frame_telemetry_format"),
+                        static_cast<int>(Settings::values.frame_telemetry_format));
     WriteSetting(QStringLiteral("use_gdbstub"), Settings::values.use_gdbstub, false);
     WriteSetting(QStringLiteral("gdbstub_port"), Settings::values.gdbstub_port, 24689);
     WriteSetting(QStringLiteral("renderer_debug"), Settings::values.renderer_debug, false);
@@ -1012,6 +1029,9 @@ void Config::SaveRendererValues() {
                  static_cast<u32>(Settings::GraphicsAPI::OpenGL));
     WriteSetting(QStringLiteral("physical_device"), Settings::values.physical_device, 0);
     WriteSetting(QStringLiteral("async_command_recording"), Settings::values.async_command_recording, true);
+    WriteSetting(QStringLiteral("use_async_gpu"), Settings::values.use_async_gpu, false);
+    WriteSetting(QStringLiteral("async_shader_compilation"),
+                 Settings::values.async_shader_compilation, false);
     WriteSetting(QStringLiteral("spirv_shader_gen"), Settings::values.spirv_shader_gen, false);
     WriteSetting(QStringLiteral("use_hw_renderer"), Settings::values.use_hw_renderer, true);
     WriteSetting(QStringLiteral("use_hw_shader"), Settings::values.use_hw_shader, true);
@@ -1027,6 +1047,7 @@ void Config::SaveRendererValues() {
                  true);
     WriteSetting(QStringLiteral("use_vsync_new"), Settings::values.use_vsync_new, true);
     WriteSetting(QStringLiteral("resolution_factor"), Settings::values.resolution_factor, 1);
+    WriteSetting(QStringLiteral("surface_cache_budget"), Settings::values.surface_cache_budget, 0);
     WriteSetting(QStringLiteral("frame_limit"), Settings::values.frame_limit, 100);
     WriteSetting(QStringLiteral("use_frame_limit_alternate"),
                  Settings::values.use_frame_limit_alternate, false);
@@ -62,6 +62,15 @@ void GraphicsTracingWidget::StartRecording() {
     if (!context)
         return;
 
+    // The recording is streamed next to its destination, so ask for it up front
+    QString filename = QFileDialog::getSaveFileName(
+        this, tr("Save CiTrace"), QStringLiteral("citrace.ctf"), tr("CiTrace File (*.ctf)"));
+
+    if (filename.isEmpty()) {
+        // If the user canceled the dialog, don't start recording
+        return;
+    }
+
     auto shader_binary = Pica::g_state.vs.program_code;
     auto swizzle_data = Pica::g_state.vs.swizzle_data;
 
@@ -96,7 +105,7 @@ void GraphicsTracingWidget::StartRecording() {
     // boost::copy(TODO: Not implemented, std::back_inserter(state.gs_swizzle_data));
     // boost::copy(TODO: Not implemented, std::back_inserter(state.gs_float_uniforms));
 
-    auto recorder = new CiTrace::Recorder(state);
+    auto recorder = new CiTrace::Recorder(state, filename.toStdString());
     context->recorder = std::shared_ptr<CiTrace::Recorder>(recorder);
 
     emit SetStartTracingButtonEnabled(false);
@@ -109,15 +118,7 @@ void GraphicsTracingWidget::StopRecording() {
     if (!context)
         return;
 
-    QString filename = QFileDialog::getSaveFileName(
-        this, tr("Save CiTrace"), QStringLiteral("citrace.ctf"), tr("CiTrace File (*.ctf)"));
-
-    if (filename.isEmpty()) {
-        // If the user canceled the dialog, keep recording
-        return;
-    }
-
-    context->recorder->Finish(filename.toStdString());
+    context->recorder->Finish();
     context->recorder = nullptr;
 
     emit SetStopTracingButtonEnabled(false);
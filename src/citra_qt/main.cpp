@@ -45,6 +45,7 @@
 #include "citra_qt/hotkeys.h"
 #include "citra_qt/loading_screen.h"
 #include "citra_qt/main.h"
+#include "citra_qt/memory_search.h"
 #include "citra_qt/movie/movie_play_dialog.h"
 #include "citra_qt/movie/movie_record_dialog.h"
 #include "citra_qt/multiplayer/state.h"
@@ -666,6 +667,7 @@ void GMainWindow::RestoreUIState() {
     microProfileDialog->setVisible(UISettings::values.microprofile_visible);
 #endif
     ui->action_Cheats->setEnabled(false);
+    ui->action_Memory_Search->setEnabled(false);
 
     game_list->LoadInterfaceLayout();
 
@@ -753,6 +755,7 @@ void GMainWindow::ConnectMenuEvents() {
             &GMainWindow::OnMenuReportCompatibility);
     connect(ui->action_Configure, &QAction::triggered, this, &GMainWindow::OnConfigure);
     connect(ui->action_Cheats, &QAction::triggered, this, &GMainWindow::OnCheats);
+    connect(ui->action_Memory_Search, &QAction::triggered, this, &GMainWindow::OnMemorySearch);
 
     // View
     connect(ui->action_Single_Window_Mode, &QAction::triggered, this,
@@ -1226,6 +1229,7 @@ void GMainWindow::ShutdownGame() {
     ui->action_Stop->setEnabled(false);
     ui->action_Restart->setEnabled(false);
     ui->action_Cheats->setEnabled(false);
+    ui->action_Memory_Search->setEnabled(false);
     ui->action_Load_Amiibo->setEnabled(false);
     ui->action_Remove_Amiibo->setEnabled(false);
     ui->action_Report_Compatibility->setEnabled(false);
@@ -1649,6 +1653,7 @@ void GMainWindow::OnStartGame() {
     ui->action_Stop->setEnabled(true);
     ui->action_Restart->setEnabled(true);
     ui->action_Cheats->setEnabled(true);
+    ui->action_Memory_Search->setEnabled(true);
     ui->action_Load_Amiibo->setEnabled(true);
     ui->action_Report_Compatibility->setEnabled(true);
     ui->action_Capture_Screenshot->setEnabled(true);
@@ -1833,6 +1838,11 @@ void GMainWindow::OnCheats() {
     cheat_dialog.exec();
 }
 
+void GMainWindow::OnMemorySearch() {
+    MemorySearchDialog memory_search_dialog(this);
+    memory_search_dialog.exec();
+}
+
 void GMainWindow::OnSaveState() {
     QAction* action = qobject_cast<QAction*>(sender());
     assert(action);
@@ -205,6 +205,7 @@ private slots:
     void OnSwapScreens();
     void OnRotateScreens();
     void OnCheats();
+    void OnMemorySearch();
     void ShowFullscreen();
     void HideFullscreen();
     void ToggleWindowMode();
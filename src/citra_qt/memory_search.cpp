@@ -0,0 +1,261 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <QComboBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include "citra_qt/memory_search.h"
+#include "core/cheats/cheats.h"
+#include "core/cheats/memory_scanner.h"
+#include "core/core.h"
+
+namespace {
+
+/// Number of candidates listed in the table, there can be millions of them after the first pass
+constexpr int MAX_DISPLAYED_RESULTS = 1000;
+
+Cheats::MemoryScanner& GetScanner() {
+    return Core::System::GetInstance().CheatEngine().GetMemoryScanner();
+}
+
+/// Returns whether the comparison is with the searched value, rather than only the previous pass
+bool UsesValue(Cheats::ScanComparison comparison) {
+    switch (comparison) {
+    case Cheats::ScanComparison::Changed:
+    case Cheats::ScanComparison::Unchanged:
+    case Cheats::ScanComparison::Increased:
+    case Cheats::ScanComparison::Decreased:
+        return false;
+    default:
+        return true;
+    }
+}
+
+template <typename T>
+u64 ToBits(T value) {
+    u64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template <typename T>
+T FromBits(u64 bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+} // Anonymous namespace
+
+MemorySearchDialog::MemorySearchDialog(QWidget* parent) : QDialog(parent) {
+    setWindowTitle(tr("Memory Search"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+    resize(520, 480);
+
+    value_type = new QComboBox;
+    value_type->addItem(tr("8-bit integer"), static_cast<u32>(Cheats::ScanValueType::U8));
+    value_type->addItem(tr("16-bit integer"), static_cast<u32>(Cheats::ScanValueType::U16));
+    value_type->addItem(tr("32-bit integer"), static_cast<u32>(Cheats::ScanValueType::U32));
+    value_type->addItem(tr("64-bit integer"), static_cast<u32>(Cheats::ScanValueType::U64));
+    value_type->addItem(tr("Float"), static_cast<u32>(Cheats::ScanValueType::Float));
+    value_type->addItem(tr("Double"), static_cast<u32>(Cheats::ScanValueType::Double));
+    value_type->setCurrentIndex(2);
+
+    comparison = new QComboBox;
+    const std::pair<QString, Cheats::ScanComparison> comparisons[] = {
+        {tr("Equal to value"), Cheats::ScanComparison::Equal},
+        {tr("Not equal to value"), Cheats::ScanComparison::NotEqual},
+        {tr("Less than value"), Cheats::ScanComparison::Less},
+        {tr("Less than or equal to value"), Cheats::ScanComparison::LessOrEqual},
+        {tr("Greater than value"), Cheats::ScanComparison::Greater},
+        {tr("Greater than or equal to value"), Cheats::ScanComparison::GreaterOrEqual},
+        {tr("Changed"), Cheats::ScanComparison::Changed},
+        {tr("Unchanged"), Cheats::ScanComparison::Unchanged},
+        {tr("Increased"), Cheats::ScanComparison::Increased},
+        {tr("Decreased"), Cheats::ScanComparison::Decreased},
+        {tr("Increased by value"), Cheats::ScanComparison::IncreasedBy},
+        {tr("Decreased by value"), Cheats::ScanComparison::DecreasedBy},
+    };
+    for (const auto& [name, id] : comparisons) {
+        comparison->addItem(name, static_cast<u32>(id));
+    }
+
+    value = new QLineEdit;
+    value->setPlaceholderText(tr("Leave empty to start with an unknown value"));
+
+    button_new_search = new QPushButton(tr("New Search"));
+    button_scan = new QPushButton(tr("Next Scan"));
+    button_reset = new QPushButton(tr("Reset"));
+
+    label_results = new QLabel;
+
+    table_results = new QTableWidget(0, 3);
+    table_results->setHorizontalHeaderLabels(
+        {tr("Physical Address"), tr("Virtual Address"), tr("Value")});
+    table_results->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table_results->verticalHeader()->setVisible(false);
+    table_results->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table_results->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    auto* form = new QFormLayout;
+    form->addRow(tr("Value type:"), value_type);
+    form->addRow(tr("Comparison:"), comparison);
+    form->addRow(tr("Value:"), value);
+
+    auto* buttons = new QHBoxLayout;
+    buttons->addWidget(button_new_search);
+    buttons->addWidget(button_scan);
+    buttons->addWidget(button_reset);
+    buttons->addStretch();
+
+    auto* layout = new QVBoxLayout;
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+    layout->addWidget(label_results);
+    layout->addWidget(table_results);
+    setLayout(layout);
+
+    connect(button_new_search, &QPushButton::clicked, this, &MemorySearchDialog::OnNewSearch);
+    connect(button_scan, &QPushButton::clicked, this, &MemorySearchDialog::OnScan);
+    connect(button_reset, &QPushButton::clicked, this, &MemorySearchDialog::OnReset);
+    connect(comparison, qOverload<int>(&QComboBox::currentIndexChanged), this,
+            &MemorySearchDialog::OnComparisonChanged);
+
+    OnComparisonChanged();
+    UpdateResults();
+}
+
+MemorySearchDialog::~MemorySearchDialog() = default;
+
+void MemorySearchDialog::OnNewSearch() {
+    const auto type = static_cast<Cheats::ScanValueType>(value_type->currentData().toUInt());
+    GetScanner().NewScan(type);
+
+    // Without a value the search starts with every address, the next scans narrow it down
+    const auto scan_comparison =
+        static_cast<Cheats::ScanComparison>(comparison->currentData().toUInt());
+    if (UsesValue(scan_comparison) && !value->text().isEmpty()) {
+        OnScan();
+        return;
+    }
+    UpdateResults();
+}
+
+void MemorySearchDialog::OnScan() {
+    auto& scanner = GetScanner();
+    if (!scanner.IsSearching()) {
+        return;
+    }
+
+    const auto scan_comparison =
+        static_cast<Cheats::ScanComparison>(comparison->currentData().toUInt());
+    u64 raw_value = 0;
+    if (UsesValue(scan_comparison)) {
+        const std::optional<u64> parsed = ParseValue();
+        if (!parsed) {
+            QMessageBox::warning(this, tr("Memory Search"),
+                                 tr("The value is not valid for the type of the search."));
+            return;
+        }
+        raw_value = *parsed;
+    }
+
+    scanner.Scan(scan_comparison, raw_value);
+    UpdateResults();
+}
+
+void MemorySearchDialog::OnReset() {
+    GetScanner().Reset();
+    UpdateResults();
+}
+
+void MemorySearchDialog::OnComparisonChanged() {
+    const auto scan_comparison =
+        static_cast<Cheats::ScanComparison>(comparison->currentData().toUInt());
+    value->setEnabled(UsesValue(scan_comparison));
+}
+
+std::optional<u64> MemorySearchDialog::ParseValue() const {
+    // The search may have been started with another type than the one currently selected
+    const auto& scanner = GetScanner();
+    const QString text = value->text().trimmed();
+    bool ok = false;
+    u64 bits = 0;
+    switch (scanner.GetValueType()) {
+    case Cheats::ScanValueType::Float:
+        bits = ToBits(text.toFloat(&ok));
+        break;
+    case Cheats::ScanValueType::Double:
+        bits = ToBits(text.toDouble(&ok));
+        break;
+    default: {
+        // Accept negative values as their two's complement
+        bits = text.startsWith(QLatin1Char('-')) ? static_cast<u64>(text.toLongLong(&ok, 0))
+                                                 : text.toULongLong(&ok, 0);
+        const std::size_t size = Cheats::MemoryScanner::GetValueSize(scanner.GetValueType());
+        if (size < sizeof(u64)) {
+            bits &= (u64{1} << (size * 8)) - 1;
+        }
+        break;
+    }
+    }
+    if (!ok) {
+        return std::nullopt;
+    }
+    return bits;
+}
+
+QString MemorySearchDialog::FormatValue(u64 raw_value) const {
+    switch (GetScanner().GetValueType()) {
+    case Cheats::ScanValueType::Float:
+        return QString::number(FromBits<float>(raw_value));
+    case Cheats::ScanValueType::Double:
+        return QString::number(FromBits<double>(raw_value));
+    default:
+        return QStringLiteral("%1 (0x%2)").arg(raw_value).arg(raw_value, 0, 16);
+    }
+}
+
+void MemorySearchDialog::UpdateResults() {
+    const auto& scanner = GetScanner();
+    button_scan->setEnabled(scanner.IsSearching());
+    table_results->setRowCount(0);
+    if (!scanner.IsSearching()) {
+        label_results->setText(tr("No search in progress."));
+        return;
+    }
+
+    const u64 num_results = scanner.NumResults();
+    const int displayed_count =
+        static_cast<int>(std::min<u64>(num_results, std::numeric_limits<int>::max()));
+    label_results->setText(tr("%n address(es) found.", "", displayed_count));
+
+    const auto results = scanner.GetResults(0, MAX_DISPLAYED_RESULTS);
+    const auto virtual_addresses = scanner.GetVirtualAddresses(results);
+    table_results->setRowCount(static_cast<int>(results.size()));
+    for (int row = 0; row < static_cast<int>(results.size()); ++row) {
+        const Cheats::ScanResult& result = results[row];
+        const std::optional<VAddr>& virtual_address = virtual_addresses[row];
+
+        const auto format_address = [](u32 address) {
+            return QStringLiteral("%1").arg(address, 8, 16, QLatin1Char('0'));
+        };
+        table_results->setItem(row, 0, new QTableWidgetItem(format_address(result.address)));
+        table_results->setItem(row, 1,
+                               new QTableWidgetItem(virtual_address
+                                                        ? format_address(*virtual_address)
+                                                        : tr("Not mapped")));
+        table_results->setItem(row, 2, new QTableWidgetItem(FormatValue(result.value)));
+    }
+}
@@ -0,0 +1,49 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <QDialog>
+#include "common/common_types.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QTableWidget;
+
+/// Searches the emulated RAM for the addresses of values, to write cheats for them.
+class MemorySearchDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit MemorySearchDialog(QWidget* parent = nullptr);
+    ~MemorySearchDialog() override;
+
+private slots:
+    void OnNewSearch();
+    void OnScan();
+    void OnReset();
+    void OnComparisonChanged();
+
+private:
+    /// Parses the value line edit as a value of the selected type, returning its raw bits
+    std::optional<u64> ParseValue() const;
+
+    /// Returns the value with the given raw bits as text, formatted for the searched type
+    QString FormatValue(u64 value) const;
+
+    /// Shows the number of candidates and the first of them
+    void UpdateResults();
+
+    QComboBox* value_type;
+    QComboBox* comparison;
+    QLineEdit* value;
+    QPushButton* button_new_search;
+    QPushButton* button_scan;
+    QPushButton* button_reset;
+    QLabel* label_results;
+    QTableWidget* table_results;
+};
@@ -0,0 +1,532 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fmt/args.h>
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/log.h"
+#include "common/ring_buffer.h"
+#include "common/thread.h"
+
+namespace Log {
+
+std::atomic_bool binary_log_enabled = false;
+std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> binary_class_levels{};
+
+namespace {
+
+constexpr std::array<char, 4> BINARY_LOG_MAGIC{'C', 'B', 'L', 'G'};
+constexpr u32 BINARY_LOG_VERSION = 1;
+
+/// Size in bytes of the ring of every logging thread, messages are dropped when it is full
+constexpr std::size_t THREAD_RING_SIZE = 256 * 1024;
+
+/// Interval at which the writer thread drains the rings
+constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(50);
+
+enum class RecordType : u8 {
+    /// u32 site ID, u8 class, u8 level, u32 line, then the filename, function and format strings
+    Site,
+    /// u32 site ID, u32 thread ID, u64 timestamp in microseconds, u16 size of the arguments, then
+    /// the packed arguments
+    Message,
+    /// u32 thread ID, u64 number of messages of the thread dropped so far
+    Dropped,
+};
+
+constexpr std::size_t MESSAGE_HEADER_SIZE =
+    sizeof(RecordType) + sizeof(u32) * 2 + sizeof(u64) + sizeof(u16);
+
+/// Appends the raw bytes of a value to a buffer
+template <typename T>
+void Append(std::vector<u8>& buffer, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void AppendString(std::vector<u8>& buffer, std::string_view string) {
+    const auto length = static_cast<u16>(std::min<std::size_t>(string.size(), UINT16_MAX));
+    Append(buffer, length);
+    buffer.insert(buffer.end(), string.begin(), string.begin() + length);
+}
+
+/// Call site of a log message. The strings are literals, so their addresses identify the site.
+struct Site {
+    const char* format;
+    const char* filename;
+    const char* function;
+    unsigned int line_num;
+    Class log_class;
+    Level log_level;
+
+    bool operator==(const Site&) const = default;
+};
+
+struct SiteHash {
+    std::size_t operator()(const Site& site) const {
+        return std::hash<const char*>{}(site.format) ^
+               (std::hash<unsigned int>{}(site.line_num) << 1);
+    }
+};
+
+struct ThreadRing {
+    u32 id;
+    Common::RingBuffer<u8, THREAD_RING_SIZE> ring;
+    std::atomic<u64> dropped = 0;
+    /// Number of dropped messages written to the file, only used by the writer thread
+    u64 written_dropped = 0;
+};
+
+class BinaryLogger {
+public:
+    static BinaryLogger& Instance() {
+        static BinaryLogger logger;
+        return logger;
+    }
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    bool Start(const std::string& filename, const Filter& filter) {
+        Stop();
+
+        std::scoped_lock lock{writer_mutex};
+        file = FileUtil::IOFile(filename, "wb");
+        if (!file.IsOpen()) {
+            return false;
+        }
+        file.WriteArray(BINARY_LOG_MAGIC.data(), BINARY_LOG_MAGIC.size());
+        file.WriteObject(BINARY_LOG_VERSION);
+
+        // Every file defines all the sites it uses
+        sites_written = 0;
+        {
+            // Discard the messages that were pushed while the previous log was stopping
+            std::scoped_lock rings_lock{rings_mutex};
+            for (const auto& thread_ring : rings) {
+                std::vector<u8> discarded(thread_ring->ring.Size());
+                thread_ring->ring.Pop(discarded.data(), discarded.size());
+                thread_ring->written_dropped = thread_ring->dropped.load();
+            }
+        }
+
+        // Messages that are still being pushed by the previous log may see a mix of levels
+        for (std::size_t i = 0; i < binary_class_levels.size(); ++i) {
+            binary_class_levels[i].store(filter.GetClassLevel(static_cast<Class>(i)),
+                                         std::memory_order_relaxed);
+        }
+        stop_requested = false;
+        writer_thread = std::thread([this] { WriterLoop(); });
+        binary_log_enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void Stop() {
+        if (!writer_thread.joinable()) {
+            return;
+        }
+        binary_log_enabled = false;
+        {
+            std::scoped_lock lock{writer_mutex};
+            stop_requested = true;
+        }
+        stop_cv.notify_one();
+        writer_thread.join();
+        file.Close();
+    }
+
+    void Push(const Site& site, const BinaryArgs& args) {
+        const u32 site_id = GetSiteId(site);
+        ThreadRing& thread_ring = GetThreadRing();
+        const auto timestamp = static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - time_origin)
+                .count());
+        const auto args_size = static_cast<u16>(args.Size());
+
+        std::array<u8, MESSAGE_HEADER_SIZE + BinaryArgs::MAX_SIZE> record;
+        u8* out = record.data();
+        const auto write = [&out](const auto& value) {
+            std::memcpy(out, &value, sizeof(value));
+            out += sizeof(value);
+        };
+        write(RecordType::Message);
+        write(site_id);
+        write(thread_ring.id);
+        write(timestamp);
+        write(args_size);
+        std::memcpy(out, args.Data(), args_size);
+
+        // The record is pushed at once so that the ring only ever holds whole records
+        const std::size_t record_size = MESSAGE_HEADER_SIZE + args_size;
+        auto& ring = thread_ring.ring;
+        if (ring.Capacity() - ring.Size() < record_size) {
+            thread_ring.dropped++;
+            return;
+        }
+        ring.Push(record.data(), record_size);
+    }
+
+private:
+    BinaryLogger() = default;
+
+    ~BinaryLogger() {
+        Stop();
+    }
+
+    u32 GetSiteId(const Site& site) {
+        thread_local std::unordered_map<Site, u32, SiteHash> cached_ids;
+        if (const auto itr = cached_ids.find(site); itr != cached_ids.end()) {
+            return itr->second;
+        }
+
+        std::scoped_lock lock{sites_mutex};
+        const auto [itr, inserted] = site_ids.try_emplace(site, static_cast<u32>(sites.size()));
+        if (inserted) {
+            sites.push_back(site);
+        }
+        cached_ids.emplace(site, itr->second);
+        return itr->second;
+    }
+
+    ThreadRing& GetThreadRing() {
+        thread_local const std::shared_ptr<ThreadRing> thread_ring = [this] {
+            auto new_ring = std::make_shared<ThreadRing>();
+            std::scoped_lock lock{rings_mutex};
+            new_ring->id = next_thread_id++;
+            rings.push_back(new_ring);
+            return new_ring;
+        }();
+        return *thread_ring;
+    }
+
+    void WriterLoop() {
+        Common::SetCurrentThreadName("BinaryLog");
+
+        std::unique_lock lock{writer_mutex};
+        while (!stop_cv.wait_for(lock, WRITE_INTERVAL, [this] { return stop_requested; })) {
+            WritePending();
+        }
+        WritePending();
+    }
+
+    /// Drains the rings into the file, the writer mutex must be held
+    void WritePending() {
+        staging.clear();
+        {
+            std::scoped_lock lock{rings_mutex};
+            for (auto itr = rings.begin(); itr != rings.end();) {
+                ThreadRing& thread_ring = **itr;
+                const std::size_t size = thread_ring.ring.Size();
+                const std::size_t offset = staging.size();
+                staging.resize(offset + size);
+                thread_ring.ring.Pop(staging.data() + offset, size);
+
+                const u64 dropped = thread_ring.dropped.load();
+                if (dropped != thread_ring.written_dropped) {
+                    Append(staging, RecordType::Dropped);
+                    Append(staging, thread_ring.id);
+                    Append(staging, dropped);
+                    thread_ring.written_dropped = dropped;
+                }
+
+                // Once its thread has exited, the ring is only referenced here
+                if (itr->use_count() == 1 && thread_ring.ring.Size() == 0) {
+                    itr = rings.erase(itr);
+                } else {
+                    ++itr;
+                }
+            }
+        }
+
+        // Sites are registered before their messages are pushed, so the sites of every popped
+        // message are defined before it in the file
+        std::vector<u8> site_records;
+        {
+            std::scoped_lock lock{sites_mutex};
+            for (; sites_written < sites.size(); ++sites_written) {
+                const Site& site = sites[sites_written];
+                Append(site_records, RecordType::Site);
+                Append(site_records, static_cast<u32>(sites_written));
+                Append(site_records, static_cast<u8>(site.log_class));
+                Append(site_records, static_cast<u8>(site.log_level));
+                Append(site_records, static_cast<u32>(site.line_num));
+                AppendString(site_records, site.filename);
+                AppendString(site_records, site.function);
+                AppendString(site_records, site.format);
+            }
+        }
+
+        if (site_records.empty() && staging.empty()) {
+            return;
+        }
+        file.WriteBytes(site_records.data(), site_records.size());
+        file.WriteBytes(staging.data(), staging.size());
+        file.Flush();
+    }
+
+    std::mutex sites_mutex;
+    std::unordered_map<Site, u32, SiteHash> site_ids;
+    std::vector<Site> sites;
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    u32 next_thread_id = 0;
+
+    std::mutex writer_mutex;
+    std::condition_variable stop_cv;
+    bool stop_requested = false;
+    std::thread writer_thread;
+    FileUtil::IOFile file;
+    std::size_t sites_written = 0;
+    std::vector<u8> staging;
+
+    std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
+};
+
+/// Reads the records of a binary log file
+class RecordReader {
+public:
+    explicit RecordReader(std::string_view data) : data(data) {}
+
+    bool AtEnd() const {
+        return position == data.size();
+    }
+
+    template <typename T>
+    bool Read(T& value) {
+        if (data.size() - position < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& string) {
+        u16 length;
+        if (!Read(length) || data.size() - position < length) {
+            return false;
+        }
+        string.assign(data.data() + position, length);
+        position += length;
+        return true;
+    }
+
+    bool ReadBytes(std::string_view& bytes, std::size_t size) {
+        if (data.size() - position < size) {
+            return false;
+        }
+        bytes = data.substr(position, size);
+        position += size;
+        return true;
+    }
+
+private:
+    std::string_view data;
+    std::size_t position = 0;
+};
+
+struct DecodedSite {
+    Class log_class;
+    Level log_level;
+    unsigned int line_num;
+    std::string filename;
+    std::string function;
+    std::string format;
+};
+
+/// Formats a message with its packed arguments, or returns nothing if they are malformed
+std::optional<std::string> FormatBinaryMessage(const std::string& format, std::string_view args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    RecordReader reader(args);
+    while (!reader.AtEnd()) {
+        BinaryArgType type;
+        if (!reader.Read(type)) {
+            return std::nullopt;
+        }
+
+        const auto push = [&](auto value) {
+            if (!reader.Read(value)) {
+                return false;
+            }
+            store.push_back(value);
+            return true;
+        };
+        bool valid = false;
+        switch (type) {
+        case BinaryArgType::Signed:
+            valid = push(s64{});
+            break;
+        case BinaryArgType::Unsigned:
+            valid = push(u64{});
+            break;
+        case BinaryArgType::Float:
+            valid = push(float{});
+            break;
+        case BinaryArgType::Double:
+            valid = push(double{});
+            break;
+        case BinaryArgType::Char:
+            valid = push(char{});
+            break;
+        case BinaryArgType::Bool: {
+            u8 value;
+            valid = reader.Read(value);
+            store.push_back(value != 0);
+            break;
+        }
+        case BinaryArgType::String: {
+            std::string value;
+            valid = reader.ReadString(value);
+            store.push_back(std::move(value));
+            break;
+        }
+        case BinaryArgType::Pointer: {
+            u64 value;
+            valid = reader.Read(value);
+            store.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(value)));
+            break;
+        }
+        }
+        if (!valid) {
+            return std::nullopt;
+        }
+    }
+
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error& error) {
+        // Arguments of unsupported types were packed as strings, which the specs may not accept
+        return fmt::format("{} (could not be formatted: {})", format, error.what());
+    }
+}
+
+} // Anonymous namespace
+
+void PushBinaryMessage(Class log_class, Level log_level, const char* filename,
+                       unsigned int line_num, const char* function, const char* format,
+                       const BinaryArgs& args) {
+    BinaryLogger::Instance().Push({format, filename, function, line_num, log_class, log_level},
+                                  args);
+}
+
+bool StartBinaryLog(const std::string& filename, const Filter& filter) {
+    return BinaryLogger::Instance().Start(filename, filter);
+}
+
+void StopBinaryLog() {
+    BinaryLogger::Instance().Stop();
+}
+
+bool DecodeBinaryLog(const std::string& filename,
+                     const std::function<void(const Entry&)>& callback) {
+    std::string data;
+    if (FileUtil::ReadFileToString(false, filename, data) < BINARY_LOG_MAGIC.size()) {
+        return false;
+    }
+
+    RecordReader reader(data);
+    std::array<char, 4> magic;
+    u32 version;
+    if (!reader.Read(magic) || magic != BINARY_LOG_MAGIC || !reader.Read(version) ||
+        version != BINARY_LOG_VERSION) {
+        return false;
+    }
+
+    std::vector<DecodedSite> sites;
+    while (!reader.AtEnd()) {
+        RecordType type;
+        if (!reader.Read(type)) {
+            return false;
+        }
+
+        switch (type) {
+        case RecordType::Site: {
+            u32 id;
+            u8 log_class;
+            u8 log_level;
+            u32 line_num;
+            DecodedSite site;
+            if (!reader.Read(id) || !reader.Read(log_class) || !reader.Read(log_level) ||
+                !reader.Read(line_num) || !reader.ReadString(site.filename) ||
+                !reader.ReadString(site.function) || !reader.ReadString(site.format) ||
+                log_class >= static_cast<u8>(Class::Count) ||
+                log_level >= static_cast<u8>(Level::Count)) {
+                return false;
+            }
+            site.log_class = static_cast<Class>(log_class);
+            site.log_level = static_cast<Level>(log_level);
+            site.line_num = line_num;
+            if (id >= sites.size()) {
+                sites.resize(id + 1);
+            }
+            sites[id] = std::move(site);
+            break;
+        }
+        case RecordType::Message: {
+            u32 site_id;
+            u32 thread_id;
+            u64 timestamp;
+            u16 args_size;
+            std::string_view args;
+            if (!reader.Read(site_id) || !reader.Read(thread_id) || !reader.Read(timestamp) ||
+                !reader.Read(args_size) || !reader.ReadBytes(args, args_size) ||
+                site_id >= sites.size()) {
+                return false;
+            }
+
+            const DecodedSite& site = sites[site_id];
+            std::optional<std::string> message = FormatBinaryMessage(site.format, args);
+            if (!message) {
+                return false;
+            }
+
+            Entry entry;
+            entry.timestamp = std::chrono::microseconds(timestamp);
+            entry.log_class = site.log_class;
+            entry.log_level = site.log_level;
+            entry.filename = site.filename.c_str();
+            entry.line_num = site.line_num;
+            entry.function = site.function;
+            entry.message = std::move(*message);
+            callback(entry);
+            break;
+        }
+        case RecordType::Dropped: {
+            u32 thread_id;
+            u64 dropped;
+            if (!reader.Read(thread_id) || !reader.Read(dropped)) {
+                return false;
+            }
+
+            Entry entry;
+            entry.timestamp = std::chrono::microseconds(0);
+            entry.log_class = Class::Log;
+            entry.log_level = Level::Warning;
+            entry.filename = "";
+            entry.line_num = 0;
+            entry.message = fmt::format("{} messages of thread {} were dropped so far", dropped,
+                                        thread_id);
+            callback(entry);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace Log
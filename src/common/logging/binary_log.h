@@ -0,0 +1,140 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <fmt/format.h>
+#include "common/common_types.h"
+
+/**
+ * The binary log records log messages without formatting them. Every message is written as the
+ * ID of its call site (class, level, source location and format string, which are written once)
+ * and its packed arguments, into a lock-free ring of the logging thread. A writer thread drains
+ * the rings into a compact file, which citra-log-decoder renders to text offline.
+ */
+namespace Log {
+
+struct Entry;
+class Filter;
+
+enum class BinaryArgType : u8 {
+    Signed,
+    Unsigned,
+    Float,
+    Double,
+    Bool,
+    Char,
+    String,
+    Pointer,
+};
+
+/// Arguments of a log message, packed as their type followed by their value.
+class BinaryArgs {
+public:
+    /// Strings are truncated so that the arguments fit in this size
+    static constexpr std::size_t MAX_SIZE = 512;
+
+    template <typename T>
+    void PushValue(BinaryArgType type, T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (size + 1 + sizeof(T) > MAX_SIZE) {
+            return;
+        }
+        buffer[size++] = static_cast<u8>(type);
+        std::memcpy(buffer.data() + size, &value, sizeof(T));
+        size += sizeof(T);
+    }
+
+    void PushString(std::string_view string) {
+        if (size + 1 + sizeof(u16) > MAX_SIZE) {
+            return;
+        }
+        const auto length =
+            static_cast<u16>(std::min(string.size(), MAX_SIZE - size - 1 - sizeof(u16)));
+        buffer[size++] = static_cast<u8>(BinaryArgType::String);
+        std::memcpy(buffer.data() + size, &length, sizeof(length));
+        size += sizeof(length);
+        std::memcpy(buffer.data() + size, string.data(), length);
+        size += length;
+    }
+
+    const u8* Data() const {
+        return buffer.data();
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+private:
+    std::array<u8, MAX_SIZE> buffer;
+    std::size_t size = 0;
+};
+
+/**
+ * Packs an argument of a log message. Arithmetic values, enums, strings and pointers are packed
+ * as they are, so that the decoder applies the format specifications to them. Other types are
+ * formatted with "{}" and packed as strings.
+ */
+template <typename T>
+void PackBinaryArg(BinaryArgs& args, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        args.PushValue(BinaryArgType::Bool, static_cast<u8>(value));
+    } else if constexpr (std::is_same_v<T, char>) {
+        args.PushValue(BinaryArgType::Char, value);
+    } else if constexpr (std::is_enum_v<T>) {
+        // Enums are formatted as their underlying type, see formatter.h
+        PackBinaryArg(args, static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        args.PushValue(BinaryArgType::Signed, static_cast<s64>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        args.PushValue(BinaryArgType::Unsigned, static_cast<u64>(value));
+    } else if constexpr (std::is_same_v<T, float>) {
+        args.PushValue(BinaryArgType::Float, value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        args.PushValue(BinaryArgType::Double, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T&, const char*>) {
+        const char* string = value;
+        args.PushString(string != nullptr ? string : "(null)");
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        args.PushString(value);
+    } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+        args.PushValue(BinaryArgType::Pointer,
+                       static_cast<u64>(reinterpret_cast<std::uintptr_t>(value)));
+    } else {
+        args.PushString(fmt::format("{}", value));
+    }
+}
+
+/// Whether the binary log is recording, checked before packing the arguments of a message
+extern std::atomic_bool binary_log_enabled;
+
+/**
+ * Starts recording the messages that pass the filter to a binary log file, independently of the
+ * global filter and the text backends.
+ * @returns false if the file couldn't be opened.
+ */
+bool StartBinaryLog(const std::string& filename, const Filter& filter);
+
+/// Stops recording, writing the remaining messages to the file.
+void StopBinaryLog();
+
+/**
+ * Decodes a binary log file, calling the callback with every message formatted as an entry.
+ * @returns false if the file isn't a binary log or is truncated.
+ */
+bool DecodeBinaryLog(const std::string& filename,
+                     const std::function<void(const Entry&)>& callback);
+
+} // namespace Log
@@ -96,4 +96,8 @@ bool Filter::CheckMessage(Class log_class, Level level) const {
     return static_cast<u8>(level) >=
            static_cast<u8>(class_levels[static_cast<std::size_t>(log_class)]);
 }
+
+Level Filter::GetClassLevel(Class log_class) const {
+    return class_levels[static_cast<std::size_t>(log_class)];
+}
 } // namespace Log
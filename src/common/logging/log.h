@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <array>
 #include "common/common_types.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/formatter.h"
 
 namespace Log {
@@ -150,6 +151,9 @@ public:
     /// Matches class/level combination against the filter, returning true if it passed.
     bool CheckMessage(Class log_class, Level level) const;
 
+    /// Returns the minimum level of `log_class`.
+    Level GetClassLevel(Class log_class) const;
+
 private:
     std::array<Level, static_cast<std::size_t>(Class::Count)> class_levels;
 };
@@ -162,9 +166,41 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/**
+ * Minimum level of every class recorded by the binary log. The levels are stored before the
+ * binary log is enabled, so the messages that see it enabled also see its levels.
+ */
+extern std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> binary_class_levels;
+
+/// Records a message with packed arguments into the binary log of the calling thread
+void PushBinaryMessage(Class log_class, Level log_level, const char* filename,
+                       unsigned int line_num, const char* function, const char* format,
+                       const BinaryArgs& args);
+
+/// Records a message into the binary log if it is recording messages of its class and level
+template <typename... Args>
+void BinaryLogMessage(Class log_class, Level log_level, const char* filename,
+                      unsigned int line_num, const char* function, const char* format,
+                      const Args&... args) {
+    if (!binary_log_enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+    const Level min_level =
+        binary_class_levels[static_cast<std::size_t>(log_class)].load(std::memory_order_relaxed);
+    if (static_cast<u8>(log_level) < static_cast<u8>(min_level)) {
+        return;
+    }
+
+    BinaryArgs binary_args;
+    (PackBinaryArg(binary_args, args), ...);
+    PushBinaryMessage(log_class, log_level, filename, line_num, function, format, binary_args);
+}
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    BinaryLogMessage(log_class, log_level, filename, line_num, function, format, args...);
+
     if (!filter.CheckMessage(log_class, log_level))
         return;
 
@@ -184,7 +220,13 @@ void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsig
     ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Trace,                             \
                          ::Log::TrimSourcePath(__FILE__), __LINE__, __func__, __VA_ARGS__)
 #else
-#define LOG_TRACE(log_class, fmt, ...) (void(0))
+// Trace messages only go to the binary log, their arguments are evaluated once it is recording
+#define LOG_TRACE(log_class, ...)                                                                  \
+    (::Log::binary_log_enabled.load(std::memory_order_relaxed)                                     \
+         ? ::Log::BinaryLogMessage(::Log::Class::log_class, ::Log::Level::Trace,                   \
+                                   ::Log::TrimSourcePath(__FILE__), __LINE__, __func__,            \
+                                   __VA_ARGS__)                                                    \
+         : void(0))
 #endif
 
 #define LOG_DEBUG(log_class, ...)                                                                  \
@@ -5,3 +5,139 @@
 // Includes the MicroProfile implementation in this file for compilation
 #define MICROPROFILE_IMPL 1
 #include "common/microprofile.h"
+
+#include <vector>
+#include <fmt/format.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace Common::Profiling {
+
+#if MICROPROFILE_ENABLED
+
+namespace {
+
+std::string EscapeJson(std::string_view str) {
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+} // Anonymous namespace
+
+void EnableTraceCapture() {
+    MicroProfileSetForceEnable(true);
+    MicroProfileSetEnableAllGroups(true);
+}
+
+bool WriteChromeTrace(const std::string& path) {
+    FileUtil::IOFile file(path, "w");
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    std::lock_guard lock{MicroProfileGetMutex()};
+    MicroProfile& profile = *MicroProfileGet();
+
+    // Stop recording while the thread logs are read, like the HTML dump does
+    const u64 active_group = profile.nActiveGroup;
+    profile.nActiveGroup = 0;
+
+    // Leave a few frames at the end of the history, as they may still be being written to
+    constexpr u32 num_frames =
+        MICROPROFILE_MAX_FRAME_HISTORY - MICROPROFILE_GPU_FRAME_DELAY - 3;
+    const u32 first_frame =
+        (profile.nFrameCurrent + MICROPROFILE_MAX_FRAME_HISTORY - num_frames) %
+        MICROPROFILE_MAX_FRAME_HISTORY;
+    const u32 last_frame = profile.nFrameCurrent % MICROPROFILE_MAX_FRAME_HISTORY;
+    const s64 tick_start = profile.Frames[first_frame].nFrameStartCpu;
+    const double ticks_to_us = 1'000'000.0 / MicroProfileTicksPerSecondCpu();
+
+    std::string events;
+    const auto append_event = [&events](std::string_view event) {
+        events += events.empty() ? "\n" : ",\n";
+        events += event;
+    };
+
+    std::vector<u64> open_scopes;
+    for (u32 thread = 0; thread < profile.nNumLogs; ++thread) {
+        const MicroProfileThreadLog* log = profile.Pool[thread];
+        // GPU timers are not supported, so the GPU log never contains any scopes
+        if (!log || log->nGpu) {
+            continue;
+        }
+
+        const u32 log_start = profile.Frames[first_frame].nLogStart[thread];
+        const u32 log_end = profile.Frames[last_frame].nLogStart[thread];
+        if (log_start == log_end) {
+            continue;
+        }
+
+        append_event(fmt::format(
+            "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+            thread, EscapeJson(log->ThreadName)));
+
+        const auto append_scope = [&](u64 timer, char phase, double timestamp) {
+            const auto& timer_info = profile.TimerInfo[timer];
+            append_event(fmt::format(
+                "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":0,\"tid\":{}}}",
+                EscapeJson(timer_info.pName),
+                EscapeJson(profile.GroupInfo[timer_info.nGroupIndex].pName), phase, timestamp,
+                thread));
+        };
+
+        double timestamp = 0.0;
+        open_scopes.clear();
+        for (u32 i = log_start; i != log_end; i = (i + 1) % MICROPROFILE_BUFFER_SIZE) {
+            const MicroProfileLogEntry entry = log->Log[i];
+            const u64 type = MicroProfileLogType(entry);
+            if (type != MP_LOG_ENTER && type != MP_LOG_LEAVE) {
+                continue;
+            }
+
+            const u64 timer = MicroProfileLogTimerIndex(entry);
+            timestamp = MicroProfileLogTickDifference(tick_start, entry) * ticks_to_us;
+            if (type == MP_LOG_ENTER) {
+                open_scopes.push_back(timer);
+                append_scope(timer, 'B', timestamp);
+            } else if (!open_scopes.empty()) {
+                // Scopes entered before the start of the window are dropped
+                open_scopes.pop_back();
+                append_scope(timer, 'E', timestamp);
+            }
+        }
+
+        // Close the scopes still open at the end of the window
+        while (!open_scopes.empty()) {
+            append_scope(open_scopes.back(), 'E', timestamp);
+            open_scopes.pop_back();
+        }
+    }
+
+    profile.nActiveGroup = active_group;
+
+    file.WriteString("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    file.WriteString(events);
+    file.WriteString("\n]}\n");
+    return true;
+}
+
+#else
+
+void EnableTraceCapture() {}
+
+bool WriteChromeTrace(const std::string& path) {
+    return false;
+}
+
+#endif
+
+} // namespace Common::Profiling
@@ -20,6 +20,23 @@
 typedef void* HANDLE;
 #endif
 
+#include <string>
 #include <microprofile.h>
 
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
+
+namespace Common::Profiling {
+
+/// Records all profiling scopes, even when no profiler UI is displaying them.
+void EnableTraceCapture();
+
+/**
+ * Writes the profiling scopes recorded in the MicroProfile frame history (about the last 500
+ * frames) from all threads to a file in the Chrome trace event format, which can be opened in
+ * chrome://tracing or Perfetto.
+ * @param path Path of the file to write to.
+ * @returns true on success.
+ */
+bool WriteChromeTrace(const std::string& path);
+
+} // namespace Common::Profiling
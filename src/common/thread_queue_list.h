@@ -4,204 +4,235 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
+#include "common/assert.h"
 #include "common/common_types.h"
 
 namespace Common {
 
 template <class T, unsigned int N>
-struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+struct ThreadQueueList;
+
+/**
+ * Links of an element of a ThreadQueueList. Elements inherit from this, so that they can be queued
+ * and dequeued without allocating and removed in constant time. An element can only be part of a
+ * single queue at a time.
+ */
+template <class T>
+class ThreadQueueListNode {
+private:
+    template <class, unsigned int>
+    friend struct ThreadQueueList;
+
+    T* prev = nullptr;
+    T* next = nullptr;
+    // Priority level the element is queued at, or ~0U when it isn't queued
+    unsigned int queued_priority = ~0U;
+};
 
+/**
+ * Per-priority lists of elements, with a bitmap of the non-empty levels to find the first element
+ * in constant time. T must inherit from ThreadQueueListNode<T>.
+ */
+template <class T, unsigned int N>
+struct ThreadQueueList {
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
+    static_assert(NUM_QUEUES <= 64, "The priority bitmap holds at most 64 levels");
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    ThreadQueueList() = default;
 
     // Only for debugging, returns priority level.
-    [[nodiscard]] Priority contains(const T& uid) const {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
-
-        return -1;
+    [[nodiscard]] Priority contains(const T* element) const {
+        return Node(element).queued_priority;
     }
 
-    [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+    [[nodiscard]] T* get_first() const {
+        if (nonempty_mask == 0) {
+            return nullptr;
         }
-
-        return T();
+        return queues[std::countr_zero(nonempty_mask)].head;
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+    T* pop_first() {
+        if (nonempty_mask == 0) {
+            return nullptr;
         }
-
-        return T();
+        return pop_front(static_cast<Priority>(std::countr_zero(nonempty_mask)));
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+    T* pop_first_better(Priority priority) {
+        const u64 better_mask = nonempty_mask & ((u64{1} << priority) - 1);
+        if (better_mask == 0) {
+            return nullptr;
         }
-
-        return T();
+        return pop_front(static_cast<Priority>(std::countr_zero(better_mask)));
     }
 
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+    void push_front(Priority priority, T* element) {
+        Queue& cur = queues[priority];
+        auto& node = Node(element);
+        DEBUG_ASSERT(node.queued_priority == ~0U);
+
+        node.prev = nullptr;
+        node.next = cur.head;
+        node.queued_priority = priority;
+        if (cur.head != nullptr) {
+            Node(cur.head).prev = element;
+        } else {
+            cur.tail = element;
+        }
+        cur.head = element;
+        nonempty_mask |= u64{1} << priority;
     }
 
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+    void push_back(Priority priority, T* element) {
+        Queue& cur = queues[priority];
+        auto& node = Node(element);
+        DEBUG_ASSERT(node.queued_priority == ~0U);
+
+        node.prev = cur.tail;
+        node.next = nullptr;
+        node.queued_priority = priority;
+        if (cur.tail != nullptr) {
+            Node(cur.tail).next = element;
+        } else {
+            cur.head = element;
+        }
+        cur.tail = element;
+        nonempty_mask |= u64{1} << priority;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
+    void move(T* element, Priority old_priority, Priority new_priority) {
+        remove(old_priority, element);
         prepare(new_priority);
-        push_back(new_priority, thread_id);
+        push_back(new_priority, element);
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+    /// Removes the element if it's queued at the given priority, does nothing otherwise.
+    void remove(Priority priority, T* element) {
+        auto& node = Node(element);
+        if (node.queued_priority != priority) {
+            return;
+        }
+
+        Queue& cur = queues[priority];
+        if (node.prev != nullptr) {
+            Node(node.prev).next = node.next;
+        } else {
+            cur.head = node.next;
+        }
+        if (node.next != nullptr) {
+            Node(node.next).prev = node.prev;
+        } else {
+            cur.tail = node.prev;
+        }
+        node = {};
+
+        if (cur.head == nullptr) {
+            nonempty_mask &= ~(u64{1} << priority);
+        }
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        Queue& cur = queues[priority];
+        if (cur.head != cur.tail) {
+            push_back(priority, pop_front(priority));
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Priority i = 0; i < NUM_QUEUES; ++i) {
+            while (queues[i].head != nullptr) {
+                pop_front(i);
+            }
+        }
+        linked_mask = 0;
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return queues[priority].head == nullptr;
     }
 
     void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        linked_mask |= u64{1} << priority;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* head = nullptr;
+        T* tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    static ThreadQueueListNode<T>& Node(T* element) {
+        return static_cast<ThreadQueueListNode<T>&>(*element);
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
+    static const ThreadQueueListNode<T>& Node(const T* element) {
+        return static_cast<const ThreadQueueListNode<T>&>(*element);
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
-        } else {
-            return q - queues.data();
-        }
+    T* pop_front(Priority priority) {
+        T* element = queues[priority].head;
+        remove(priority, element);
+        return element;
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
-        }
+    // Bit i is set when the priority level i has queued elements.
+    u64 nonempty_mask = 0;
+    // Bit i is set when the priority level i has ever been prepared. This is only kept to write
+    // savestates in the format of the previous linked list of levels.
+    u64 linked_mask = 0;
+    // The priority level queues of elements.
+    std::array<Queue, NUM_QUEUES> queues{};
+
+    /// Returns the index of the first prepared level after the given one, or -2 if there is none.
+    s64 NextLinkedIndex(s64 priority) const {
+        const u64 later_mask = priority + 1 >= 64 ? 0 : linked_mask >> (priority + 1);
+        return later_mask == 0 ? -2 : priority + 1 + std::countr_zero(later_mask);
     }
 
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
+        const s64 idx = NextLinkedIndex(-1);
         ar << idx;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
+            const bool linked = (linked_mask >> i) & 1;
+            const s64 idx1 = linked ? NextLinkedIndex(static_cast<s64>(i)) : -1;
             ar << idx1;
-            ar << queues[i].data;
+
+            std::deque<T*> data;
+            for (T* cur = queues[i].head; cur != nullptr; cur = Node(cur).next) {
+                data.push_back(cur);
+            }
+            ar << data;
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
+        clear();
+
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            if (idx != -1) {
+                prepare(static_cast<Priority>(i));
+            }
+
+            std::deque<T*> data;
+            ar >> data;
+            for (T* element : data) {
+                push_back(static_cast<Priority>(i), element);
+            }
         }
     }
 
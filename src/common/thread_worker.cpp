@@ -0,0 +1,72 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "common/thread_worker.h"
+
+namespace Common {
+
+ThreadWorker::ThreadWorker(std::size_t num_workers, const std::string& name) {
+    threads.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        threads.emplace_back(&ThreadWorker::WorkerLoop, this, fmt::format("{}:{}", name, i));
+    }
+}
+
+ThreadWorker::~ThreadWorker() {
+    {
+        std::scoped_lock lock{queue_mutex};
+        stop = true;
+    }
+    work_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadWorker::QueueWork(std::function<void()> work) {
+    {
+        std::scoped_lock lock{queue_mutex};
+        requests.push(std::move(work));
+        ++pending_work;
+    }
+    work_cv.notify_one();
+}
+
+void ThreadWorker::WaitForRequests() {
+    std::unique_lock lock{queue_mutex};
+    done_cv.wait(lock, [this] { return pending_work == 0; });
+}
+
+void ThreadWorker::WorkerLoop(const std::string& thread_name) {
+    SetCurrentThreadName(thread_name.c_str());
+    MicroProfileOnThreadCreate(thread_name.c_str());
+
+    while (true) {
+        std::function<void()> work;
+        {
+            std::unique_lock lock{queue_mutex};
+            work_cv.wait(lock, [this] { return stop || !requests.empty(); });
+            if (requests.empty()) {
+                break;
+            }
+            work = std::move(requests.front());
+            requests.pop();
+        }
+
+        work();
+
+        {
+            std::scoped_lock lock{queue_mutex};
+            --pending_work;
+        }
+        done_cv.notify_all();
+    }
+
+    MicroProfileOnThreadExit();
+}
+
+} // namespace Common
@@ -0,0 +1,53 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed-size pool of threads that runs queued work items in the order they were queued.
+ * Work still queued when the pool is destroyed is completed before the destructor returns.
+ */
+class ThreadWorker {
+public:
+    explicit ThreadWorker(std::size_t num_workers, const std::string& name);
+    ~ThreadWorker();
+
+    ThreadWorker(const ThreadWorker&) = delete;
+    ThreadWorker& operator=(const ThreadWorker&) = delete;
+
+    /// Queues a work item to be run by one of the worker threads
+    void QueueWork(std::function<void()> work);
+
+    /// Blocks until all queued work items have completed
+    void WaitForRequests();
+
+    /// Returns the number of threads in the pool
+    std::size_t NumWorkers() const {
+        return threads.size();
+    }
+
+private:
+    void WorkerLoop(const std::string& thread_name);
+
+    std::mutex queue_mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::queue<std::function<void()>> requests;
+    std::size_t pending_work{0};
+    bool stop{false};
+    std::vector<std::thread> threads;
+};
+
+} // namespace Common
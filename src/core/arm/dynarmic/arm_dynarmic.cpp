@@ -76,42 +76,62 @@ public:
         : parent(parent), svc_context(parent.system), memory(parent.memory) {}
     ~DynarmicUserCallbacks() = default;
 
+    std::optional<std::uint32_t> MemoryReadCode(VAddr vaddr) override {
+        // Instruction fetches are not accesses to watched memory
+        u32 instruction;
+        memory.ReadBlock(*parent.system.Kernel().GetCurrentProcess(), vaddr, &instruction,
+                         sizeof(instruction));
+        return instruction;
+    }
+
     std::uint8_t MemoryRead8(VAddr vaddr) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
         return memory.Read8(vaddr);
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
         return memory.Read16(vaddr);
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
         return memory.Read32(vaddr);
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
         return memory.Read64(vaddr);
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         memory.Write8(vaddr, value);
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         memory.Write16(vaddr, value);
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         memory.Write32(vaddr, value);
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         memory.Write64(vaddr, value);
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         return memory.WriteExclusive8(vaddr, value, expected);
     }
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         return memory.WriteExclusive16(vaddr, value, expected);
     }
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         return memory.WriteExclusive32(vaddr, value, expected);
     }
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
         return memory.WriteExclusive64(vaddr, value, expected);
     }
 
@@ -162,6 +182,18 @@ public:
         return static_cast<u64>(ticks <= 0 ? 0 : ticks);
     }
 
+    /**
+     * Stops the JIT if the access hits a GDB watchpoint. The GDB stub watches the pages of its
+     * watchpoints, so their accesses always reach these callbacks.
+     */
+    void CheckMemoryBreakpoint(VAddr vaddr, GDBStub::BreakpointType type) {
+        if (GDBStub::IsServerEnabled() && GDBStub::CheckBreakpoint(vaddr, type)) {
+            LOG_DEBUG(Debug, "Breaking on memory access at 0x{:08X}", vaddr);
+            GDBStub::Break(true);
+            parent.jit->HaltExecution();
+        }
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
@@ -185,6 +217,10 @@ void ARM_Dynarmic::Run() {
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
+
+    if (GDBStub::IsMemoryBreak()) {
+        ServeBreak();
+    }
 }
 
 void ARM_Dynarmic::Step() {
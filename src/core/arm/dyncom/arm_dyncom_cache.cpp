@@ -0,0 +1,143 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
+
+namespace {
+/// Cache of the block that is being translated on this thread
+thread_local TranslationCache* active_cache = nullptr;
+} // Anonymous namespace
+
+TranslationCache::TranslationCache() : buffer(std::make_unique<char[]>(BUFFER_SIZE)) {}
+
+TranslationCache::~TranslationCache() = default;
+
+std::optional<std::size_t> TranslationCache::Find(u32 pc) const {
+    const auto itr = index.find(pc);
+    if (itr == index.end()) {
+        return std::nullopt;
+    }
+    return itr->second;
+}
+
+std::size_t TranslationCache::BeginBlock(u32 pc) {
+    ASSERT_MSG(active_cache == nullptr, "A block is already being translated");
+
+    if (top + MAX_BLOCK_SIZE > BUFFER_SIZE) {
+        // Wrap around, the blocks from the previous lap after the top are the oldest ones
+        while (!blocks.empty() && blocks.front() >= top) {
+            Evict(blocks.front());
+        }
+        top = 0;
+    }
+
+    // Make room for the largest block in front of the top
+    while (!blocks.empty() && blocks.front() >= top && blocks.front() < top + MAX_BLOCK_SIZE) {
+        Evict(blocks.front());
+    }
+
+    block_start = top;
+    blocks.push_back(block_start);
+    top += sizeof(TransBlockHeader);
+
+    TransBlockHeader& header = GetBlock(block_start);
+    header = {};
+    header.pc = pc;
+    header.link_generation = generation - 1;
+
+    active_cache = this;
+    return block_start;
+}
+
+void TranslationCache::EndBlock(u32 end_pc) {
+    ASSERT(active_cache == this);
+    active_cache = nullptr;
+
+    // Keep the instructions of the next block aligned
+    top = (top + 7) & ~std::size_t{7};
+
+    TransBlockHeader& header = GetBlock(block_start);
+    header.end_pc = end_pc;
+    header.size = static_cast<u32>(top - block_start);
+    header.live = 1;
+
+    // A block that was translated again replaces the old one
+    if (const auto itr = index.find(header.pc); itr != index.end()) {
+        RemoveBlock(itr->second);
+    }
+    index[header.pc] = block_start;
+    for (u32 page = header.pc >> PAGE_BITS; page <= (end_pc - 1) >> PAGE_BITS; ++page) {
+        page_index[page].push_back(block_start);
+    }
+}
+
+void TranslationCache::Invalidate(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    const u32 first_page = start_address >> PAGE_BITS;
+    const u32 last_page = static_cast<u32>((start_address + length - 1) >> PAGE_BITS);
+    for (u32 page = first_page; page <= last_page; ++page) {
+        const auto itr = page_index.find(page);
+        if (itr == page_index.end()) {
+            continue;
+        }
+        // RemoveBlock updates the index of every page of the block, including this one
+        const std::vector<std::size_t> page_blocks = itr->second;
+        for (const std::size_t offset : page_blocks) {
+            RemoveBlock(offset);
+        }
+    }
+}
+
+void TranslationCache::Clear() {
+    ASSERT(active_cache != this);
+    top = 0;
+    blocks.clear();
+    index.clear();
+    page_index.clear();
+    generation++;
+}
+
+void TranslationCache::Evict(std::size_t offset) {
+    RemoveBlock(offset);
+    blocks.pop_front();
+}
+
+void TranslationCache::RemoveBlock(std::size_t offset) {
+    TransBlockHeader& header = GetBlock(offset);
+    if (!header.live) {
+        return;
+    }
+    header.live = 0;
+    generation++;
+
+    index.erase(header.pc);
+    for (u32 page = header.pc >> PAGE_BITS; page <= (header.end_pc - 1) >> PAGE_BITS; ++page) {
+        const auto itr = page_index.find(page);
+        if (itr == page_index.end()) {
+            continue;
+        }
+        auto& page_blocks = itr->second;
+        page_blocks.erase(std::remove(page_blocks.begin(), page_blocks.end(), offset),
+                          page_blocks.end());
+        if (page_blocks.empty()) {
+            page_index.erase(itr);
+        }
+    }
+}
+
+void* AllocTranslationBuffer(std::size_t size) {
+    TranslationCache* const cache = active_cache;
+    ASSERT_MSG(cache != nullptr, "No block is being translated");
+
+    const std::size_t start = cache->top;
+    cache->top += size;
+    ASSERT_MSG(cache->top - cache->block_start <= TranslationCache::MAX_BLOCK_SIZE,
+               "Translated block is too large");
+    return static_cast<void*>(cache->buffer.get() + start);
+}
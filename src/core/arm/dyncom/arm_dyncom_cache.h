@@ -0,0 +1,108 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+/// Header written in front of the translated instructions of every block.
+struct TransBlockHeader {
+    u32 pc;     ///< Address of the first instruction of the block
+    u32 end_pc; ///< Address following the last instruction of the block
+    u32 size;   ///< Size of the block in the buffer, including this header
+    u32 live;   ///< Whether the block is still in the index
+
+    // The block that was dispatched to after this one, followed without an index lookup as long
+    // as no block was removed since the link was made.
+    u32 link_pc;
+    u32 link_generation;
+    u64 link_offset;
+};
+static_assert(sizeof(TransBlockHeader) % 8 == 0, "Instructions following the header are aligned");
+
+/**
+ * Buffer holding the translated blocks of a core. Blocks are allocated in a ring, when the buffer
+ * runs out of space the oldest blocks are evicted. Blocks are indexed by their address and by the
+ * pages they were translated from, so that modifying code only drops the blocks of its pages.
+ */
+class TranslationCache {
+public:
+    /// Size of the buffer of the translated blocks.
+    static constexpr std::size_t BUFFER_SIZE = 32 * 1024 * 1024;
+
+    /// Largest size a single block can take in the buffer. A block ends at a page boundary, but the
+    /// last Thumb instruction of a page may straddle into the next one, so a block can span two
+    /// pages of 2-byte instructions, each of which takes at most 64 bytes once translated.
+    static constexpr std::size_t MAX_BLOCK_SIZE = 256 * 1024;
+
+    static constexpr u32 PAGE_BITS = 12;
+
+    TranslationCache();
+    ~TranslationCache();
+
+    TranslationCache(const TranslationCache&) = delete;
+    TranslationCache& operator=(const TranslationCache&) = delete;
+
+    char* GetBuffer() {
+        return buffer.get();
+    }
+
+    TransBlockHeader& GetBlock(std::size_t offset) {
+        return *reinterpret_cast<TransBlockHeader*>(buffer.get() + offset);
+    }
+
+    /// Returns the offset of the header of the block translated from pc, if there is one.
+    std::optional<std::size_t> Find(u32 pc) const;
+
+    /**
+     * Starts translating a new block, evicting the oldest blocks if there isn't enough space.
+     * Translated instructions are allocated with AllocTranslationBuffer until EndBlock is called.
+     * @returns the offset of the header of the new block.
+     */
+    std::size_t BeginBlock(u32 pc);
+
+    /// Ends the current block, which covers the instructions up to end_pc, and indexes it.
+    void EndBlock(u32 end_pc);
+
+    /// Removes the blocks translated from the pages overlapping the given range.
+    void Invalidate(u32 start_address, std::size_t length);
+
+    /// Removes all blocks.
+    void Clear();
+
+    /// Returns a value that changes whenever blocks are removed.
+    u32 GetGeneration() const {
+        return generation;
+    }
+
+    /// Returns the number of blocks in the index.
+    std::size_t NumBlocks() const {
+        return index.size();
+    }
+
+private:
+    friend void* AllocTranslationBuffer(std::size_t size);
+
+    void Evict(std::size_t offset);
+    void RemoveBlock(std::size_t offset);
+
+    std::unique_ptr<char[]> buffer;
+    std::size_t top = 0;
+    std::size_t block_start = 0;
+    u32 generation = 0;
+
+    /// Blocks in the order they were allocated, including the ones that were removed since.
+    std::deque<std::size_t> blocks;
+    std::unordered_map<u32, std::size_t> index;
+    std::unordered_map<u32, std::vector<std::size_t>> page_index;
+};
+
+/// Allocates memory for a translated instruction in the block that is being translated.
+void* AllocTranslationBuffer(std::size_t size);
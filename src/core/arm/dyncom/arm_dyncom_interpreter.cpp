@@ -849,10 +849,10 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     // Save start addr of basicblock in CreamCache
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
-    bb_start = trans_cache_buf_top;
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
+    bb_start = cpu->translation_cache.BeginBlock(pc_start);
 
     while (ret == TransExtData::NON_BRANCH) {
         u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
@@ -864,7 +864,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->translation_cache.EndBlock(phys_addr);
 
     return KEEP_GOING;
 }
@@ -873,18 +873,18 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
+    bb_start = cpu->translation_cache.BeginBlock(pc_start);
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->translation_cache.EndBlock(phys_addr + inst_size);
 
     return KEEP_GOING;
 }
@@ -1627,6 +1627,12 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
     std::size_t ptr;
 
+    TranslationCache& translation_cache = cpu->translation_cache;
+    char* const trans_cache_buf = translation_cache.GetBuffer();
+    std::size_t block;
+    TransBlockHeader* prev_block = nullptr;
+    u32 prev_generation = 0;
+
     LOAD_NZCVT;
 DISPATCH : {
     if (!cpu->NirqSig) {
@@ -1640,17 +1646,34 @@ DISPATCH : {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // Follow the link of the previous block if it still leads here. Links are only valid as long
+    // as no block was removed since they were made.
+    const u32 generation = translation_cache.GetGeneration();
+    if (prev_block != nullptr && prev_generation == generation &&
+        prev_block->link_generation == generation && prev_block->link_pc == cpu->Reg[15]) {
+        block = prev_block->link_offset;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        // Find the cached instruction cream, otherwise translate it...
+        if (const auto offset = translation_cache.Find(cpu->Reg[15])) {
+            block = *offset;
+        } else if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
+
+        // The translation may have evicted the previous block
+        if (prev_block != nullptr && prev_generation == translation_cache.GetGeneration()) {
+            prev_block->link_pc = cpu->Reg[15];
+            prev_block->link_offset = block;
+            prev_block->link_generation = prev_generation;
+        }
     }
+    prev_block = &translation_cache.GetBlock(block);
+    prev_generation = translation_cache.GetGeneration();
+    ptr = block + sizeof(TransBlockHeader);
 
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
@@ -0,0 +1,154 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <fmt/format.h>
+#include "core/call_stats.h"
+
+namespace Core {
+
+void CallCounters::Add(u64 nanoseconds) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+    u64 max = max_ns.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !max_ns.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+    buckets[std::min<std::size_t>(std::bit_width(nanoseconds), NUM_BUCKETS - 1)].fetch_add(
+        1, std::memory_order_relaxed);
+    frame_calls.fetch_add(1, std::memory_order_relaxed);
+    frame_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+void CallCounters::EndFrame() {
+    last_frame_calls.store(frame_calls.exchange(0, std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+    last_frame_ns.store(frame_ns.exchange(0, std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+}
+
+void CallCounters::Reset() {
+    for (auto* counter : {&calls, &total_ns, &max_ns, &frame_calls, &frame_ns, &last_frame_calls,
+                          &last_frame_ns}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void CallStats::FormatCounters(std::string& out, const CallCounters& counters) {
+    std::array<u64, CallCounters::NUM_BUCKETS> buckets;
+    std::transform(counters.buckets.begin(), counters.buckets.end(), buckets.begin(),
+                   [](const auto& bucket) { return bucket.load(std::memory_order_relaxed); });
+    fmt::format_to(std::back_inserter(out),
+                   "\"calls\":{},\"total_ns\":{},\"max_ns\":{},\"last_frame_calls\":{},"
+                   "\"last_frame_ns\":{},\"histogram\":[{}]",
+                   counters.calls.load(std::memory_order_relaxed),
+                   counters.total_ns.load(std::memory_order_relaxed),
+                   counters.max_ns.load(std::memory_order_relaxed),
+                   counters.last_frame_calls.load(std::memory_order_relaxed),
+                   counters.last_frame_ns.load(std::memory_order_relaxed),
+                   fmt::join(buckets, ","));
+}
+
+void CallStats::RecordSVC(u32 number, const char* name, u64 nanoseconds) {
+    if (number >= NUM_SVCS) {
+        return;
+    }
+
+    SVCEntry& entry = svcs[number];
+    entry.name.store(name, std::memory_order_relaxed);
+    entry.counters.Add(nanoseconds);
+}
+
+CallCounters& CallStats::RegisterServiceCommand(const void* service,
+                                                std::string_view service_name, u32 header,
+                                                const char* function_name) {
+    std::scoped_lock lock{mutex};
+    auto [itr, inserted] = services.try_emplace({service, header});
+    ServiceEntry& entry = itr->second;
+    if (inserted) {
+        entry.service_name = service_name;
+        entry.function_name = function_name;
+    }
+    return entry.counters;
+}
+
+void CallStats::UnregisterService(const void* service) {
+    std::scoped_lock lock{mutex};
+    const auto begin = services.lower_bound({service, 0});
+    const auto end = services.upper_bound({service, ~u32{0}});
+    services.erase(begin, end);
+}
+
+void CallStats::EndFrame() {
+    frames.fetch_add(1, std::memory_order_relaxed);
+    for (SVCEntry& entry : svcs) {
+        entry.counters.EndFrame();
+    }
+
+    std::scoped_lock lock{mutex};
+    for (auto& [key, entry] : services) {
+        entry.counters.EndFrame();
+    }
+}
+
+void CallStats::Reset() {
+    frames.store(0, std::memory_order_relaxed);
+    for (SVCEntry& entry : svcs) {
+        entry.counters.Reset();
+    }
+
+    // The services keep their counters registered, only their values are cleared
+    std::scoped_lock lock{mutex};
+    for (auto& [key, entry] : services) {
+        entry.counters.Reset();
+    }
+}
+
+std::string CallStats::DumpJson() const {
+    std::scoped_lock lock{mutex};
+
+    std::string out =
+        fmt::format("{{\"frames\":{},\"svcs\":[", frames.load(std::memory_order_relaxed));
+    bool first = true;
+    for (std::size_t number = 0; number < svcs.size(); ++number) {
+        const SVCEntry& entry = svcs[number];
+        if (entry.counters.calls.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        fmt::format_to(std::back_inserter(out), "{}{{\"number\":{},\"name\":\"{}\",",
+                       first ? "" : ",", number, entry.name.load(std::memory_order_relaxed));
+        FormatCounters(out, entry.counters);
+        out += '}';
+        first = false;
+    }
+
+    out += "],\"services\":[";
+    first = true;
+    for (const auto& [key, entry] : services) {
+        // Registered commands that weren't called are left out
+        if (entry.counters.calls.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        fmt::format_to(std::back_inserter(out),
+                       "{}{{\"service\":\"{}\",\"header\":\"{:#010x}\",\"function\":\"{}\",",
+                       first ? "" : ",", entry.service_name, key.second, entry.function_name);
+        FormatCounters(out, entry.counters);
+        out += '}';
+        first = false;
+    }
+    out += "]}";
+    return out;
+}
+
+CallStats& GetCallStats() {
+    static CallStats call_stats;
+    return call_stats;
+}
+
+} // namespace Core
@@ -0,0 +1,133 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Counters of one kind of call. They are updated without locking from the thread making the
+ * call, and aggregated by CallStats when they are read.
+ */
+class CallCounters {
+public:
+    /// Number of histogram buckets. Bucket i counts the calls that took [2^(i-1), 2^i) ns, the
+    /// last bucket also counts every longer call.
+    static constexpr std::size_t NUM_BUCKETS = 32;
+
+    /// Records a call that took `nanoseconds` of host time.
+    void Add(u64 nanoseconds);
+
+private:
+    friend class CallStats;
+
+    void EndFrame();
+    void Reset();
+
+    std::atomic<u64> calls{0};
+    std::atomic<u64> total_ns{0};
+    std::atomic<u64> max_ns{0};
+    std::array<std::atomic<u64>, NUM_BUCKETS> buckets{};
+    std::atomic<u64> frame_calls{0};
+    std::atomic<u64> frame_ns{0};
+    std::atomic<u64> last_frame_calls{0};
+    std::atomic<u64> last_frame_ns{0};
+};
+
+/**
+ * Counts the guest supervisor calls and HLE service commands, and how much host time they take.
+ * Every call is added to a latency histogram kept for the whole session, and to the counters of
+ * the current system frame, which are kept until the next frame ends.
+ */
+class CallStats {
+public:
+    /// Number of supervisor calls that can be tracked, indexed by their SVC number.
+    static constexpr std::size_t NUM_SVCS = 0x80;
+
+    /// Records a supervisor call that took `nanoseconds` of host time.
+    void RecordSVC(u32 number, const char* name, u64 nanoseconds);
+
+    /**
+     * Registers a command handled by an HLE service, returning the counters its calls are
+     * recorded to. The counters stay valid until the service is unregistered.
+     * @param service Identifies the service instance, services are keyed by it
+     * @param service_name Name of the service port
+     * @param header Command header of the request
+     * @param function_name Name of the command handler
+     */
+    CallCounters& RegisterServiceCommand(const void* service, std::string_view service_name,
+                                         u32 header, const char* function_name);
+
+    /// Removes the commands of a service that is being destroyed.
+    void UnregisterService(const void* service);
+
+    /// Ends the current frame, its counters are reported as the last frame.
+    void EndFrame();
+
+    /// Clears all the statistics, for a new emulation session.
+    void Reset();
+
+    /// Returns all the statistics as a JSON document.
+    std::string DumpJson() const;
+
+private:
+    struct SVCEntry {
+        std::atomic<const char*> name{nullptr};
+        CallCounters counters;
+    };
+
+    struct ServiceEntry {
+        std::string service_name;
+        const char* function_name = nullptr;
+        CallCounters counters;
+    };
+
+    /// Appends the counters as the members of a JSON object
+    static void FormatCounters(std::string& out, const CallCounters& counters);
+
+    /// Protects the service map, the counters themselves are atomic
+    mutable std::mutex mutex;
+    std::atomic<u64> frames{0};
+    std::array<SVCEntry, NUM_SVCS> svcs{};
+    std::map<std::pair<const void*, u32>, ServiceEntry> services;
+};
+
+/// Returns the statistics of the emulator. Safe to use from any thread.
+CallStats& GetCallStats();
+
+/// Records the host time spent in the enclosing scope as a supervisor call.
+class SVCCallScope {
+public:
+    SVCCallScope(u32 number, const char* name)
+        : number{number}, name{name}, begin{std::chrono::steady_clock::now()} {}
+
+    ~SVCCallScope() {
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        GetCallStats().RecordSVC(
+            number, name,
+            static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    SVCCallScope(const SVCCallScope&) = delete;
+    SVCCallScope& operator=(const SVCCallScope&) = delete;
+
+private:
+    u32 number;
+    const char* name;
+    std::chrono::steady_clock::time_point begin;
+};
+
+} // namespace Core
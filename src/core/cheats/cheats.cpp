@@ -8,6 +8,7 @@
 #include "common/file_util.h"
 #include "core/cheats/cheats.h"
 #include "core/cheats/gateway_cheat.h"
+#include "core/cheats/memory_scanner.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/process.h"
@@ -19,7 +20,8 @@ namespace Cheats {
 // we use the same value
 constexpr u64 run_interval_ticks = 50'000'000;
 
-CheatEngine::CheatEngine(Core::System& system_) : system(system_) {
+CheatEngine::CheatEngine(Core::System& system_)
+    : system(system_), memory_scanner(std::make_unique<MemoryScanner>(system.Memory())) {
     LoadCheatFile();
     Connect();
 }
@@ -63,6 +65,10 @@ void CheatEngine::UpdateCheat(std::size_t index, const std::shared_ptr<CheatBase
     cheats_list[index] = new_cheat;
 }
 
+MemoryScanner& CheatEngine::GetMemoryScanner() {
+    return *memory_scanner;
+}
+
 void CheatEngine::SaveCheatFile() const {
     const std::string cheat_dir = FileUtil::GetUserPath(FileUtil::UserPath::CheatsDir);
     const std::string filepath = fmt::format(
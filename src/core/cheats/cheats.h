@@ -21,6 +21,7 @@ struct EventType;
 namespace Cheats {
 
 class CheatBase;
+class MemoryScanner;
 
 class CheatEngine {
 public:
@@ -33,6 +34,9 @@ public:
     void UpdateCheat(std::size_t index, const std::shared_ptr<CheatBase>& new_cheat);
     void SaveCheatFile() const;
 
+    /// Returns the scanner used to search the emulated RAM for the addresses cheats should modify
+    MemoryScanner& GetMemoryScanner();
+
 private:
     void LoadCheatFile();
     void RunCallback(std::uintptr_t user_data, s64 cycles_late);
@@ -40,5 +44,6 @@ private:
     mutable std::shared_mutex cheats_list_mutex;
     Core::TimingEventType* event;
     Core::System& system;
+    std::unique_ptr<MemoryScanner> memory_scanner;
 };
 } // namespace Cheats
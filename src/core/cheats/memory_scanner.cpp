@@ -0,0 +1,371 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <thread>
+#include "common/assert.h"
+#include "common/thread_worker.h"
+#include "core/cheats/memory_scanner.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/settings.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace Cheats {
+
+namespace {
+
+/// Size of the memory a worker thread scans at once, every region is a multiple of it
+constexpr u32 CHUNK_SIZE = 1024 * 1024;
+
+/// Number of values whose candidate bits are stored in a word
+constexpr std::size_t GROUP_SIZE = 64;
+
+template <typename T>
+T FromBits(u64 bits) {
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+/// Packs the results of the comparisons of a group, each 0 or 1, into a bit mask
+u64 PackMask(const std::array<u8, GROUP_SIZE>& matches) {
+#ifdef ARCHITECTURE_x86_64
+    u64 mask = 0;
+    for (std::size_t i = 0; i < GROUP_SIZE; i += 16) {
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matches.data() + i));
+        // Turn 1 into 0xFF, movemask gathers the top bit of every byte
+        const __m128i set = _mm_sub_epi8(_mm_setzero_si128(), bytes);
+        mask |= u64{static_cast<u16>(_mm_movemask_epi8(set))} << i;
+    }
+    return mask;
+#else
+    u64 mask = 0;
+    for (std::size_t i = 0; i < GROUP_SIZE; ++i) {
+        mask |= u64{matches[i]} << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Compares the values of a chunk with the given function, clearing the bits of the candidates
+ * that don't match, and stores the current values of the remaining candidates.
+ * The comparisons of a group are branchless so that the compiler vectorizes them.
+ * @returns the number of remaining candidates.
+ */
+template <typename T, typename Compare>
+u64 ScanValues(const u8* current, u8* previous, u64* candidates, std::size_t num_values,
+               Compare compare) {
+    std::array<T, GROUP_SIZE> current_values;
+    std::array<T, GROUP_SIZE> previous_values;
+    std::array<u8, GROUP_SIZE> matches;
+
+    u64 count = 0;
+    for (std::size_t group = 0; group < num_values / GROUP_SIZE; ++group) {
+        u64& bits = candidates[group];
+        if (bits == 0) {
+            continue;
+        }
+
+        const std::size_t offset = group * sizeof(current_values);
+        std::memcpy(current_values.data(), current + offset, sizeof(current_values));
+        std::memcpy(previous_values.data(), previous + offset, sizeof(previous_values));
+        for (std::size_t i = 0; i < GROUP_SIZE; ++i) {
+            matches[i] = compare(current_values[i], previous_values[i]) ? 1 : 0;
+        }
+        bits &= PackMask(matches);
+        std::memcpy(previous + offset, current_values.data(), sizeof(current_values));
+        count += std::popcount(bits);
+    }
+    return count;
+}
+
+template <typename T>
+u64 ScanChunk(ScanComparison comparison, u64 value_bits, const u8* current, u8* previous,
+              u64* candidates, std::size_t num_values) {
+    const T value = FromBits<T>(value_bits);
+    const auto scan = [&](auto compare) {
+        return ScanValues<T>(current, previous, candidates, num_values, compare);
+    };
+
+    switch (comparison) {
+    case ScanComparison::Equal:
+        return scan([value](T cur, T) { return cur == value; });
+    case ScanComparison::NotEqual:
+        return scan([value](T cur, T) { return cur != value; });
+    case ScanComparison::Less:
+        return scan([value](T cur, T) { return cur < value; });
+    case ScanComparison::LessOrEqual:
+        return scan([value](T cur, T) { return cur <= value; });
+    case ScanComparison::Greater:
+        return scan([value](T cur, T) { return cur > value; });
+    case ScanComparison::GreaterOrEqual:
+        return scan([value](T cur, T) { return cur >= value; });
+    case ScanComparison::Changed:
+        return scan([](T cur, T prev) { return cur != prev; });
+    case ScanComparison::Unchanged:
+        return scan([](T cur, T prev) { return cur == prev; });
+    case ScanComparison::Increased:
+        return scan([](T cur, T prev) { return cur > prev; });
+    case ScanComparison::Decreased:
+        return scan([](T cur, T prev) { return cur < prev; });
+    case ScanComparison::IncreasedBy:
+        return scan([value](T cur, T prev) { return cur == static_cast<T>(prev + value); });
+    case ScanComparison::DecreasedBy:
+        return scan([value](T cur, T prev) { return cur == static_cast<T>(prev - value); });
+    }
+    UNREACHABLE_MSG("Unknown scan comparison {}", static_cast<u32>(comparison));
+    return 0;
+}
+
+/// Returns the virtual address at which the process maps the given host pointer.
+std::optional<VAddr> PointerToVirtualAddress(const Kernel::Process& process, const u8* pointer) {
+    for (const auto& [base, vma] : process.vm_manager.vma_map) {
+        if (vma.type != Kernel::VMAType::BackingMemory) {
+            continue;
+        }
+        const u8* backing = vma.backing_memory.GetPtr();
+        if (backing != nullptr && pointer >= backing && pointer < backing + vma.size) {
+            return static_cast<VAddr>(vma.base + (pointer - backing));
+        }
+    }
+    return std::nullopt;
+}
+
+} // Anonymous namespace
+
+MemoryScanner::MemoryScanner(Memory::MemorySystem& memory) : memory(memory) {}
+
+MemoryScanner::~MemoryScanner() = default;
+
+std::size_t MemoryScanner::GetValueSize(ScanValueType type) {
+    switch (type) {
+    case ScanValueType::U8:
+        return sizeof(u8);
+    case ScanValueType::U16:
+        return sizeof(u16);
+    case ScanValueType::U32:
+    case ScanValueType::Float:
+        return sizeof(u32);
+    case ScanValueType::U64:
+    case ScanValueType::Double:
+        return sizeof(u64);
+    }
+    UNREACHABLE_MSG("Unknown scan value type {}", static_cast<u32>(type));
+    return sizeof(u32);
+}
+
+template <typename Func>
+u64 MemoryScanner::ForEachChunk(Func&& func) {
+    std::size_t num_chunks = 0;
+    for (const Region& region : regions) {
+        num_chunks += region.size / CHUNK_SIZE;
+    }
+
+    std::vector<u64> results(num_chunks);
+    std::size_t chunk = 0;
+    for (Region& region : regions) {
+        for (u32 offset = 0; offset < region.size; offset += CHUNK_SIZE) {
+            workers->QueueWork([&func, &region, offset, &result = results[chunk++]] {
+                result = func(region, offset, CHUNK_SIZE);
+            });
+        }
+    }
+    workers->WaitForRequests();
+
+    u64 total = 0;
+    for (const u64 result : results) {
+        total += result;
+    }
+    return total;
+}
+
+void MemoryScanner::FlushRegions() {
+    // The rasterizer cache belongs to the emulation thread
+    Core::System::GetInstance().RunOnEmuThread([this] {
+        for (const Region& region : regions) {
+            Memory::RasterizerFlushRegion(region.base, region.size);
+        }
+    });
+}
+
+u64 MemoryScanner::NewScan(ScanValueType type) {
+    std::scoped_lock lock{mutex};
+
+    if (!workers) {
+        const std::size_t num_workers = std::max(1U, std::thread::hardware_concurrency());
+        workers = std::make_unique<Common::ThreadWorker>(num_workers, "MemoryScanner");
+    }
+
+    const std::size_t value_size = GetValueSize(type);
+    const auto add_region = [&](PAddr base, u32 size) {
+        ASSERT(size % CHUNK_SIZE == 0);
+        regions.push_back({
+            .base = base,
+            .size = size,
+            .pointer = memory.GetPhysicalPointer(base),
+            // Both are filled by the worker threads
+            .candidates = std::unique_ptr<u64[]>(new u64[size / value_size / GROUP_SIZE]),
+            .previous = std::unique_ptr<u8[]>(new u8[size]),
+        });
+    };
+
+    regions.clear();
+    const bool is_new_3ds = Settings::values.is_new_3ds;
+    add_region(Memory::FCRAM_PADDR, is_new_3ds ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+    add_region(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    if (is_new_3ds) {
+        add_region(Memory::N3DS_EXTRA_RAM_PADDR, Memory::N3DS_EXTRA_RAM_SIZE);
+    }
+
+    FlushRegions();
+    searching = true;
+    value_type = type;
+    num_results = ForEachChunk([value_size](Region& region, u32 offset, u32 size) -> u64 {
+        const std::size_t num_values = size / value_size;
+        u64* const candidates = region.candidates.get() + offset / value_size / GROUP_SIZE;
+        std::fill_n(candidates, num_values / GROUP_SIZE, ~u64{0});
+        std::memcpy(region.previous.get() + offset, region.pointer + offset, size);
+        return num_values;
+    });
+    return num_results;
+}
+
+u64 MemoryScanner::Scan(ScanComparison comparison, u64 value) {
+    std::scoped_lock lock{mutex};
+    if (!searching) {
+        return 0;
+    }
+
+    FlushRegions();
+    const auto scan_chunk = [&](auto type_tag) {
+        using T = decltype(type_tag);
+        return ForEachChunk([comparison, value](Region& region, u32 offset, u32 size) {
+            return ScanChunk<T>(comparison, value, region.pointer + offset,
+                                region.previous.get() + offset,
+                                region.candidates.get() + offset / sizeof(T) / GROUP_SIZE,
+                                size / sizeof(T));
+        });
+    };
+
+    switch (value_type) {
+    case ScanValueType::U8:
+        num_results = scan_chunk(u8{});
+        break;
+    case ScanValueType::U16:
+        num_results = scan_chunk(u16{});
+        break;
+    case ScanValueType::U32:
+        num_results = scan_chunk(u32{});
+        break;
+    case ScanValueType::U64:
+        num_results = scan_chunk(u64{});
+        break;
+    case ScanValueType::Float:
+        num_results = scan_chunk(float{});
+        break;
+    case ScanValueType::Double:
+        num_results = scan_chunk(double{});
+        break;
+    }
+    return num_results;
+}
+
+void MemoryScanner::Reset() {
+    std::scoped_lock lock{mutex};
+    searching = false;
+    num_results = 0;
+    regions.clear();
+    workers.reset();
+}
+
+bool MemoryScanner::IsSearching() const {
+    std::scoped_lock lock{mutex};
+    return searching;
+}
+
+ScanValueType MemoryScanner::GetValueType() const {
+    std::scoped_lock lock{mutex};
+    return value_type;
+}
+
+u64 MemoryScanner::NumResults() const {
+    std::scoped_lock lock{mutex};
+    return num_results;
+}
+
+std::vector<ScanResult> MemoryScanner::GetResults(u64 first, std::size_t count) const {
+    std::scoped_lock lock{mutex};
+
+    std::vector<ScanResult> results;
+    if (!searching || first >= num_results) {
+        return results;
+    }
+    results.reserve(static_cast<std::size_t>(std::min<u64>(count, num_results - first)));
+
+    const std::size_t value_size = GetValueSize(value_type);
+    u64 skip = first;
+    for (const Region& region : regions) {
+        const std::size_t num_words = region.size / value_size / GROUP_SIZE;
+        for (std::size_t word = 0; word < num_words; ++word) {
+            u64 bits = region.candidates[word];
+            const auto num_bits = static_cast<u64>(std::popcount(bits));
+            if (skip >= num_bits) {
+                skip -= num_bits;
+                continue;
+            }
+            for (; bits != 0; bits &= bits - 1) {
+                if (skip != 0) {
+                    skip--;
+                    continue;
+                }
+                if (results.size() == count) {
+                    return results;
+                }
+                const std::size_t offset =
+                    (word * GROUP_SIZE + static_cast<std::size_t>(std::countr_zero(bits))) *
+                    value_size;
+                u64 value = 0;
+                std::memcpy(&value, region.previous.get() + offset, value_size);
+                results.push_back({static_cast<PAddr>(region.base + offset), value});
+            }
+            if (results.size() == count) {
+                return results;
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<std::optional<VAddr>> MemoryScanner::GetVirtualAddresses(
+    const std::vector<ScanResult>& results) const {
+    std::vector<std::optional<VAddr>> addresses(results.size());
+
+    // The memory mappings of the processes are changed by the emulation thread
+    auto& system = Core::System::GetInstance();
+    system.RunOnEmuThread([&] {
+        const auto process = system.Kernel().GetCurrentProcess();
+        if (!process) {
+            return;
+        }
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const u8* pointer = memory.GetPhysicalPointer(results[i].address);
+            if (pointer != nullptr) {
+                addresses[i] = PointerToVirtualAddress(*process, pointer);
+            }
+        }
+    });
+    return addresses;
+}
+
+} // namespace Cheats
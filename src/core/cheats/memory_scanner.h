@@ -0,0 +1,137 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+class ThreadWorker;
+}
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace Cheats {
+
+enum class ScanValueType : u32 {
+    U8,
+    U16,
+    U32,
+    U64,
+    Float,
+    Double,
+};
+
+enum class ScanComparison : u32 {
+    // Compare the current value with the searched value
+    Equal,
+    NotEqual,
+    Less,
+    LessOrEqual,
+    Greater,
+    GreaterOrEqual,
+    // Compare the current value with the value of the previous pass
+    Changed,
+    Unchanged,
+    Increased,
+    Decreased,
+    // Compare the difference with the value of the previous pass with the searched value
+    IncreasedBy,
+    DecreasedBy,
+};
+
+struct ScanResult {
+    PAddr address;
+    u64 value; ///< Raw bits of the value at the last pass
+};
+
+/**
+ * Searches the emulated RAM (FCRAM, VRAM and the New 3DS extra RAM) for values, to find the
+ * addresses cheats should modify. A search starts with every aligned value of the searched type
+ * as a candidate, and every pass keeps the candidates that match its comparison.
+ *
+ * Candidates are kept as bitsets with one bit per aligned value, and the values of the previous
+ * pass are kept for the relative comparisons. Passes are split over worker threads.
+ * Memory is read while the emulation runs, so a pass reflects the memory at the time of the pass.
+ * The rasterizer cache is flushed to the memory before every pass.
+ */
+class MemoryScanner {
+public:
+    explicit MemoryScanner(Memory::MemorySystem& memory);
+    ~MemoryScanner();
+
+    /**
+     * Starts a new search for a value of the given type whose initial value is unknown.
+     * @returns the number of candidates.
+     */
+    u64 NewScan(ScanValueType type);
+
+    /**
+     * Runs a pass of the current search.
+     * @param comparison Comparison the candidates must match to be kept
+     * @param value Raw bits of the searched value, ignored by the comparisons with the previous
+     *              pass that don't take one
+     * @returns the number of remaining candidates.
+     */
+    u64 Scan(ScanComparison comparison, u64 value);
+
+    /// Ends the current search and frees its memory.
+    void Reset();
+
+    /// Returns whether a search was started.
+    bool IsSearching() const;
+
+    /// Returns the type of the values of the current search.
+    ScanValueType GetValueType() const;
+
+    /// Returns the number of remaining candidates.
+    u64 NumResults() const;
+
+    /// Returns up to count candidates, starting with the first-th one in address order.
+    std::vector<ScanResult> GetResults(u64 first, std::size_t count) const;
+
+    /**
+     * Returns the virtual addresses at which the current process maps the given results, or
+     * std::nullopt for the results it doesn't map.
+     */
+    std::vector<std::optional<VAddr>> GetVirtualAddresses(
+        const std::vector<ScanResult>& results) const;
+
+    /// Returns the size in bytes of a value of the given type.
+    static std::size_t GetValueSize(ScanValueType type);
+
+private:
+    struct Region {
+        PAddr base;
+        u32 size;
+        u8* pointer;
+        std::unique_ptr<u64[]> candidates; ///< One bit per aligned value
+        std::unique_ptr<u8[]> previous;    ///< Values at the last pass
+    };
+
+    /// Runs func(region, first_byte, num_bytes) on every chunk of every region, in parallel.
+    /// @returns the sum of the values func returned.
+    template <typename Func>
+    u64 ForEachChunk(Func&& func);
+
+    /// Writes the surfaces of the rasterizer cache that overlap the regions back to the memory.
+    void FlushRegions();
+
+    Memory::MemorySystem& memory;
+    std::unique_ptr<Common::ThreadWorker> workers;
+
+    mutable std::mutex mutex;
+    bool searching = false;
+    ScanValueType value_type = ScanValueType::U32;
+    u64 num_results = 0;
+    std::vector<Region> regions;
+};
+
+} // namespace Cheats
@@ -11,6 +11,7 @@
 #include "audio_core/hle/hle.h"
 #include "audio_core/lle/lle.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
 #include "common/texture.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
@@ -50,6 +51,8 @@
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
+MICROPROFILE_DEFINE(Core_RunCPU, "Core", "Run CPU", MP_RGB(255, 128, 64));
+
 namespace Core {
 
 /*static*/ System System::s_instance;
@@ -142,6 +145,10 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         break;
     }
 
+    RunQueuedWork();
+    memory->ApplyQueuedCacheMarks();
+    memory->ApplyQueuedWatchChanges();
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -180,6 +187,7 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             current_core_to_execute->GetTimer().Idle();
             PrepareReschedule();
         } else {
+            MICROPROFILE_FRAME_SCOPE(Core_RunCPU, FrameCounter::CpuTime);
             if (tight_loop) {
                 current_core_to_execute->Run();
             } else {
@@ -212,6 +220,7 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
                 cpu_core->GetTimer().Idle();
                 PrepareReschedule();
             } else {
+                MICROPROFILE_FRAME_SCOPE(Core_RunCPU, FrameCounter::CpuTime);
                 if (tight_loop) {
                     cpu_core->Run();
                 } else {
@@ -232,6 +241,38 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+void System::RunOnEmuThread(std::function<void()> func) {
+    std::packaged_task<void()> task{std::move(func)};
+    std::future<void> done = task.get_future();
+    {
+        std::scoped_lock lock{queued_work_mutex};
+        if (accepts_queued_work) {
+            queued_work.push_back(std::move(task));
+            has_queued_work = true;
+        }
+    }
+    // The task is left valid when it wasn't queued
+    if (task.valid()) {
+        task();
+    }
+    done.get();
+}
+
+void System::RunQueuedWork() {
+    if (!has_queued_work.exchange(false)) {
+        return;
+    }
+
+    std::vector<std::packaged_task<void()>> work;
+    {
+        std::scoped_lock lock{queued_work_mutex};
+        work.swap(queued_work);
+    }
+    for (auto& task : work) {
+        task();
+    }
+}
+
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::lock_guard lock{signal_mutex};
     if (current_signal != signal && current_signal != Signal::None) {
@@ -342,8 +383,17 @@ void System::PrepareReschedule() {
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
-                                  : PerfStats::Results{};
+    if (!perf_stats || !timing) {
+        return PerfStats::Results{};
+    }
+
+    PerfStats::Results results = perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    if (dsp_core) {
+        const auto audio_stats = dsp_core->GetAndResetOutputStats();
+        results.audio_underruns = audio_stats.underruns;
+        results.audio_overruns = audio_stats.overruns;
+    }
+    return results;
 }
 
 void System::Reschedule() {
@@ -406,6 +456,8 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
 
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
+    dsp_core->EnableLowLatency(Settings::values.enable_low_latency_audio,
+                               Settings::values.audio_latency_target);
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
@@ -437,6 +489,10 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     LOG_DEBUG(Core, "Initialized OK");
 
     initalized = true;
+    {
+        std::scoped_lock lock{queued_work_mutex};
+        accepts_queued_work = true;
+    }
 
     return ResultStatus::Success;
 }
@@ -522,6 +578,13 @@ void System::RegisterImageInterface(std::shared_ptr<Frontend::ImageInterface> im
 }
 
 void System::Shutdown(bool is_deserializing) {
+    // Finish the queued work while the system is intact, later calls run on their thread
+    {
+        std::scoped_lock lock{queued_work_mutex};
+        accepts_queued_work = false;
+    }
+    RunQueuedWork();
+
     // Log last frame performance stats
     const auto perf_results = GetAndResetPerfStats();
     constexpr auto performance = Common::Telemetry::FieldType::Performance;
@@ -532,6 +595,16 @@ void System::Shutdown(bool is_deserializing) {
     telemetry_session->AddField(performance, "Shutdown_Frametime", perf_results.frametime * 1000.0);
     telemetry_session->AddField(performance, "Mean_Frametime_MS", perf_stats->GetMeanFrametime());
 
+    const u64 ubershader_draws = perf_stats->GetSessionCounter(FrameCounter::UberShaderDraws);
+    telemetry_session->AddField(performance, "Shutdown_UberShaderDraws", ubershader_draws);
+    if (ubershader_draws != 0) {
+        LOG_INFO(Core, "{} draws used the fragment ubershader while shaders were compiling",
+                 ubershader_draws);
+    }
+
+    const u64 surface_evictions = perf_stats->GetSessionCounter(FrameCounter::SurfaceEvictions);
+    telemetry_session->AddField(performance, "Shutdown_SurfaceEvictions", surface_evictions);
+
     // Shutdown emulation session
     VideoCore::Shutdown();
     HW::Shutdown();
@@ -652,7 +725,7 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         Service::GSP::SetGlobalModule(*this);
         memory->SetDSP(*dsp_core);
         cheat_engine->Connect();
-        VideoCore::g_renderer->Sync();
+        VideoCore::RunOnRenderer([] { VideoCore::g_renderer->Sync(); });
     }
 }
 
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
 #include "core/custom_tex_cache.h"
@@ -134,6 +138,20 @@ public:
         SendSignal(Signal::Shutdown);
     }
 
+    /**
+     * Runs a function on the emulation thread between two slices, where it can access the page
+     * tables, the memory mappings of the processes and the rasterizer cache, and waits for it to
+     * return. Must not be called by the emulation thread. The function runs on the calling thread
+     * when the emulation isn't running.
+     */
+    void RunOnEmuThread(std::function<void()> func);
+
+    /**
+     * Runs the functions queued by RunOnEmuThread. Called by the emulation thread between slices,
+     * and by the frontends while the emulation is paused.
+     */
+    void RunQueuedWork();
+
     /**
      * Load an executable application.
      * @param emu_window Reference to the host-system window used for video output and keyboard
@@ -395,6 +413,12 @@ private:
     Signal current_signal;
     u32 signal_param;
 
+    /// Functions queued for the emulation thread by other threads, see RunOnEmuThread
+    std::mutex queued_work_mutex;
+    std::vector<std::packaged_task<void()>> queued_work;
+    std::atomic_bool has_queued_work = false;
+    bool accepts_queued_work = false;
+
     friend class boost::serialization::access;
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int file_version);
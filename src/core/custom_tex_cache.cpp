@@ -2,16 +2,63 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <thread>
 #include <fmt/format.h>
 #include "common/file_util.h"
+#include "common/swap.h"
 #include "common/texture.h"
+#include "common/thread_worker.h"
 #include "core.h"
 #include "core/custom_tex_cache.h"
 
 namespace Core {
+
+namespace {
+
+/// PICA textures have at most eight levels including the base one
+constexpr std::size_t MAX_MIP_LEVELS = 7;
+
+/// Converts the RGBA8 pixels decoded from a PNG to the byte order of PICA RGBA8 textures
+void ConvertRGBAToABGR(std::vector<u8>& tex) {
+    for (std::size_t i = 0; i + 4 <= tex.size(); i += 4) {
+        u32 rgba;
+        std::memcpy(&rgba, tex.data() + i, sizeof(u32));
+        const u32 abgr = Common::swap32(rgba);
+        std::memcpy(tex.data() + i, &abgr, sizeof(u32));
+    }
+}
+
+/// Averages each 2x2 block of src into a texture of half the size
+std::vector<u8> DownscaleTexture(const std::vector<u8>& src, u32 width, u32 height) {
+    const u32 mip_width = width / 2;
+    const u32 mip_height = height / 2;
+    std::vector<u8> mip(mip_width * mip_height * 4);
+    for (u32 y = 0; y < mip_height; y++) {
+        const u8* row0 = src.data() + (y * 2) * width * 4;
+        const u8* row1 = row0 + width * 4;
+        u8* dest = mip.data() + y * mip_width * 4;
+        for (u32 x = 0; x < mip_width * 4; x++) {
+            const u32 texel = x / 4 * 8 + x % 4;
+            dest[x] = static_cast<u8>((row0[texel] + row0[texel + 4] + row1[texel] +
+                                       row1[texel + 4] + 2) /
+                                      4);
+        }
+    }
+    return mip;
+}
+
+} // Anonymous namespace
+
 CustomTexCache::CustomTexCache() = default;
 
-CustomTexCache::~CustomTexCache() = default;
+CustomTexCache::~CustomTexCache() {
+    // Skip the decodes still queued, the worker threads finish them before being joined
+    stop_decoding = true;
+    decode_worker.reset();
+}
 
 bool CustomTexCache::IsTextureDumped(u64 hash) const {
     return dumped_textures.count(hash);
@@ -22,15 +69,19 @@ void CustomTexCache::SetTextureDumped(const u64 hash) {
 }
 
 bool CustomTexCache::IsTextureCached(u64 hash) const {
+    std::lock_guard lock{textures_mutex};
     return custom_textures.count(hash);
 }
 
 const CustomTexInfo& CustomTexCache::LookupTexture(u64 hash) const {
+    // Cached textures are never erased, so the reference stays valid after unlocking
+    std::lock_guard lock{textures_mutex};
     return custom_textures.at(hash);
 }
 
 void CustomTexCache::CacheTexture(u64 hash, const std::vector<u8>& tex, u32 width, u32 height) {
-    custom_textures[hash] = {width, height, tex};
+    std::lock_guard lock{textures_mutex};
+    custom_textures[hash] = {width, height, tex, {}};
 }
 
 void CustomTexCache::AddTexturePath(u64 hash, const std::string& path) {
@@ -74,25 +125,18 @@ void CustomTexCache::FindCustomTextures(u64 program_id) {
 }
 
 void CustomTexCache::PreloadTextures(Frontend::ImageInterface& image_interface) {
+    Common::ThreadWorker& worker = GetDecodeWorker();
     for (const auto& path : custom_texture_paths) {
         const auto& path_info = path.second;
-        Core::CustomTexInfo tex_info;
-        if (image_interface.DecodePNG(tex_info.tex, tex_info.width, tex_info.height,
-                                      path_info.path)) {
-            // Make sure the texture size is a power of 2
-            std::bitset<32> width_bits(tex_info.width);
-            std::bitset<32> height_bits(tex_info.height);
-            if (width_bits.count() == 1 && height_bits.count() == 1) {
-                LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-                Common::FlipRGBA8Texture(tex_info.tex, tex_info.width, tex_info.height);
-                CacheTexture(path_info.hash, tex_info.tex, tex_info.width, tex_info.height);
-            } else {
-                LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
+        worker.QueueWork([this, &image_interface, &path_info] {
+            CustomTexInfo tex_info;
+            if (DecodeTexture(image_interface, path_info, tex_info)) {
+                std::lock_guard lock{textures_mutex};
+                custom_textures[path_info.hash] = std::move(tex_info);
             }
-        } else {
-            LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
-        }
+        });
     }
+    worker.WaitForRequests();
 }
 
 bool CustomTexCache::CustomTextureExists(u64 hash) const {
@@ -106,4 +150,72 @@ const CustomTexPathInfo& CustomTexCache::LookupTexturePathInfo(u64 hash) const {
 bool CustomTexCache::IsTexturePathMapEmpty() const {
     return custom_texture_paths.size() == 0;
 }
+
+void CustomTexCache::QueueTextureDecode(
+    u64 hash, std::shared_ptr<Frontend::ImageInterface> image_interface) {
+    {
+        std::lock_guard lock{textures_mutex};
+        if (custom_textures.count(hash) || !decoding_textures.insert(hash).second) {
+            return;
+        }
+    }
+
+    const CustomTexPathInfo& path_info = custom_texture_paths.at(hash);
+    GetDecodeWorker().QueueWork([this, &path_info, image_interface] {
+        CustomTexInfo tex_info;
+        const bool decoded =
+            !stop_decoding && DecodeTexture(*image_interface, path_info, tex_info);
+
+        std::lock_guard lock{textures_mutex};
+        if (decoded) {
+            custom_textures[path_info.hash] = std::move(tex_info);
+        }
+        decoding_textures.erase(path_info.hash);
+    });
+}
+
+bool CustomTexCache::IsTextureDecoding(u64 hash) const {
+    std::lock_guard lock{textures_mutex};
+    return decoding_textures.count(hash);
+}
+
+bool CustomTexCache::DecodeTexture(Frontend::ImageInterface& image_interface,
+                                   const CustomTexPathInfo& path_info, CustomTexInfo& tex_info) {
+    if (!image_interface.DecodePNG(tex_info.tex, tex_info.width, tex_info.height,
+                                   path_info.path)) {
+        LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
+        return false;
+    }
+
+    // Make sure the texture size is a power of 2
+    std::bitset<32> width_bits(tex_info.width);
+    std::bitset<32> height_bits(tex_info.height);
+    if (width_bits.count() != 1 || height_bits.count() != 1) {
+        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
+        return false;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
+    Common::FlipRGBA8Texture(tex_info.tex, tex_info.width, tex_info.height);
+    ConvertRGBAToABGR(tex_info.tex);
+
+    u32 width = tex_info.width;
+    u32 height = tex_info.height;
+    while (tex_info.mips.size() < MAX_MIP_LEVELS && width > 1 && height > 1) {
+        const auto& level = tex_info.mips.empty() ? tex_info.tex : tex_info.mips.back();
+        tex_info.mips.push_back(DownscaleTexture(level, width, height));
+        width /= 2;
+        height /= 2;
+    }
+
+    return true;
+}
+
+Common::ThreadWorker& CustomTexCache::GetDecodeWorker() {
+    if (!decode_worker) {
+        const std::size_t num_workers = std::max(1U, std::thread::hardware_concurrency() / 2);
+        decode_worker = std::make_unique<Common::ThreadWorker>(num_workers, "TextureDecoder");
+    }
+    return *decode_worker;
+}
 } // namespace Core
@@ -4,21 +4,30 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "common/common_types.h"
 
+namespace Common {
+class ThreadWorker;
+} // namespace Common
+
 namespace Frontend {
 class ImageInterface;
 } // namespace Frontend
 
 namespace Core {
+// Pixels are flipped vertically and stored in the PICA RGBA8 byte order
 struct CustomTexInfo {
     u32 width;
     u32 height;
     std::vector<u8> tex;
+    std::vector<std::vector<u8>> mips; ///< Downscaled levels following the base one
 };
 
 // This is to avoid parsing the filename multiple times
@@ -47,9 +56,24 @@ public:
     const CustomTexPathInfo& LookupTexturePathInfo(u64 hash) const;
     bool IsTexturePathMapEmpty() const;
 
+    /// Queues decoding the texture on the worker threads unless it is cached or already queued
+    void QueueTextureDecode(u64 hash, std::shared_ptr<Frontend::ImageInterface> image_interface);
+    /// Returns true while the texture is queued or being decoded
+    bool IsTextureDecoding(u64 hash) const;
+
 private:
+    /// Decodes the texture of path_info and generates its mipmaps, returns false on failure
+    static bool DecodeTexture(Frontend::ImageInterface& image_interface,
+                              const CustomTexPathInfo& path_info, CustomTexInfo& tex_info);
+
+    Common::ThreadWorker& GetDecodeWorker();
+
     std::unordered_set<u64> dumped_textures;
     std::unordered_map<u64, CustomTexInfo> custom_textures;
     std::unordered_map<u64, CustomTexPathInfo> custom_texture_paths;
+    std::unordered_set<u64> decoding_textures;
+    mutable std::mutex textures_mutex; ///< Guards custom_textures and decoding_textures
+    std::atomic<bool> stop_decoding{false};
+    std::unique_ptr<Common::ThreadWorker> decode_worker;
 };
 } // namespace Core
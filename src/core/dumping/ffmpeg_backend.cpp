@@ -549,7 +549,7 @@ bool FFmpegBackend::StartDumping(const std::string& path, const Layout::Framebuf
         }
     });
 
-    VideoCore::g_renderer->PrepareVideoDumping();
+    VideoCore::RunOnRenderer([] { VideoCore::g_renderer->PrepareVideoDumping(); });
     is_dumping = true;
 
     return true;
@@ -582,7 +582,7 @@ void FFmpegBackend::AddAudioSample(const std::array<s16, 2>& sample) {
 
 void FFmpegBackend::StopDumping() {
     is_dumping = false;
-    VideoCore::g_renderer->CleanupVideoDumping();
+    VideoCore::RunOnRenderer([] { VideoCore::g_renderer->CleanupVideoDumping(); });
 
     // Flush the video processing queue
     AddVideoFrame(VideoFrame());
@@ -398,6 +398,15 @@ static BreakpointMap& GetBreakpointMap(BreakpointType type) {
     }
 }
 
+/**
+ * Returns the watch range that makes the accesses to a read or write breakpoint go through the
+ * slow path of the memory accessors, where the breakpoints are checked.
+ */
+static Memory::WatchRange GetWatchRange(BreakpointType type, const Breakpoint& breakpoint) {
+    return {breakpoint.addr, breakpoint.len, type == BreakpointType::Read,
+            type == BreakpointType::Write};
+}
+
 /**
  * Remove the breakpoint from the given address of the specified type.
  *
@@ -423,6 +432,10 @@ static void RemoveBreakpoint(BreakpointType type, VAddr addr) {
         for (u32 i = 0; i < num_cores; ++i) {
             Core::GetCore(i).ClearInstructionCache();
         }
+    } else {
+        auto& system = Core::System::GetInstance();
+        system.Memory().RemoveWatch(*system.Kernel().GetCurrentProcess()->vm_manager.page_table,
+                                    GetWatchRange(type, bp->second));
     }
     p.erase(addr);
 }
@@ -945,6 +958,10 @@ static bool CommitBreakpoint(BreakpointType type, VAddr addr, u32 len) {
             *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, btrap.data(),
             btrap.size());
         Core::GetRunningCore().ClearInstructionCache();
+    } else {
+        auto& system = Core::System::GetInstance();
+        system.Memory().AddWatch(*system.Kernel().GetCurrentProcess()->vm_manager.page_table,
+                                 GetWatchRange(type, breakpoint));
     }
     p.insert({addr, breakpoint});
 
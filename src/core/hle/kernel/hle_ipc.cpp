@@ -32,17 +32,7 @@ public:
         auto process = thread->owner_process.lock();
         ASSERT(process);
 
-        // We must copy the entire command buffer *plus* the entire static buffers area, since
-        // the translation might need to read from it in order to retrieve the StaticBuffer
-        // target addresses.
-        std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buff;
-        Memory::MemorySystem& memory = context->kernel.memory;
-        memory.ReadBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                         cmd_buff.size() * sizeof(u32));
-        context->WriteToOutgoingCommandBuffer(cmd_buff.data(), *process);
-        // Copy the translated command buffer back into the thread's command buffer area.
-        memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                          cmd_buff.size() * sizeof(u32));
+        context->WriteToThreadCommandBuffer(*process);
     }
 
 private:
@@ -103,6 +93,18 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(std::shared_ptr<ServerSession> session_,
+                              std::shared_ptr<Thread> thread_) {
+    session = std::move(session_);
+    thread = std::move(thread_);
+    cmd_buf[0] = 0;
+    request_handles.clear();
+    for (auto& buffer : static_buffers) {
+        buffer.clear();
+    }
+    request_mapped_buffers.clear();
+}
+
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -283,6 +285,46 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
     return RESULT_SUCCESS;
 }
 
+ResultCode HLERequestContext::PopulateFromThreadCommandBuffer(
+    std::shared_ptr<Process> src_process) {
+    const VAddr cmdbuf_address = thread->GetCommandBufferAddress();
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH> src_cmdbuf;
+
+    // Read the header first, so that only the words of the request have to be copied
+    kernel.memory.ReadBlock(*src_process, cmdbuf_address, src_cmdbuf.data(), sizeof(u32));
+    IPC::Header header{src_cmdbuf[0]};
+    const std::size_t command_size = std::min<std::size_t>(
+        1u + header.normal_params_size + header.translate_params_size, src_cmdbuf.size());
+    kernel.memory.ReadBlock(*src_process, cmdbuf_address + 4, src_cmdbuf.data() + 1,
+                            (command_size - 1) * sizeof(u32));
+
+    return PopulateFromIncomingCommandBuffer(src_cmdbuf.data(), std::move(src_process));
+}
+
+ResultCode HLERequestContext::WriteToThreadCommandBuffer(Process& dst_process) const {
+    const VAddr cmdbuf_address = thread->GetCommandBufferAddress();
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> dst_cmdbuf;
+
+    IPC::Header header{cmd_buf[0]};
+    const std::size_t command_size =
+        std::min<std::size_t>(1u + header.normal_params_size + header.translate_params_size,
+                              IPC::COMMAND_BUFFER_LENGTH);
+
+    // The translation might need to read the static buffers area, which is located right after
+    // the command buffer, in order to retrieve the StaticBuffer target addresses.
+    if (header.translate_params_size != 0) {
+        const VAddr static_buffers_address = cmdbuf_address + 0x100;
+        kernel.memory.ReadBlock(dst_process, static_buffers_address,
+                                dst_cmdbuf.data() + IPC::COMMAND_BUFFER_LENGTH,
+                                2 * IPC::MAX_STATIC_BUFFERS * sizeof(u32));
+    }
+
+    const ResultCode result = WriteToOutgoingCommandBuffer(dst_cmdbuf.data(), dst_process);
+    kernel.memory.WriteBlock(dst_process, cmdbuf_address, dst_cmdbuf.data(),
+                             command_size * sizeof(u32));
+    return result;
+}
+
 MappedBuffer& HLERequestContext::GetMappedBuffer(u32 id_from_cmdbuf) {
     ASSERT_MSG(id_from_cmdbuf < request_mapped_buffers.size(), "Mapped Buffer ID out of range!");
     return request_mapped_buffers[id_from_cmdbuf];
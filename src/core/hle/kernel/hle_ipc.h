@@ -285,6 +285,23 @@ public:
     /// Writes data from this context back to the requesting process/thread.
     ResultCode WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf, Process& dst_process) const;
 
+    /**
+     * Reads the request from the command buffer of the requesting thread and populates this
+     * context with it. Only the words described by the request header are copied.
+     */
+    ResultCode PopulateFromThreadCommandBuffer(std::shared_ptr<Process> src_process);
+    /**
+     * Translates the response and writes it to the command buffer of the requesting thread. Only
+     * the words described by the response header are copied.
+     */
+    ResultCode WriteToThreadCommandBuffer(Process& dst_process) const;
+
+    /**
+     * Clears all the data of the previous request, so that this context can be reused for a new
+     * request made through the given session and thread.
+     */
+    void Reset(std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread);
+
     /// Reports an unimplemented function.
     void ReportUnimplemented() const;
 
@@ -185,6 +185,14 @@ void KernelSystem::serialize(Archive& ar, const unsigned int file_version) {
         for (auto& process : process_list) {
             process->vm_manager.Unlock();
         }
+        // Savestates from before waiting lists were sorted store them in arrival order
+        for (auto& thread_manager : thread_managers) {
+            for (auto& thread : thread_manager->thread_list) {
+                for (auto& object : thread->wait_objects) {
+                    object->SortWaitingThreads();
+                }
+            }
+        }
     }
 }
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include "common/archives.h"
@@ -12,6 +13,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/thread.h"
 
 SERIALIZE_EXPORT_IMPL(Kernel::Mutex)
@@ -31,7 +33,7 @@ Mutex::Mutex(KernelSystem& kernel) : WaitObject(kernel), kernel(kernel) {}
 Mutex::~Mutex() {}
 
 std::shared_ptr<Mutex> KernelSystem::CreateMutex(bool initial_locked, std::string name) {
-    auto mutex{std::make_shared<Mutex>(*this)};
+    auto mutex{MakeSlabObject<Mutex>(*this)};
 
     mutex->lock_count = 0;
     mutex->name = std::move(name);
@@ -112,11 +114,11 @@ void Mutex::UpdatePriority() {
     if (!holding_thread)
         return;
 
+    // The waiting list is sorted by priority, the first waiter has the best one
     u32 best_priority = ThreadPrioLowest;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
-    }
+    const auto& waiters = GetWaitingThreads();
+    if (!waiters.empty())
+        best_priority = std::min(best_priority, waiters.front()->current_priority);
 
     if (best_priority != priority) {
         priority = best_priority;
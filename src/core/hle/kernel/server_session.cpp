@@ -12,6 +12,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/thread.h"
 
 SERIALIZE_EXPORT_IMPL(Kernel::ServerSession)
@@ -47,7 +48,7 @@ ServerSession::~ServerSession() {
 
 ResultVal<std::shared_ptr<ServerSession>> ServerSession::Create(KernelSystem& kernel,
                                                                 std::string name) {
-    auto server_session{std::make_shared<ServerSession>(kernel)};
+    auto server_session{MakeSlabObject<ServerSession>(kernel)};
 
     server_session->name = std::move(name);
     server_session->parent = nullptr;
@@ -84,15 +85,18 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
 
     // If this ServerSession has an associated HLE handler, forward the request to it.
     if (hle_handler != nullptr) {
-        std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buf;
         auto current_process = thread->owner_process.lock();
         ASSERT(current_process);
-        kernel.memory.ReadBlock(*current_process, thread->GetCommandBufferAddress(), cmd_buf.data(),
-                                cmd_buf.size() * sizeof(u32));
 
-        auto context =
-            std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread);
-        context->PopulateFromIncomingCommandBuffer(cmd_buf.data(), current_process);
+        // Reuse the context of the previous request unless something still holds on to it
+        std::shared_ptr<Kernel::HLERequestContext> context;
+        if (hle_context != nullptr && hle_context.use_count() == 1) {
+            context = std::move(hle_context);
+            context->Reset(SharedFrom(this), thread);
+        } else {
+            context = std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread);
+        }
+        context->PopulateFromThreadCommandBuffer(current_process);
 
         hle_handler->HandleSyncRequest(*context);
 
@@ -102,9 +106,14 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         // put the thread to sleep then the writing of the command buffer will be deferred to the
         // wakeup callback.
         if (thread->status == Kernel::ThreadStatus::Running) {
-            context->WriteToOutgoingCommandBuffer(cmd_buf.data(), *current_process);
-            kernel.memory.WriteBlock(*current_process, thread->GetCommandBufferAddress(),
-                                     cmd_buf.data(), cmd_buf.size() * sizeof(u32));
+            context->WriteToThreadCommandBuffer(*current_process);
+        }
+
+        // Keep the context around for the next request if the handler didn't retain it for a
+        // deferred response. It must not reference this session while cached.
+        if (context.use_count() == 1) {
+            context->Reset(nullptr, nullptr);
+            hle_context = std::move(context);
         }
     }
 
@@ -142,7 +151,7 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
 KernelSystem::SessionPair KernelSystem::CreateSessionPair(const std::string& name,
                                                           std::shared_ptr<ClientPort> port) {
     auto server_session = ServerSession::Create(*this, name + "_Server").Unwrap();
-    auto client_session{std::make_shared<ClientSession>(*this)};
+    auto client_session{MakeSlabObject<ClientSession>(*this)};
     client_session->name = name + "_Client";
 
     std::shared_ptr<Session> parent(new Session);
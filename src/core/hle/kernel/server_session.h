@@ -20,6 +20,7 @@ namespace Kernel {
 
 class ClientSession;
 class ClientPort;
+class HLERequestContext;
 class ServerSession;
 class Session;
 class SessionRequestHandler;
@@ -92,6 +93,10 @@ public:
     /// A temporary list holding mapped buffer info from IPC request, used for during IPC reply
     std::vector<MappedBufferContext> mapped_buffer_context;
 
+    /// Context of the last HLE request, recycled for the next one to avoid an allocation per
+    /// request. This is only a cache and is not serialized.
+    std::shared_ptr<HLERequestContext> hle_context;
+
 private:
     /**
      * Creates a server session. The server session can have an optional HLE handler,
@@ -0,0 +1,144 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "core/hle/kernel/slab_heap.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Number of slots allocated at once when a heap runs out of free slots
+constexpr std::size_t SLOTS_PER_CHUNK = 64;
+
+constexpr std::size_t NUM_HANDLE_TYPES = static_cast<std::size_t>(HandleType::ServerSession) + 1;
+
+std::mutex heaps_mutex;
+std::array<SlabHeap*, NUM_HANDLE_TYPES> heaps{};
+
+const char* GetHandleTypeName(HandleType type) {
+    switch (type) {
+    case HandleType::Event:
+        return "Event";
+    case HandleType::Mutex:
+        return "Mutex";
+    case HandleType::SharedMemory:
+        return "SharedMemory";
+    case HandleType::Thread:
+        return "Thread";
+    case HandleType::Process:
+        return "Process";
+    case HandleType::AddressArbiter:
+        return "AddressArbiter";
+    case HandleType::Semaphore:
+        return "Semaphore";
+    case HandleType::Timer:
+        return "Timer";
+    case HandleType::ResourceLimit:
+        return "ResourceLimit";
+    case HandleType::CodeSet:
+        return "CodeSet";
+    case HandleType::ClientPort:
+        return "ClientPort";
+    case HandleType::ServerPort:
+        return "ServerPort";
+    case HandleType::ClientSession:
+        return "ClientSession";
+    case HandleType::ServerSession:
+        return "ServerSession";
+    case HandleType::Unknown:
+        break;
+    }
+    return "Unknown";
+}
+
+} // Anonymous namespace
+
+SlabHeap::SlabHeap(HandleType type, std::size_t slot_size)
+    : type(type), slot_size(std::max(slot_size, sizeof(FreeSlot))) {}
+
+void* SlabHeap::Allocate() {
+    std::scoped_lock lock{mutex};
+    if (free_list == nullptr) {
+        Grow();
+    }
+
+    FreeSlot* slot = free_list;
+    free_list = slot->next;
+
+    in_use++;
+    peak_in_use = std::max(peak_in_use, in_use);
+    total_allocations++;
+    return slot;
+}
+
+void SlabHeap::Free(void* slot) {
+    std::scoped_lock lock{mutex};
+    ASSERT(in_use > 0);
+
+    auto* free_slot = static_cast<FreeSlot*>(slot);
+    free_slot->next = free_list;
+    free_list = free_slot;
+    in_use--;
+}
+
+SlabHeapStats SlabHeap::GetStats() const {
+    std::scoped_lock lock{mutex};
+    return {
+        .type = type,
+        .name = GetHandleTypeName(type),
+        .slot_size = slot_size,
+        .capacity = capacity,
+        .in_use = in_use,
+        .peak_in_use = peak_in_use,
+        .total_allocations = total_allocations,
+    };
+}
+
+void SlabHeap::Grow() {
+    // Memory from new[] is suitably aligned for any fundamental type, and slot_size is a multiple
+    // of the alignment of the slot type, so every slot of the chunk is aligned as well.
+    auto& chunk = chunks.emplace_back(new u8[slot_size * SLOTS_PER_CHUNK]);
+
+    // Link the slots in address order, so that consecutive allocations are adjacent
+    for (std::size_t i = SLOTS_PER_CHUNK; i-- > 0;) {
+        auto* slot = reinterpret_cast<FreeSlot*>(chunk.get() + i * slot_size);
+        slot->next = free_list;
+        free_list = slot;
+    }
+    capacity += SLOTS_PER_CHUNK;
+}
+
+SlabHeap& SlabHeap::Get(HandleType type, std::size_t slot_size, std::size_t alignment) {
+    ASSERT(alignment <= alignof(std::max_align_t));
+    slot_size = Common::AlignUp(slot_size, alignment);
+
+    std::scoped_lock lock{heaps_mutex};
+    SlabHeap*& heap = heaps[static_cast<std::size_t>(type)];
+    if (heap == nullptr) {
+        // Intentionally leaked, see the declaration
+        heap = new SlabHeap(type, slot_size);
+    }
+    ASSERT_MSG(heap->slot_size >= slot_size, "Slab heap of {} used with different slot sizes",
+               GetHandleTypeName(type));
+    return *heap;
+}
+
+std::vector<SlabHeapStats> GetSlabHeapStats() {
+    std::vector<SlabHeapStats> stats;
+
+    std::scoped_lock lock{heaps_mutex};
+    for (const SlabHeap* heap : heaps) {
+        if (heap != nullptr) {
+            stats.push_back(heap->GetStats());
+        }
+    }
+    return stats;
+}
+
+} // namespace Kernel
@@ -0,0 +1,125 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/kernel/object.h"
+
+namespace Kernel {
+
+/// Allocation statistics of the slab heap of a kernel object type.
+struct SlabHeapStats {
+    HandleType type;
+    const char* name;
+    std::size_t slot_size;   ///< Size of a slot, including the shared_ptr control block
+    std::size_t capacity;    ///< Number of slots allocated from the system heap
+    std::size_t in_use;      ///< Number of slots currently holding an object
+    std::size_t peak_in_use; ///< Highest number of slots that held an object at once
+    u64 total_allocations;   ///< Number of objects created since the heap was created
+};
+
+/**
+ * Fixed size allocator for the objects of a kernel object type. Slots are carved from chunks of
+ * the system heap and recycled through a free list, so creating and destroying objects doesn't
+ * reach the general purpose allocator once the heap has grown to the working set of the game.
+ */
+class SlabHeap : NonCopyable {
+public:
+    SlabHeap(HandleType type, std::size_t slot_size);
+
+    /// Returns a slot of slot_size bytes, growing the heap if no slot is free.
+    void* Allocate();
+
+    /// Returns a slot obtained from Allocate to the free list.
+    void Free(void* slot);
+
+    SlabHeapStats GetStats() const;
+
+    /**
+     * Returns the heap of a kernel object type, creating it on first use. Heaps are never
+     * destroyed, as objects may be released after the kernel, or during static destruction.
+     */
+    static SlabHeap& Get(HandleType type, std::size_t slot_size, std::size_t alignment);
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    void Grow();
+
+    const HandleType type;
+    const std::size_t slot_size;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<u8[]>> chunks;
+    FreeSlot* free_list = nullptr;
+    std::size_t capacity = 0;
+    std::size_t in_use = 0;
+    std::size_t peak_in_use = 0;
+    u64 total_allocations = 0;
+};
+
+/**
+ * Standard allocator that serves single element allocations from the slab heap of a kernel
+ * object type. Used with std::allocate_shared, the object and its control block share a slot.
+ */
+template <typename T, HandleType Type>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = SlabAllocator<U, Type>;
+    };
+
+    SlabAllocator() = default;
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U, Type>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n != 1) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        return static_cast<T*>(Heap().Allocate());
+    }
+
+    void deallocate(T* ptr, std::size_t n) {
+        if (n != 1) {
+            return std::allocator<T>{}.deallocate(ptr, n);
+        }
+        Heap().Free(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U, Type>&) const noexcept {
+        return true;
+    }
+
+private:
+    static SlabHeap& Heap() {
+        static SlabHeap& heap = SlabHeap::Get(Type, sizeof(T), alignof(T));
+        return heap;
+    }
+};
+
+/// Creates a kernel object in the slab heap of its type.
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeSlabObject(Args&&... args) {
+    return std::allocate_shared<T>(SlabAllocator<T, T::HANDLE_TYPE>{},
+                                   std::forward<Args>(args)...);
+}
+
+/// Returns the statistics of every slab heap created so far. For debugging purposes.
+std::vector<SlabHeapStats> GetSlabHeapStats();
+
+} // namespace Kernel
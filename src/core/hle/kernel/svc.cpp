@@ -11,6 +11,7 @@
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
 #include "core/arm/arm_interface.h"
+#include "core/call_stats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/address_arbiter.h"
@@ -1691,6 +1692,7 @@ void SVC::CallSVC(u32 immediate) {
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
     if (info) {
         if (info->func) {
+            Core::SVCCallScope call_scope{immediate, info->name};
             (this->*(info->func))();
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
@@ -22,6 +22,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/slab_heap.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -344,7 +345,7 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(
                           ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
     }
 
-    auto thread{std::make_shared<Thread>(*this, processor_id)};
+    auto thread{MakeSlabObject<Thread>(*this, processor_id)};
 
     thread_managers[processor_id]->thread_list.push_back(thread);
     thread_managers[processor_id]->ready_queue.prepare(priority);
@@ -421,6 +422,11 @@ void Thread::SetPriority(u32 priority) {
         thread_manager.ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
+
+    // Keep the waiting lists of the objects this thread waits on in priority order
+    for (auto& object : wait_objects) {
+        object->UpdateWaitingThreadPriority(this);
+    }
 }
 
 void Thread::UpdatePriority() {
@@ -439,6 +445,10 @@ void Thread::BoostPriority(u32 priority) {
     else
         thread_manager.ready_queue.prepare(priority);
     current_priority = priority;
+
+    for (auto& object : wait_objects) {
+        object->UpdateWaitingThreadPriority(this);
+    }
 }
 
 std::shared_ptr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority,
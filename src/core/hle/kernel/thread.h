@@ -147,7 +147,7 @@ private:
     ARM_Interface* cpu;
 
     std::shared_ptr<Thread> current_thread;
-    Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
+    Common::ThreadQueueList<Thread, ThreadPrioLowest + 1> ready_queue;
     std::unordered_map<u64, Thread*> wakeup_callback_table;
 
     /// Event type for the thread wake up event
@@ -169,7 +169,7 @@ private:
     }
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public Common::ThreadQueueListNode<Thread> {
 public:
     explicit Thread(KernelSystem&, u32 core_id);
     ~Thread() override;
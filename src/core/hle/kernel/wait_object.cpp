@@ -26,10 +26,23 @@ void WaitObject::serialize(Archive& ar, const unsigned int file_version) {
 }
 SERIALIZE_IMPL(WaitObject)
 
+/// Returns the position in a waiting list sorted by priority at which a thread of the given
+/// priority has to be inserted, after the threads that have the same priority.
+static auto FindWaitingPosition(std::vector<std::shared_ptr<Thread>>& waiting_threads,
+                                u32 priority) {
+    return std::upper_bound(waiting_threads.begin(), waiting_threads.end(), priority,
+                            [](u32 value, const std::shared_ptr<Thread>& waiter) {
+                                return value < waiter->current_priority;
+                            });
+}
+
 void WaitObject::AddWaitingThread(std::shared_ptr<Thread> thread) {
     auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    if (itr != waiting_threads.end())
+        return;
+
+    const auto position = FindWaitingPosition(waiting_threads, thread->current_priority);
+    waiting_threads.insert(position, std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
@@ -43,9 +56,7 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
 }
 
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = ThreadPrioLowest + 1;
-
+    // The waiting list is sorted by priority, so the first ready thread is the candidate
     for (const auto& thread : waiting_threads) {
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
@@ -53,9 +64,6 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
                        thread->status == ThreadStatus::WaitHleEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
             continue;
 
@@ -70,12 +78,30 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
         }
 
         if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
+            return thread;
         }
     }
 
-    return SharedFrom(candidate);
+    return nullptr;
+}
+
+void WaitObject::UpdateWaitingThreadPriority(Thread* thread) {
+    auto itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
+                            [thread](const auto& p) { return p.get() == thread; });
+    if (itr == waiting_threads.end())
+        return;
+
+    std::shared_ptr<Thread> waiter = std::move(*itr);
+    waiting_threads.erase(itr);
+    const auto position = FindWaitingPosition(waiting_threads, waiter->current_priority);
+    waiting_threads.insert(position, std::move(waiter));
+}
+
+void WaitObject::SortWaitingThreads() {
+    std::stable_sort(waiting_threads.begin(), waiting_threads.end(),
+                     [](const std::shared_ptr<Thread>& a, const std::shared_ptr<Thread>& b) {
+                         return a->current_priority < b->current_priority;
+                     });
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
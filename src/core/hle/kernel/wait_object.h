@@ -53,6 +53,16 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     std::shared_ptr<Thread> GetHighestPriorityReadyThread() const;
 
+    /**
+     * Moves a waiting thread to the position matching its current priority in the waiting list.
+     * Must be called whenever the priority of a waiting thread changes.
+     * @param thread Pointer to the thread whose priority changed
+     */
+    void UpdateWaitingThreadPriority(Thread* thread);
+
+    /// Sorts the waiting list by priority, for lists restored from savestates in any order.
+    void SortWaitingThreads();
+
     /// Get a const reference to the waiting threads list for debug use
     const std::vector<std::shared_ptr<Thread>>& GetWaitingThreads() const;
 
@@ -60,7 +70,8 @@ public:
     void SetHLENotifier(std::function<void()> callback);
 
 private:
-    /// Threads waiting for this object to become available
+    /// Threads waiting for this object to become available, sorted by priority. Threads with the
+    /// same priority are kept in the order they started waiting.
     std::vector<std::shared_ptr<Thread>> waiting_threads;
 
     /// Function to call when this object becomes available
@@ -14,7 +14,11 @@ static std::weak_ptr<GSP_GPU> gsp_gpu;
 
 void SignalInterrupt(InterruptId interrupt_id) {
     auto gpu = gsp_gpu.lock();
-    ASSERT(gpu != nullptr);
+    if (gpu == nullptr) {
+        // There is no GSP module when GPU command streams are replayed outside of an emulation
+        // session, so there is no one to signal
+        return;
+    }
     return gpu->SignalInterrupt(interrupt_id);
 }
 
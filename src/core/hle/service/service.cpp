@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/call_stats.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
@@ -124,7 +126,9 @@ ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_ses
                                            InvokerFn* handler_invoker)
     : service_name(service_name), max_sessions(max_sessions), handler_invoker(handler_invoker) {}
 
-ServiceFrameworkBase::~ServiceFrameworkBase() = default;
+ServiceFrameworkBase::~ServiceFrameworkBase() {
+    Core::GetCallStats().UnregisterService(this);
+}
 
 void ServiceFrameworkBase::InstallAsService(SM::ServiceManager& service_manager) {
     auto port = service_manager.RegisterService(service_name, max_sessions).Unwrap();
@@ -141,7 +145,22 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
     handlers.reserve(handlers.size() + n);
     for (std::size_t i = 0; i < n; ++i) {
         // Usually this array is sorted by id already, so hint to insert at the end
-        handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
+        auto itr =
+            handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
+        itr->second.call_counters = &Core::GetCallStats().RegisterServiceCommand(
+            this, service_name, itr->first, itr->second.name);
+    }
+
+    // Rebuild the table, as inserting into the map invalidates the pointers to its elements
+    handler_table.clear();
+    for (const auto& [header, info] : handlers) {
+        const u32 command_id = header >> 16;
+        if (command_id >= handler_table.size()) {
+            handler_table.resize(command_id + 1, nullptr);
+        }
+        if (handler_table[command_id] == nullptr) {
+            handler_table[command_id] = &info;
+        }
     }
 }
 
@@ -168,8 +187,13 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
 
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
     u32 header_code = context.CommandBuffer()[0];
-    auto itr = handlers.find(header_code);
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    const u32 command_id = header_code >> 16;
+    const FunctionInfoBase* info =
+        command_id < handler_table.size() ? handler_table[command_id] : nullptr;
+    if (info == nullptr || info->expected_header != header_code) {
+        auto itr = handlers.find(header_code);
+        info = itr == handlers.end() ? nullptr : &itr->second;
+    }
     if (info == nullptr || info->handler_callback == nullptr) {
         context.ReportUnimplemented();
         return ReportUnimplementedFunction(context.CommandBuffer(), info);
@@ -177,7 +201,12 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
+
+    const auto begin = std::chrono::steady_clock::now();
     handler_invoker(this, info->handler_callback, context);
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    info->call_counters->Add(
+        static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
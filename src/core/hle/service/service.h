@@ -9,6 +9,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
@@ -19,8 +20,9 @@
 #include "core/hle/service/sm/sm.h"
 
 namespace Core {
+class CallCounters;
 class System;
-}
+} // namespace Core
 
 namespace Kernel {
 class KernelSystem;
@@ -83,6 +85,8 @@ private:
         u32 expected_header;
         HandlerFnP<ServiceFrameworkBase> handler_callback;
         const char* name;
+        /// Counters the calls of the handler are recorded to, set when it is registered
+        Core::CallCounters* call_counters = nullptr;
     };
 
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
@@ -103,6 +107,9 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /// Handlers indexed by the command id of their header, for fast dispatch. Headers sharing a
+    /// command id with another handler are only found through the map.
+    std::vector<const FunctionInfoBase*> handler_table;
 };
 
 /**
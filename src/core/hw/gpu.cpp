@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <numeric>
 #include <type_traits>
@@ -17,9 +19,11 @@
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
@@ -32,6 +36,49 @@ Memory::MemorySystem* g_memory;
 
 /// Event id for CoreTiming
 static Core::TimingEventType* vblank_event;
+static Core::TimingEventType* gpu_thread_sync_event;
+
+/// Emulated time after which the emulation thread waits for work queued on the GPU thread and
+/// signals the interrupts it raised. Larger values allow more overlap between the threads.
+constexpr s64 gpu_thread_sync_ticks = BASE_CLOCK_RATE_ARM11 / 1000;
+
+/// Fence of the last buffer swap queued on the GPU thread
+static u64 last_swap_fence = 0;
+
+/// Signals a GSP interrupt, deferring it to the emulation thread when raised on the GPU thread
+static void SignalGpuInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGpuThread()) {
+        VideoCore::g_gpu_thread->DeferInterrupt(interrupt_id);
+    } else {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
+/// Queues work on the GPU thread and schedules the point at which the emulation thread syncs
+/// with it
+static void QueueGpuThreadWork(VideoCore::CommandData&& command) {
+    const u64 fence = VideoCore::g_gpu_thread->PushCommand(std::move(command));
+    Core::System::GetInstance().CoreTiming().ScheduleEvent(gpu_thread_sync_ticks,
+                                                           gpu_thread_sync_event, fence);
+}
+
+/**
+ * Whether the memory fills and the display transfer queued on the GPU thread are still running.
+ * The registers are only accessed by the emulation thread, reads apply these flags to them.
+ */
+static std::array<std::atomic_bool, 2> memory_fill_running{};
+static std::atomic_bool display_transfer_running{false};
+
+static void GpuThreadSyncCallback(std::uintptr_t fence, s64 cycles_late) {
+    if (!VideoCore::g_gpu_thread) {
+        return;
+    }
+    VideoCore::g_gpu_thread->WaitForFence(fence);
+    // The guest may access the output of the GPU once it sees the interrupts, so the pages of the
+    // rasterizer cache must be marked first
+    g_memory->ApplyQueuedCacheMarks();
+    VideoCore::g_gpu_thread->SignalDeferredInterrupts();
+}
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -44,7 +91,27 @@ inline void Read(T& var, const u32 raw_addr) {
         return;
     }
 
-    var = g_regs[addr / 4];
+    u32 value = g_regs[index];
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+    case GPU_REG_INDEX(memory_fill_config[1].trigger): {
+        // The "finish" flag is only set once the fill is done
+        const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
+        if (memory_fill_running[is_second_filler].load(std::memory_order_acquire)) {
+            value &= ~decltype(Regs::MemoryFillConfig::finished)::mask;
+        }
+        break;
+    }
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+        // The "trigger" flag is only reset once the transfer is done
+        if (display_transfer_running.load(std::memory_order_acquire)) {
+            value |= 1;
+        }
+        break;
+    default:
+        break;
+    }
+    var = value;
 }
 
 static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
@@ -384,6 +451,58 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     }
 }
 
+void ExecuteMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler) {
+    MemoryFill(config);
+    LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
+              config.GetEndAddress());
+
+    // Reads report the "finish" flag, which was already set when the fill was queued
+    // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
+    memory_fill_running[is_second_filler].store(false, std::memory_order_release);
+
+    // It seems that it won't signal interrupt if "address_start" is zero.
+    // TODO: hwtest this
+    if (config.GetStartAddress() != 0) {
+        if (!is_second_filler) {
+            SignalGpuInterrupt(Service::GSP::InterruptId::PSC0);
+        } else {
+            SignalGpuInterrupt(Service::GSP::InterruptId::PSC1);
+        }
+    }
+}
+
+void ExecuteDisplayTransfer(const Regs::DisplayTransferConfig& config) {
+    MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+    if (Pica::g_debug_context)
+        Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
+                                       nullptr);
+
+    if (config.is_texture_copy) {
+        TextureCopy(config);
+        LOG_TRACE(HW_GPU,
+                  "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                  "{:#010X}({}+{}), flags {:#010X}",
+                  config.texture_copy.size, config.GetPhysicalInputAddress(),
+                  config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
+                  config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
+                  config.texture_copy.output_gap * 16, config.flags);
+    } else {
+        DisplayTransfer(config);
+        LOG_TRACE(HW_GPU,
+                  "DisplayTransfer: {:#010X}({}x{})-> "
+                  "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                  config.GetPhysicalInputAddress(), config.input_width.Value(),
+                  config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                  config.output_width.Value(), config.output_height.Value(),
+                  static_cast<u32>(config.output_format.Value()), config.flags);
+    }
+
+    // Reads report the "trigger" flag, which was already reset when the transfer was queued
+    display_transfer_running.store(false, std::memory_order_release);
+    SignalGpuInterrupt(Service::GSP::InterruptId::PPF);
+}
+
 template <typename T>
 inline void Write(u32 addr, const T data) {
     addr -= HW::VADDR_GPU;
@@ -395,7 +514,8 @@ inline void Write(u32 addr, const T data) {
         return;
     }
 
-    g_regs[index] = static_cast<u32>(data);
+    const u32 value = static_cast<u32>(data);
+    g_regs[index] = value;
 
     switch (index) {
 
@@ -403,63 +523,36 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(memory_fill_config[0].trigger):
     case GPU_REG_INDEX(memory_fill_config[1].trigger): {
         const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
-        auto& config = g_regs.memory_fill_config[is_second_filler];
-
-        if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
+        using MemoryFillConfig = Regs::MemoryFillConfig;
+
+        if (value & decltype(MemoryFillConfig::trigger)::mask) {
+            const MemoryFillConfig config = g_regs.memory_fill_config[is_second_filler];
+
+            // Reset the "trigger" flag and set the "finish" flag, reads hide the latter until
+            // the fill is done
+            g_regs[index] = (value & ~decltype(MemoryFillConfig::trigger)::mask) |
+                            decltype(MemoryFillConfig::finished)::mask;
+            memory_fill_running[is_second_filler].store(true, std::memory_order_relaxed);
+            if (VideoCore::g_gpu_thread) {
+                QueueGpuThreadWork(VideoCore::MemoryFillCommand{config, is_second_filler});
+            } else {
+                ExecuteMemoryFill(config, is_second_filler);
             }
-
-            // Reset "trigger" flag and set the "finish" flag
-            // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
-            config.trigger.Assign(0);
-            config.finished.Assign(1);
         }
         break;
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
-        const auto& config = g_regs.display_transfer_config;
-        if (config.trigger & 1) {
-
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
+        if (value & 1) {
+            // Reset the "trigger" flag, reads keep reporting it until the transfer is done
+            const Regs::DisplayTransferConfig config = g_regs.display_transfer_config;
+            g_regs[index] = value & ~u32{1};
+            display_transfer_running.store(true, std::memory_order_relaxed);
+            if (VideoCore::g_gpu_thread) {
+                QueueGpuThreadWork(VideoCore::DisplayTransferCommand{config});
             } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
+                ExecuteDisplayTransfer(config);
             }
-
-            g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -468,9 +561,15 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+            if (VideoCore::g_gpu_thread) {
+                QueueGpuThreadWork(
+                    VideoCore::SubmitListCommand{config.GetPhysicalAddress(), config.size});
+            } else {
+                MICROPROFILE_FRAME_SCOPE(GPU_CmdlistProcessing, Core::FrameCounter::GpuCommandTime);
 
-            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+                Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(),
+                                                           config.size);
+            }
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -504,7 +603,17 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    if (VideoCore::g_gpu_thread) {
+        // Allow the GPU thread to fall at most one frame behind. Only the presentation runs
+        // there, the frame limiter below paces the emulation thread.
+        VideoCore::g_gpu_thread->WaitForFence(last_swap_fence);
+        g_memory->ApplyQueuedCacheMarks();
+        VideoCore::g_gpu_thread->SignalDeferredInterrupts();
+        last_swap_fence = VideoCore::g_gpu_thread->PushCommand(VideoCore::SwapBuffersCommand{});
+    } else {
+        VideoCore::g_renderer->SwapBuffers();
+    }
+    VideoCore::g_renderer->EndFrame();
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -518,8 +627,7 @@ static void VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late, vblank_event);
 }
 
-/// Initialize hardware
-void Init(Memory::MemorySystem& memory) {
+void InitRegisters(Memory::MemorySystem& memory) {
     g_memory = &memory;
     memset(&g_regs, 0, sizeof(g_regs));
 
@@ -548,9 +656,17 @@ void Init(Memory::MemorySystem& memory) {
     framebuffer_sub.stride = 3 * 240;
     framebuffer_sub.color_format.Assign(Regs::PixelFormat::RGB8);
     framebuffer_sub.active_fb = 0;
+}
+
+/// Initialize hardware
+void Init(Memory::MemorySystem& memory) {
+    InitRegisters(memory);
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    gpu_thread_sync_event =
+        timing.RegisterEvent("GPU::GpuThreadSyncCallback", GpuThreadSyncCallback);
+    last_swap_fence = 0;
     timing.ScheduleEvent(frame_ticks, vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
@@ -322,9 +322,21 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/// Performs a memory fill and signals its completion interrupt
+void ExecuteMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler);
+
+/// Performs a display transfer or texture copy and signals its completion interrupt
+void ExecuteDisplayTransfer(const Regs::DisplayTransferConfig& config);
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
+/**
+ * Sets the registers to their initial values without scheduling the VBlank events. Used on its own
+ * to replay GPU command streams outside of an emulation session.
+ */
+void InitRegisters(Memory::MemorySystem& memory);
+
 /// Shutdown hardware
 void Shutdown();
 
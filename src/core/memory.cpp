@@ -2,8 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
+#include <mutex>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
@@ -12,6 +15,7 @@
 #include "common/atomic_ops.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/ring_buffer.h"
 #include "common/swap.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -21,6 +25,7 @@
 #include "core/hle/lock.h"
 #include "core/memory.h"
 #include "core/settings.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -35,8 +40,23 @@ void PageTable::Clear() {
     pointers.raw.fill(nullptr);
     pointers.refs.fill(MemoryRef());
     attributes.fill(PageType::Unmapped);
+    watch_ranges.clear();
 }
 
+/// Watch range to add to or remove from a page table, see MemorySystem::QueueWatchChange
+struct QueuedWatchChange {
+    std::weak_ptr<PageTable> page_table;
+    WatchRange range;
+    bool add;
+};
+
+/// Pages marked by the rasterizer on the GPU thread, see MemorySystem::RasterizerMarkRegionCached
+struct QueuedCacheMark {
+    PAddr start;
+    u32 size;
+    bool cached;
+};
+
 class RasterizerCacheMarker {
 public:
     void Mark(VAddr addr, bool cached) {
@@ -99,6 +119,20 @@ public:
     std::shared_ptr<BackingMem> n3ds_extra_ram_mem;
     std::shared_ptr<BackingMem> dsp_mem;
 
+    /// Watch changes requested by host threads, applied by the emulation thread between slices
+    std::mutex queued_watch_changes_mutex;
+    std::vector<QueuedWatchChange> queued_watch_changes;
+    std::atomic_bool has_queued_watch_changes = false;
+    /// Cache marks of the GPU thread, applied by the emulation thread when it syncs with it
+    std::mutex queued_cache_marks_mutex;
+    std::vector<QueuedCacheMark> queued_cache_marks;
+    std::atomic_bool has_queued_cache_marks = false;
+    /// Accesses to the watch ranges, pushed by the emulation thread only
+    Common::RingBuffer<MemoryWatchHit, WATCH_HIT_BUFFER_SIZE> watch_hits;
+    /// Serializes the consumers of watch_hits
+    std::mutex watch_hits_pop_mutex;
+    std::atomic<u64> dropped_watch_hits = 0;
+
     Impl();
 
     const u8* GetPtr(Region r) const {
@@ -197,6 +231,13 @@ public:
                 handler->ReadBlock(current_vaddr, dest_buffer, copy_amount);
                 break;
             }
+            case PageType::Watched:
+                // Only the accesses by the CPU are recorded
+                if (const u8* src_ptr = page_table.pointers.GetRef(page_index).GetPtr()) {
+                    std::memcpy(dest_buffer, src_ptr + page_offset, copy_amount);
+                    break;
+                }
+                [[fallthrough]];
             case PageType::RasterizerCachedMemory: {
                 if constexpr (!UNSAFE) {
                     RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
@@ -251,6 +292,13 @@ public:
                 handler->WriteBlock(current_vaddr, src_buffer, copy_amount);
                 break;
             }
+            case PageType::Watched:
+                // Only the accesses by the CPU are recorded
+                if (u8* dest_ptr = page_table.pointers.GetRef(page_index).GetPtr()) {
+                    std::memcpy(dest_ptr + page_offset, src_buffer, copy_amount);
+                    break;
+                }
+                [[fallthrough]];
             case PageType::RasterizerCachedMemory: {
                 if constexpr (!UNSAFE) {
                     RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
@@ -285,6 +333,53 @@ public:
         return MemoryRef{};
     }
 
+    /**
+     * Returns a pointer to the given address of a page with attribute `PageType::Watched`. If the
+     * memory backing the page is rasterizer-cached, the region is flushed with the given mode.
+     */
+    u8* GetWatchedPointer(PageTable& page_table, VAddr vaddr, u32 size, FlushMode mode) {
+        if (u8* page_pointer = page_table.pointers.GetRef(vaddr >> CITRA_PAGE_BITS).GetPtr()) {
+            return page_pointer + (vaddr & CITRA_PAGE_MASK);
+        }
+        RasterizerFlushVirtualRegion(vaddr, size, mode);
+        return GetPointerForRasterizerCache(vaddr).GetPtr();
+    }
+
+    /**
+     * Records an access to a watched page of the current page table if it is in a watch range.
+     * The watch ranges are only changed by the emulation thread, so they are read without a lock.
+     */
+    void RecordWatchHit(VAddr vaddr, u32 size, u64 value, bool write) {
+        const auto& ranges = current_page_table->watch_ranges;
+        const bool watched =
+            std::any_of(ranges.begin(), ranges.end(), [&](const WatchRange& range) {
+                return (write ? range.write : range.read) &&
+                       vaddr < u64{range.start} + range.size && range.start < u64{vaddr} + size;
+            });
+        if (!watched) {
+            return;
+        }
+
+        MemoryWatchHit hit{
+            .tick = 0,
+            .value = value,
+            .pc = 0,
+            .address = vaddr,
+            .size = size,
+            .write = write,
+        };
+        // Accesses made without a running CPU, e.g. by tests, have no tick or PC
+        auto& system = Core::System::GetInstance();
+        if (system.IsPoweredOn()) {
+            ARM_Interface& core = system.GetRunningCore();
+            hit.tick = core.GetTimer().GetTicks();
+            hit.pc = core.GetPC();
+        }
+        if (watch_hits.Push(&hit, 1) == 0) {
+            dropped_watch_hits++;
+        }
+    }
+
 private:
     friend class boost::serialization::access;
     template <class Archive>
@@ -363,6 +458,8 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
     LOG_DEBUG(HW_Memory, "Mapping {} onto {:08X}-{:08X}", (void*)memory.GetPtr(),
               base * CITRA_PAGE_SIZE, (base + size) * CITRA_PAGE_SIZE);
 
+    const u32 first_page = base;
+
     RasterizerFlushVirtualRegion(base << CITRA_PAGE_BITS, size * CITRA_PAGE_SIZE,
                                  FlushMode::FlushAndInvalidate);
 
@@ -383,6 +480,9 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
         if (memory != nullptr && memory.GetSize() > CITRA_PAGE_SIZE)
             memory += CITRA_PAGE_SIZE;
     }
+
+    // The new mapping of a watched range is watched as well
+    UpdateWatchedPages(page_table, first_page, size);
 }
 
 void MemorySystem::MapMemoryRegion(PageTable& page_table, VAddr base, u32 size, MemoryRef target) {
@@ -454,6 +554,15 @@ T MemorySystem::Read(const VAddr vaddr) {
     }
     case PageType::Special:
         return ReadMMIO<T>(impl->GetMMIOHandler(*impl->current_page_table, vaddr), vaddr);
+    case PageType::Watched: {
+        T value;
+        std::memcpy(&value,
+                    impl->GetWatchedPointer(*impl->current_page_table, vaddr, sizeof(T),
+                                            FlushMode::Flush),
+                    sizeof(T));
+        impl->RecordWatchHit(vaddr, sizeof(T), value, false);
+        return value;
+    }
     default:
         UNREACHABLE();
     }
@@ -490,6 +599,12 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
     case PageType::Special:
         WriteMMIO<T>(impl->GetMMIOHandler(*impl->current_page_table, vaddr), vaddr, data);
         break;
+    case PageType::Watched:
+        std::memcpy(impl->GetWatchedPointer(*impl->current_page_table, vaddr, sizeof(T),
+                                            FlushMode::Invalidate),
+                    &data, sizeof(T));
+        impl->RecordWatchHit(vaddr, sizeof(T), data, true);
+        break;
     default:
         UNREACHABLE();
     }
@@ -523,6 +638,15 @@ bool MemorySystem::WriteExclusive(const VAddr vaddr, const T data, const T expec
     case PageType::Special:
         WriteMMIO<T>(impl->GetMMIOHandler(*impl->current_page_table, vaddr), vaddr, data);
         return false;
+    case PageType::Watched: {
+        const auto volatile_pointer = reinterpret_cast<volatile T*>(impl->GetWatchedPointer(
+            *impl->current_page_table, vaddr, sizeof(T), FlushMode::Invalidate));
+        const bool stored = Common::AtomicCompareAndSwap(volatile_pointer, data, expected);
+        if (stored) {
+            impl->RecordWatchHit(vaddr, sizeof(T), data, true);
+        }
+        return stored;
+    }
     default:
         UNREACHABLE();
     }
@@ -536,7 +660,8 @@ bool MemorySystem::IsValidVirtualAddress(const Kernel::Process& process, const V
     if (page_pointer)
         return true;
 
-    if (page_table.attributes[vaddr >> CITRA_PAGE_BITS] == PageType::RasterizerCachedMemory)
+    if (page_table.attributes[vaddr >> CITRA_PAGE_BITS] == PageType::RasterizerCachedMemory ||
+        page_table.attributes[vaddr >> CITRA_PAGE_BITS] == PageType::Watched)
         return true;
 
     if (page_table.attributes[vaddr >> CITRA_PAGE_BITS] != PageType::Special)
@@ -565,6 +690,11 @@ u8* MemorySystem::GetPointer(const VAddr vaddr) {
         return GetPointerForRasterizerCache(vaddr);
     }
 
+    if (impl->current_page_table->attributes[vaddr >> CITRA_PAGE_BITS] == PageType::Watched) {
+        return impl->GetWatchedPointer(*impl->current_page_table, vaddr, 1,
+                                       FlushMode::FlushAndInvalidate);
+    }
+
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x{:08x} at PC 0x{:08X}", vaddr,
               Core::GetRunningCore().GetPC());
     return nullptr;
@@ -581,6 +711,11 @@ const u8* MemorySystem::GetPointer(const VAddr vaddr) const {
         return GetPointerForRasterizerCache(vaddr);
     }
 
+    if (impl->current_page_table->attributes[vaddr >> CITRA_PAGE_BITS] == PageType::Watched) {
+        return impl->GetWatchedPointer(*impl->current_page_table, vaddr, 1,
+                                       FlushMode::FlushAndInvalidate);
+    }
+
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x{:08x}", vaddr);
     return nullptr;
 }
@@ -678,6 +813,15 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    // The page tables are only modified by the emulation thread, which runs concurrently with the
+    // GPU thread. The marks are applied in order when it next waits for the GPU thread.
+    if (VideoCore::g_gpu_thread && VideoCore::g_gpu_thread->IsGpuThread()) {
+        std::scoped_lock lock{impl->queued_cache_marks_mutex};
+        impl->queued_cache_marks.push_back({start, size, cached});
+        impl->has_queued_cache_marks = true;
+        return;
+    }
+
     u32 num_pages = ((start + size - 1) >> CITRA_PAGE_BITS) - (start >> CITRA_PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -698,6 +842,10 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> CITRA_PAGE_BITS] = nullptr;
                         break;
+                    case PageType::Watched:
+                        // The page stays watched, without a reference to its memory
+                        page_table->pointers[vaddr >> CITRA_PAGE_BITS] = nullptr;
+                        break;
                     default:
                         UNREACHABLE();
                     }
@@ -714,6 +862,13 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                             GetPointerForRasterizerCache(vaddr & ~CITRA_PAGE_MASK);
                         break;
                     }
+                    case PageType::Watched: {
+                        // The page stays watched, with a reference to its memory
+                        page_table->pointers[vaddr >> CITRA_PAGE_BITS] =
+                            GetPointerForRasterizerCache(vaddr & ~CITRA_PAGE_MASK);
+                        page_table->pointers.Hide(vaddr >> CITRA_PAGE_BITS);
+                        break;
+                    }
                     default:
                         UNREACHABLE();
                     }
@@ -723,11 +878,42 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     }
 }
 
+void MemorySystem::ApplyQueuedCacheMarks() {
+    if (!impl->has_queued_cache_marks.exchange(false)) {
+        return;
+    }
+
+    std::vector<QueuedCacheMark> marks;
+    {
+        std::scoped_lock lock{impl->queued_cache_marks_mutex};
+        marks.swap(impl->queued_cache_marks);
+    }
+    for (const QueuedCacheMark& mark : marks) {
+        RasterizerMarkRegionCached(mark.start, mark.size, mark.cached);
+    }
+}
+
+/// Returns whether rasterizer accesses from the calling thread must go through the GPU thread
+static bool UseGpuThread() {
+    return VideoCore::g_gpu_thread && !VideoCore::g_gpu_thread->IsGpuThread();
+}
+
+/// Runs a rasterizer command on the GPU thread and waits for it, along with the pages it marked
+static void PushGpuThreadCommandSync(VideoCore::CommandData&& command) {
+    VideoCore::g_gpu_thread->PushCommandSync(std::move(command));
+    VideoCore::g_memory->ApplyQueuedCacheMarks();
+}
+
 void RasterizerFlushRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer == nullptr) {
         return;
     }
 
+    if (UseGpuThread()) {
+        PushGpuThreadCommandSync(VideoCore::FlushRegionCommand{start, size});
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
 }
 
@@ -736,6 +922,13 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    // Wait for the invalidation, as the caller writes to the region next. Work queued earlier may
+    // still flush surfaces into it, which would overwrite the new data.
+    if (UseGpuThread()) {
+        PushGpuThreadCommandSync(VideoCore::InvalidateRegionCommand{start, size});
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
 }
 
@@ -746,6 +939,11 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    if (UseGpuThread()) {
+        PushGpuThreadCommandSync(VideoCore::FlushAndInvalidateRegionCommand{start, size});
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
 }
 
@@ -756,6 +954,11 @@ void RasterizerClearAll(bool flush) {
         return;
     }
 
+    if (UseGpuThread()) {
+        PushGpuThreadCommandSync(VideoCore::ClearAllCommand{flush});
+        return;
+    }
+
     VideoCore::g_renderer->Rasterizer()->ClearAll(flush);
 }
 
@@ -779,16 +982,15 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         PAddr physical_start = paddr_region_start + (overlap_start - region_start);
         u32 overlap_size = overlap_end - overlap_start;
 
-        auto* rasterizer = VideoCore::g_renderer->Rasterizer();
         switch (mode) {
         case FlushMode::Flush:
-            rasterizer->FlushRegion(physical_start, overlap_size);
+            RasterizerFlushRegion(physical_start, overlap_size);
             break;
         case FlushMode::Invalidate:
-            rasterizer->InvalidateRegion(physical_start, overlap_size);
+            RasterizerInvalidateRegion(physical_start, overlap_size);
             break;
         case FlushMode::FlushAndInvalidate:
-            rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+            RasterizerFlushAndInvalidateRegion(physical_start, overlap_size);
             break;
         }
     };
@@ -902,6 +1104,13 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             handler->WriteBlock(current_vaddr, zeros.data(), copy_amount);
             break;
         }
+        case PageType::Watched:
+            // Only the accesses by the CPU are recorded
+            if (u8* dest_ptr = page_table.pointers.GetRef(page_index).GetPtr()) {
+                std::memset(dest_ptr + page_offset, 0, copy_amount);
+                break;
+            }
+            [[fallthrough]];
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Invalidate);
@@ -959,6 +1168,13 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             WriteBlock(dest_process, dest_addr, buffer.data(), buffer.size());
             break;
         }
+        case PageType::Watched:
+            // Only the accesses by the CPU are recorded
+            if (const u8* src_ptr = page_table.pointers.GetRef(page_index).GetPtr()) {
+                WriteBlock(dest_process, dest_addr, src_ptr + page_offset, copy_amount);
+                break;
+            }
+            [[fallthrough]];
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::Flush);
@@ -1042,4 +1258,114 @@ void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
     impl->dsp = &dsp;
 }
 
+/// Returns the first page and the number of pages covered by a watch range
+static std::pair<u32, u32> GetWatchedPages(const WatchRange& range) {
+    if (range.size == 0) {
+        return {range.start >> CITRA_PAGE_BITS, 0};
+    }
+    const u32 first_page = range.start >> CITRA_PAGE_BITS;
+    const auto last_page = static_cast<u32>((u64{range.start} + range.size - 1) >> CITRA_PAGE_BITS);
+    return {first_page, last_page - first_page + 1};
+}
+
+void MemorySystem::AddWatch(PageTable& page_table, const WatchRange& range) {
+    page_table.watch_ranges.push_back(range);
+    const auto [first_page, num_pages] = GetWatchedPages(range);
+    UpdateWatchedPages(page_table, first_page, num_pages);
+}
+
+void MemorySystem::RemoveWatch(PageTable& page_table, const WatchRange& range) {
+    auto& ranges = page_table.watch_ranges;
+    const auto itr = std::find(ranges.begin(), ranges.end(), range);
+    if (itr == ranges.end()) {
+        return;
+    }
+    ranges.erase(itr);
+    const auto [first_page, num_pages] = GetWatchedPages(range);
+    UpdateWatchedPages(page_table, first_page, num_pages);
+}
+
+void MemorySystem::ClearWatches(PageTable& page_table) {
+    std::vector<WatchRange> ranges;
+    ranges.swap(page_table.watch_ranges);
+    for (const WatchRange& range : ranges) {
+        const auto [first_page, num_pages] = GetWatchedPages(range);
+        UpdateWatchedPages(page_table, first_page, num_pages);
+    }
+}
+
+void MemorySystem::QueueWatchChange(std::shared_ptr<PageTable> page_table,
+                                    const WatchRange& range, bool add) {
+    std::scoped_lock lock{impl->queued_watch_changes_mutex};
+    impl->queued_watch_changes.push_back({std::move(page_table), range, add});
+    impl->has_queued_watch_changes = true;
+}
+
+void MemorySystem::ApplyQueuedWatchChanges() {
+    if (!impl->has_queued_watch_changes.exchange(false)) {
+        return;
+    }
+
+    std::vector<QueuedWatchChange> changes;
+    {
+        std::scoped_lock lock{impl->queued_watch_changes_mutex};
+        changes.swap(impl->queued_watch_changes);
+    }
+    for (const QueuedWatchChange& change : changes) {
+        // The process may have exited since the change was queued
+        const auto page_table = change.page_table.lock();
+        if (!page_table) {
+            continue;
+        }
+        if (change.add) {
+            AddWatch(*page_table, change.range);
+        } else {
+            RemoveWatch(*page_table, change.range);
+        }
+    }
+}
+
+void MemorySystem::UpdateWatchedPages(PageTable& page_table, u32 base, u32 size) {
+    const auto& ranges = page_table.watch_ranges;
+    const bool has_ranges = !ranges.empty();
+    for (u32 page = base; page != base + size; ++page) {
+        PageType& type = page_table.attributes[page];
+        if (!has_ranges && type != PageType::Watched) {
+            continue;
+        }
+
+        const u64 page_start = u64{page} << CITRA_PAGE_BITS;
+        const bool watched =
+            std::any_of(ranges.begin(), ranges.end(), [page_start](const WatchRange& range) {
+                return range.size != 0 && page_start < u64{range.start} + range.size &&
+                       range.start < page_start + CITRA_PAGE_SIZE;
+            });
+
+        // A null pointer must never be seen with the attribute `Memory`, so the attribute is set
+        // before the pointer is hidden, and the pointer is restored before the attribute
+        if (watched && (type == PageType::Memory || type == PageType::RasterizerCachedMemory)) {
+            type = PageType::Watched;
+            page_table.pointers.Hide(page);
+        } else if (!watched && type == PageType::Watched) {
+            // Rasterizer-cached pages have no reference to their memory
+            MemoryRef& memory = page_table.pointers.GetRef(page);
+            if (memory) {
+                page_table.pointers[page] = memory;
+                type = PageType::Memory;
+            } else {
+                type = PageType::RasterizerCachedMemory;
+            }
+        }
+    }
+}
+
+std::vector<MemoryWatchHit> MemorySystem::PopWatchHits(std::size_t max_count) {
+    std::scoped_lock lock{impl->watch_hits_pop_mutex};
+    return impl->watch_hits.Pop(max_count);
+}
+
+u64 MemorySystem::GetDroppedWatchHits() const {
+    return impl->dropped_watch_hits.load();
+}
+
 } // namespace Memory
@@ -8,6 +8,7 @@
 #include <string>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
 #include "core/mmio.h"
@@ -43,6 +44,10 @@ enum class PageType {
     RasterizerCachedMemory,
     /// Page is mapped to a I/O region. Writing and reading to this page is handled by functions.
     Special,
+    /// Page is mapped to regular or rasterizer-cached memory that is covered by a watch range.
+    /// The reference to the memory backing the page is kept, but its pointer is null so that the
+    /// accesses to the page go through the slow path where they are recorded.
+    Watched,
 };
 
 struct SpecialRegion {
@@ -60,6 +65,39 @@ private:
     friend class boost::serialization::access;
 };
 
+/// Range of virtual addresses whose accesses by the CPU are recorded.
+struct WatchRange {
+    VAddr start;
+    u32 size;
+    bool read;
+    bool write;
+
+    bool operator==(const WatchRange&) const = default;
+
+private:
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int file_version) {
+        ar& start;
+        ar& size;
+        ar& read;
+        ar& write;
+    }
+    friend class boost::serialization::access;
+};
+
+/// Number of watch hits that can be recorded before they are drained
+constexpr std::size_t WATCH_HIT_BUFFER_SIZE = 0x4000;
+
+/// Access by the CPU to a watch range.
+struct MemoryWatchHit {
+    u64 tick;  ///< Ticks of the core that made the access
+    u64 value; ///< Value read or written, zero-extended
+    u32 pc;
+    VAddr address;
+    u32 size; ///< Size of the access in bytes
+    bool write;
+};
+
 /**
  * A (reasonably) fast way of allowing switchable and remappable process address spaces. It loosely
  * mimics the way a real CPU page table works, but instead is optimized for minimal decoding and
@@ -98,6 +136,16 @@ struct PageTable {
             return Entry(*this, static_cast<VAddr>(idx));
         }
 
+        /// Clears the pointer of a page but keeps the reference to the memory backing it.
+        void Hide(std::size_t idx) {
+            raw[idx] = nullptr;
+        }
+
+        /// Returns the reference to the memory backing a page, even if its pointer is hidden.
+        MemoryRef& GetRef(std::size_t idx) {
+            return refs[idx];
+        }
+
     private:
         std::array<u8*, PAGE_TABLE_NUM_ENTRIES> raw;
         std::array<MemoryRef, PAGE_TABLE_NUM_ENTRIES> refs;
@@ -118,6 +166,12 @@ struct PageTable {
      */
     std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
 
+    /**
+     * Ranges whose accesses by the CPU are recorded. The pages they cover that are backed by
+     * memory have the attribute `Watched`.
+     */
+    std::vector<WatchRange> watch_ranges;
+
     std::array<u8*, PAGE_TABLE_NUM_ENTRIES>& GetPointerArray() {
         return pointers.raw;
     }
@@ -126,12 +180,17 @@ struct PageTable {
 
 private:
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
         ar& pointers.refs;
         ar& special_regions;
         ar& attributes;
+        if (file_version > 0) {
+            ar& watch_ranges;
+        }
         for (std::size_t i = 0; i < PAGE_TABLE_NUM_ENTRIES; i++) {
-            pointers.raw[i] = pointers.refs[i].GetPtr();
+            // Watched pages keep their pointer hidden
+            pointers.raw[i] =
+                attributes[i] == PageType::Watched ? nullptr : pointers.refs[i].GetPtr();
         }
     }
     friend class boost::serialization::access;
@@ -567,9 +626,14 @@ public:
      * @param size   The size of the address range in bytes.
      * @param cached Whether or not any pages within the address range should be
      *               marked as cached or uncached.
+     *
+     * On the GPU thread, the pages are queued and marked by ApplyQueuedCacheMarks instead.
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /// Marks the pages queued by the GPU thread. Called by the emulation thread when it syncs.
+    void ApplyQueuedCacheMarks();
+
     /// Gets a pointer to the memory region beginning at the specified physical address.
     u8* GetPhysicalPointer(PAddr address);
 
@@ -602,6 +666,40 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /**
+     * Starts recording the CPU accesses to a range of an address space. Only the pages covered by
+     * the range go through the slow path of the accessors. Must be called on the emulation thread.
+     *
+     * @param page_table The page table of the emulated process.
+     * @param range      The range to watch, and whether its reads and/or writes are recorded.
+     */
+    void AddWatch(PageTable& page_table, const WatchRange& range);
+
+    /// Stops recording the accesses to a range that was added with the same parameters.
+    void RemoveWatch(PageTable& page_table, const WatchRange& range);
+
+    /// Stops recording the accesses to every watch range of an address space.
+    void ClearWatches(PageTable& page_table);
+
+    /**
+     * Queues adding or removing a watch range from a host thread. The change is applied by
+     * ApplyQueuedWatchChanges, so that the page table is only modified by the emulation thread.
+     */
+    void QueueWatchChange(std::shared_ptr<PageTable> page_table, const WatchRange& range,
+                          bool add);
+
+    /// Applies the queued watch changes. Called by the emulation thread between slices.
+    void ApplyQueuedWatchChanges();
+
+    /**
+     * Removes up to max_count of the oldest recorded watch hits. Hits are recorded into a
+     * lock-free ring buffer by the emulation thread, and are dropped when it is full.
+     */
+    std::vector<MemoryWatchHit> PopWatchHits(std::size_t max_count);
+
+    /// Returns the number of watch hits that were dropped because the ring buffer was full.
+    u64 GetDroppedWatchHits() const;
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -622,6 +720,10 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory, PageType type);
 
+    /// Sets or clears the attribute `Watched` of the pages in [base, base + size) according to
+    /// the watch ranges of the page table
+    void UpdateWatchedPages(PageTable& page_table, u32 base, u32 size);
+
     class Impl;
     std::unique_ptr<Impl> impl;
 
@@ -636,6 +738,7 @@ public:
 
 } // namespace Memory
 
+BOOST_CLASS_VERSION(Memory::PageTable, 1)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::FCRAM>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::VRAM>)
 BOOST_CLASS_EXPORT_KEY(Memory::MemorySystem::BackingMemImpl<Memory::Region::DSP>)
@@ -11,7 +11,12 @@
 #include <thread>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
+#include "audio_core/dsp_interface.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/ring_buffer.h"
+#include "core/call_stats.h"
+#include "core/core.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
 #include "core/settings.h"
@@ -27,9 +32,145 @@ constexpr std::size_t IgnoreFrames = 5;
 
 namespace Core {
 
-PerfStats::PerfStats(u64 title_id) : title_id(title_id) {}
+/// Formats per-frame records and writes them to a file on a background thread, so that the
+/// emulation threads never block on file I/O. Records are passed through a preallocated ring,
+/// pushing them neither allocates nor takes a lock.
+class PerfStats::TelemetryWriter {
+public:
+    TelemetryWriter(const std::string& filename, Settings::FrameTelemetryFormat format)
+        : file{filename, "w"}, format{format} {
+        if (format == Settings::FrameTelemetryFormat::CSV) {
+            file.WriteString("frame,timestamp_ms,frametime_ms,frame_length_ms,cpu_time_ms,"
+                             "gpu_command_time_ms,shader_compiles,surface_cache_hits,"
+                             "surface_cache_misses,ubershader_draws,surface_evictions,"
+                             "surface_cache_size_mb,texture_dump_queue,texture_dumps_dropped,"
+                             "audio_buffer_level\n");
+        }
+        thread = std::thread(&TelemetryWriter::WriterThread, this);
+    }
+
+    ~TelemetryWriter() {
+        stop_event.Set();
+        thread.join();
+    }
+
+    void Push(const FrameRecord& record) {
+        if (records.Push(&record, 1) == 0) {
+            dropped_records++;
+        }
+    }
+
+private:
+    /// Number of records the ring holds, enough for several seconds of frames
+    static constexpr std::size_t RING_SIZE = 1024;
+
+    /// Interval at which the writer thread drains the ring
+    static constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(100);
+
+    void WriterThread() {
+        Common::SetCurrentThreadName("FrameTelemetry");
+        bool stopping = false;
+        while (!stopping) {
+            stopping = stop_event.WaitUntil(std::chrono::steady_clock::now() + WRITE_INTERVAL);
+            FrameRecord record;
+            while (records.Pop(&record, 1) != 0) {
+                file.WriteString(Format(record));
+            }
+        }
+        if (const u64 dropped = dropped_records.load(); dropped != 0) {
+            LOG_WARNING(Core, "{} frame telemetry records were dropped", dropped);
+        }
+        file.Flush();
+    }
+
+    std::string Format(const FrameRecord& record) const {
+        const auto counter = [&record](FrameCounter counter) {
+            return record.counters[static_cast<std::size_t>(counter)];
+        };
+        const auto counter_ms = [&counter](FrameCounter time_counter) {
+            return static_cast<double>(counter(time_counter)) / 1'000'000.0;
+        };
+        const double surface_cache_size_mb =
+            static_cast<double>(
+                record.gauges[static_cast<std::size_t>(FrameGauge::SurfaceCacheSize)]) /
+            (1024.0 * 1024.0);
+        const u64 texture_dump_queue =
+            record.gauges[static_cast<std::size_t>(FrameGauge::TextureDumpQueue)];
+
+        if (format == Settings::FrameTelemetryFormat::JSON) {
+            return fmt::format(
+                "{{\"frame\":{},\"timestamp_ms\":{:.3f},\"frametime_ms\":{:.3f},"
+                "\"frame_length_ms\":{:.3f},\"cpu_time_ms\":{:.3f},"
+                "\"gpu_command_time_ms\":{:.3f},\"shader_compiles\":{},"
+                "\"surface_cache_hits\":{},\"surface_cache_misses\":{},"
+                "\"ubershader_draws\":{},\"surface_evictions\":{},"
+                "\"surface_cache_size_mb\":{:.3f},\"texture_dump_queue\":{},"
+                "\"texture_dumps_dropped\":{},\"audio_buffer_level\":{}}}\n",
+                record.frame, record.timestamp, record.frametime, record.frame_length,
+                counter_ms(FrameCounter::CpuTime), counter_ms(FrameCounter::GpuCommandTime),
+                counter(FrameCounter::ShaderCompiles), counter(FrameCounter::SurfaceCacheHits),
+                counter(FrameCounter::SurfaceCacheMisses), counter(FrameCounter::UberShaderDraws),
+                counter(FrameCounter::SurfaceEvictions), surface_cache_size_mb, texture_dump_queue,
+                counter(FrameCounter::TextureDumpsDropped), record.audio_buffer_level);
+        }
+        return fmt::format("{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{},{},{},{},{},{:.3f},{},{},{}\n",
+                           record.frame, record.timestamp, record.frametime, record.frame_length,
+                           counter_ms(FrameCounter::CpuTime),
+                           counter_ms(FrameCounter::GpuCommandTime),
+                           counter(FrameCounter::ShaderCompiles),
+                           counter(FrameCounter::SurfaceCacheHits),
+                           counter(FrameCounter::SurfaceCacheMisses),
+                           counter(FrameCounter::UberShaderDraws),
+                           counter(FrameCounter::SurfaceEvictions), surface_cache_size_mb,
+                           texture_dump_queue, counter(FrameCounter::TextureDumpsDropped),
+                           record.audio_buffer_level);
+    }
+
+    FileUtil::IOFile file;
+    Settings::FrameTelemetryFormat format;
+    Common::RingBuffer<FrameRecord, RING_SIZE> records;
+    std::atomic<u64> dropped_records = 0;
+    Common::Event stop_event;
+    std::thread thread;
+};
+
+PerfStats::PerfStats(u64 title_id) : title_id(title_id) {
+    // Ignore whatever was accumulated before emulation started
+    for (std::size_t i = 0; i < session_start_counters.size(); ++i) {
+        session_start_counters[i] = GetFrameCounter(static_cast<FrameCounter>(i));
+    }
+    previous_counters = session_start_counters;
+    for (auto& gauge : Detail::frame_gauges) {
+        gauge.store(0, std::memory_order_relaxed);
+    }
+    GetCallStats().Reset();
+
+    const auto format = Settings::values.frame_telemetry_format;
+    if (format == Settings::FrameTelemetryFormat::Disabled || title_id == 0) {
+        return;
+    }
+
+    const std::time_t t = std::time(nullptr);
+    const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    const char* extension = format == Settings::FrameTelemetryFormat::JSON ? "jsonl" : "csv";
+    // %F Date format expanded is "%Y-%m-%d"
+    const std::string filename = fmt::format("{}/{:%F-%H-%M}_{:016X}_frames.{}", path,
+                                             *std::localtime(&t), title_id, extension);
+    telemetry_writer = std::make_unique<TelemetryWriter>(filename, format);
+}
 
 PerfStats::~PerfStats() {
+    if (telemetry_writer) {
+        // Write the session's call statistics next to the frame telemetry
+        const std::time_t t = std::time(nullptr);
+        const std::string& path = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+        const std::string filename = fmt::format("{}/{:%F-%H-%M}_{:016X}_calls.json", path,
+                                                 *std::localtime(&t), title_id);
+        FileUtil::IOFile file(filename, "w");
+        file.WriteString(GetCallStats().DumpJson());
+    }
+    telemetry_writer.reset();
+
     if (!Settings::values.record_frame_times || title_id == 0) {
         return;
     }
@@ -66,6 +207,29 @@ void PerfStats::EndSystemFrame() {
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
+
+    FrameRecord record{};
+    for (std::size_t i = 0; i < record.counters.size(); ++i) {
+        const u64 value = GetFrameCounter(static_cast<FrameCounter>(i));
+        record.counters[i] = value - previous_counters[i];
+        previous_counters[i] = value;
+    }
+    for (std::size_t i = 0; i < record.gauges.size(); ++i) {
+        record.gauges[i] = Detail::frame_gauges[i].load(std::memory_order_relaxed);
+    }
+    surface_evictions += record.counters[static_cast<std::size_t>(FrameCounter::SurfaceEvictions)];
+    GetCallStats().EndFrame();
+
+    if (telemetry_writer) {
+        using DoubleMs = std::chrono::duration<double, std::milli>;
+        record.frame = frame_count;
+        record.timestamp = DoubleMs(frame_end - telemetry_origin).count();
+        record.frametime = DoubleMs(frame_time).count();
+        record.frame_length = DoubleMs(previous_frame_length).count();
+        record.audio_buffer_level = Core::DSP().GetOutputBufferLevel();
+        telemetry_writer->Push(record);
+    }
+    frame_count += 1;
 }
 
 void PerfStats::EndGameFrame() {
@@ -101,6 +265,10 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    results.surface_cache_size =
+        Detail::frame_gauges[static_cast<std::size_t>(FrameGauge::SurfaceCacheSize)].load(
+            std::memory_order_relaxed);
+    results.surface_evictions = surface_evictions;
 
     // Reset counters
     reset_point = now;
@@ -108,6 +276,7 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    surface_evictions = 0;
 
     return results;
 }
@@ -119,6 +288,12 @@ double PerfStats::GetLastFrameTimeScale() const {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+u64 PerfStats::GetSessionCounter(FrameCounter counter) const {
+    std::lock_guard lock{object_mutex};
+    const auto index = static_cast<std::size_t>(counter);
+    return previous_counters[index] - session_start_counters[index];
+}
+
 void FrameLimiter::WaitOnce() {
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
@@ -8,12 +8,131 @@
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include "common/common_types.h"
+#include "common/microprofile.h"
 #include "common/thread.h"
 
 namespace Core {
 
+/// Counters accumulated by the emulation components. They only ever grow, the per-frame telemetry
+/// record holds their difference over each system frame.
+enum class FrameCounter : std::size_t {
+    /// Host time spent running the emulated CPU cores (including HLE), in nanoseconds
+    CpuTime,
+    /// Host time spent processing PICA command lists, in nanoseconds
+    GpuCommandTime,
+    /// Number of host shaders and pipelines compiled
+    ShaderCompiles,
+    /// Number of surface lookups in the rasterizer cache that found an existing surface
+    SurfaceCacheHits,
+    /// Number of surfaces the rasterizer cache had to create
+    SurfaceCacheMisses,
+    /// Number of draws rendered with the fragment ubershader while their shader was compiling
+    UberShaderDraws,
+    /// Number of surfaces evicted from the rasterizer cache to stay within its memory budget
+    SurfaceEvictions,
+    /// Number of textures that were not dumped because the texture dump queue was full
+    TextureDumpsDropped,
+    /// Number of draw commands processed by the PICA command processor
+    DrawCalls,
+    NumCounters,
+};
+
+/// Values reported by the emulation components that are sampled at the end of each system frame
+enum class FrameGauge : std::size_t {
+    /// Estimated host memory used by the surfaces of the rasterizer cache, in bytes
+    SurfaceCacheSize,
+    /// Number of textures waiting to be written by the texture dumper
+    TextureDumpQueue,
+    NumGauges,
+};
+
+namespace Detail {
+inline std::array<std::atomic<u64>, static_cast<std::size_t>(FrameCounter::NumCounters)>
+    frame_counters{};
+inline std::array<std::atomic<u64>, static_cast<std::size_t>(FrameGauge::NumGauges)>
+    frame_gauges{};
+} // namespace Detail
+
+/// Adds `value` to a per-frame counter. Safe to call from any thread.
+inline void AddFrameCounter(FrameCounter counter, u64 value = 1) {
+    Detail::frame_counters[static_cast<std::size_t>(counter)].fetch_add(
+        value, std::memory_order_relaxed);
+}
+
+/// Returns the total of a per-frame counter since the program started. Safe to call from any
+/// thread, readers compute their own differences so that only the emulation components write.
+inline u64 GetFrameCounter(FrameCounter counter) {
+    return Detail::frame_counters[static_cast<std::size_t>(counter)].load(
+        std::memory_order_relaxed);
+}
+
+/// Sets the current value of a gauge. Safe to call from any thread.
+inline void SetFrameGauge(FrameGauge gauge, u64 value) {
+    Detail::frame_gauges[static_cast<std::size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+#if MICROPROFILE_ENABLED
+/**
+ * MicroProfile scope that also adds the host time spent in it to a per-frame counter. The time is
+ * taken from the MicroProfile clock, reusing the timestamp of the scope when it is recorded.
+ */
+class FrameCounterScope {
+public:
+    FrameCounterScope(MicroProfileToken token, FrameCounter counter)
+        : token{token}, counter{counter}, profile_tick{MicroProfileEnter(token)},
+          begin{profile_tick != MICROPROFILE_INVALID_TICK ? profile_tick
+                                                          : static_cast<u64>(MP_TICK())} {}
+
+    ~FrameCounterScope() {
+        const auto elapsed = static_cast<u64>(MP_TICK()) - begin;
+        MicroProfileLeave(token, profile_tick);
+        static const u64 ticks_per_second = static_cast<u64>(MicroProfileTicksPerSecondCpu());
+        AddFrameCounter(counter, static_cast<u64>(static_cast<double>(elapsed) * 1'000'000'000.0 /
+                                                  static_cast<double>(ticks_per_second)));
+    }
+
+    FrameCounterScope(const FrameCounterScope&) = delete;
+    FrameCounterScope& operator=(const FrameCounterScope&) = delete;
+
+private:
+    MicroProfileToken token;
+    FrameCounter counter;
+    u64 profile_tick;
+    u64 begin;
+};
+
+/// Profiles the enclosing scope with the MicroProfile timer `var` and adds its time to `counter`
+#define MICROPROFILE_FRAME_SCOPE(var, counter)                                                     \
+    ::Core::FrameCounterScope MICROPROFILE_TOKEN_PASTE(frame_scope_, __LINE__)(g_mp_##var, counter)
+#else
+/// Adds the host time spent in the enclosing scope to a per-frame counter.
+class FrameCounterScope {
+public:
+    explicit FrameCounterScope(FrameCounter counter)
+        : counter{counter}, begin{std::chrono::steady_clock::now()} {}
+
+    ~FrameCounterScope() {
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        AddFrameCounter(counter, static_cast<u64>(
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                         .count()));
+    }
+
+    FrameCounterScope(const FrameCounterScope&) = delete;
+    FrameCounterScope& operator=(const FrameCounterScope&) = delete;
+
+private:
+    FrameCounter counter;
+    std::chrono::steady_clock::time_point begin;
+};
+
+#define MICROPROFILE_FRAME_SCOPE(var, counter)                                                     \
+    ::Core::FrameCounterScope frame_scope_##var(counter)
+#endif
+
 /**
  * Class to manage and query performance/timing statistics. All public functions of this class are
  * thread-safe unless stated otherwise.
@@ -34,6 +153,14 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Number of times audio output ran out of samples
+        u32 audio_underruns;
+        /// Number of times audio samples were dropped because the output buffer was full
+        u32 audio_overruns;
+        /// Estimated host memory used by the rasterizer cache surfaces, in bytes
+        u64 surface_cache_size;
+        /// Number of surfaces evicted from the rasterizer cache since the last reset
+        u64 surface_evictions;
     };
 
     void BeginSystemFrame();
@@ -53,7 +180,27 @@ public:
      */
     double GetLastFrameTimeScale() const;
 
+    /// Returns the total of a per-frame counter over all system frames since emulation started
+    u64 GetSessionCounter(FrameCounter counter) const;
+
 private:
+    /// Per-frame telemetry record, streamed to a file when frame telemetry is enabled
+    struct FrameRecord {
+        u64 frame;
+        /// Walltime since emulation started, in milliseconds
+        double timestamp;
+        /// Walltime of the frame, excluding any waits, in milliseconds
+        double frametime;
+        /// Total walltime of the frame, including frame-limiting, in milliseconds
+        double frame_length;
+        std::array<u64, static_cast<std::size_t>(FrameCounter::NumCounters)> counters;
+        std::array<u64, static_cast<std::size_t>(FrameGauge::NumGauges)> gauges;
+        /// Number of audio frames queued for the sink at the end of the frame
+        std::size_t audio_buffer_level;
+    };
+
+    class TelemetryWriter;
+
     mutable std::mutex object_mutex;
 
     /// Title ID for the game that is running. 0 if there is no game running yet
@@ -75,6 +222,8 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative number of surfaces evicted from the rasterizer cache since last reset
+    u64 surface_evictions = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -82,6 +231,17 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+
+    /// Point when the first system frame began
+    Clock::time_point telemetry_origin = reset_point;
+    /// Number of system frames since emulation started
+    u64 frame_count = 0;
+    /// Values of the per-frame counters when emulation started
+    std::array<u64, static_cast<std::size_t>(FrameCounter::NumCounters)> session_start_counters{};
+    /// Values of the per-frame counters at the end of the previous system frame
+    std::array<u64, static_cast<std::size_t>(FrameCounter::NumCounters)> previous_counters{};
+    /// Writes per-frame records on a background thread, nullptr if frame telemetry is disabled
+    std::unique_ptr<TelemetryWriter> telemetry_writer;
 };
 
 class FrameLimiter {
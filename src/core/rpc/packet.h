@@ -14,6 +14,13 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ReadCallStats,
+    StartMemoryScan,
+    MemoryScan,
+    ReadMemoryScanResults,
+    AddMemoryWatch,
+    RemoveMemoryWatch,
+    ReadMemoryWatchHits,
 };
 
 struct PacketHeader {
@@ -28,6 +35,15 @@ constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
 constexpr u32 MAX_PACKET_DATA_SIZE = 32;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
+/// Replies to bulk reads can be larger than requests
+constexpr u32 MAX_REPLY_DATA_SIZE = 1024;
+constexpr u32 MAX_REPLY_SIZE = MIN_PACKET_SIZE + MAX_REPLY_DATA_SIZE;
+constexpr u32 MEMORY_SCAN_RESULT_SIZE = sizeof(u32) * 2 + sizeof(u64);
+constexpr u32 MAX_MEMORY_SCAN_RESULTS = MAX_REPLY_DATA_SIZE / MEMORY_SCAN_RESULT_SIZE;
+constexpr u32 MEMORY_WATCH_READ = 1 << 0;
+constexpr u32 MEMORY_WATCH_WRITE = 1 << 1;
+constexpr u32 MEMORY_WATCH_HIT_SIZE = sizeof(u64) * 2 + sizeof(u32) * 3;
+constexpr u32 MAX_MEMORY_WATCH_HITS = MAX_REPLY_DATA_SIZE / MEMORY_WATCH_HIT_SIZE;
 
 class Packet {
 public:
@@ -53,7 +69,7 @@ public:
         return header;
     }
 
-    std::array<u8, MAX_PACKET_DATA_SIZE>& GetPacketData() {
+    std::array<u8, MAX_REPLY_DATA_SIZE>& GetPacketData() {
         return packet_data;
     }
 
@@ -70,7 +86,7 @@ private:
     void HandleWriteMemory(u32 address, const u8* data, u32 data_size);
 
     struct PacketHeader header;
-    std::array<u8, MAX_PACKET_DATA_SIZE> packet_data;
+    std::array<u8, MAX_REPLY_DATA_SIZE> packet_data;
 
     std::function<void(Packet&)> send_reply_callback;
 };
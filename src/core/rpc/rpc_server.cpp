@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
+#include "core/call_stats.h"
+#include "core/cheats/cheats.h"
+#include "core/cheats/memory_scanner.h"
 #include "core/core.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
@@ -54,6 +59,86 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u
     packet.SendReply();
 }
 
+void RPCServer::HandleReadCallStats(Packet& packet, u32 offset) {
+    // The dump doesn't fit in a packet, so clients read it in chunks until a reply is shorter
+    // than MAX_READ_SIZE. Reading from the start takes a new snapshot.
+    if (offset == 0) {
+        call_stats_json = Core::GetCallStats().DumpJson();
+    }
+
+    const std::size_t begin = std::min<std::size_t>(offset, call_stats_json.size());
+    const std::size_t size = std::min<std::size_t>(call_stats_json.size() - begin, MAX_READ_SIZE);
+    std::memcpy(packet.GetPacketData().data(), call_stats_json.data() + begin, size);
+    packet.SetPacketDataSize(static_cast<u32>(size));
+    packet.SendReply();
+}
+
+void RPCServer::HandleStartMemoryScan(Packet& packet, u32 value_type) {
+    // Note: Memory scans occur asynchronously from the state of the emulator
+    auto& scanner = Core::System::GetInstance().CheatEngine().GetMemoryScanner();
+    const u64 num_results = scanner.NewScan(static_cast<Cheats::ScanValueType>(value_type));
+    std::memcpy(packet.GetPacketData().data(), &num_results, sizeof(num_results));
+    packet.SetPacketDataSize(sizeof(num_results));
+    packet.SendReply();
+}
+
+void RPCServer::HandleMemoryScan(Packet& packet, u32 comparison, u64 value) {
+    auto& scanner = Core::System::GetInstance().CheatEngine().GetMemoryScanner();
+    const u64 num_results = scanner.Scan(static_cast<Cheats::ScanComparison>(comparison), value);
+    std::memcpy(packet.GetPacketData().data(), &num_results, sizeof(num_results));
+    packet.SetPacketDataSize(sizeof(num_results));
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadMemoryScanResults(Packet& packet, u32 first, u32 count) {
+    const auto& scanner = Core::System::GetInstance().CheatEngine().GetMemoryScanner();
+
+    // Every result is sent as its physical address, its virtual address in the current process
+    // (0 if it isn't mapped) and its value
+    u8* data = packet.GetPacketData().data();
+    const auto results = scanner.GetResults(first, count);
+    const auto virtual_addresses = scanner.GetVirtualAddresses(results);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Cheats::ScanResult& result = results[i];
+        const u32 virtual_address = virtual_addresses[i].value_or(0);
+        std::memcpy(data, &result.address, sizeof(u32));
+        std::memcpy(data + sizeof(u32), &virtual_address, sizeof(u32));
+        std::memcpy(data + sizeof(u32) * 2, &result.value, sizeof(u64));
+        data += MEMORY_SCAN_RESULT_SIZE;
+    }
+    packet.SetPacketDataSize(static_cast<u32>(results.size() * MEMORY_SCAN_RESULT_SIZE));
+    packet.SendReply();
+}
+
+void RPCServer::HandleMemoryWatch(Packet& packet, u32 address, u32 size, u32 flags, bool add) {
+    auto& system = Core::System::GetInstance();
+    const Memory::WatchRange range{address, size, (flags & MEMORY_WATCH_READ) != 0,
+                                   (flags & MEMORY_WATCH_WRITE) != 0};
+    // The page table is shared with the CPU, let the emulation thread apply the change
+    system.Memory().QueueWatchChange(system.Kernel().GetCurrentProcess()->vm_manager.page_table,
+                                     range, add);
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadMemoryWatchHits(Packet& packet, u32 count) {
+    // Every hit is sent as its tick, its value, its PC, its address and its size, with the
+    // MEMORY_WATCH_WRITE flag shifted above the size for writes
+    u8* data = packet.GetPacketData().data();
+    const auto hits = Core::System::GetInstance().Memory().PopWatchHits(count);
+    for (const Memory::MemoryWatchHit& hit : hits) {
+        const u32 size_and_flags = hit.size | (hit.write ? MEMORY_WATCH_WRITE << 8 : 0);
+        std::memcpy(data, &hit.tick, sizeof(u64));
+        std::memcpy(data + sizeof(u64), &hit.value, sizeof(u64));
+        std::memcpy(data + sizeof(u64) * 2, &hit.pc, sizeof(u32));
+        std::memcpy(data + sizeof(u64) * 2 + sizeof(u32), &hit.address, sizeof(u32));
+        std::memcpy(data + sizeof(u64) * 2 + sizeof(u32) * 2, &size_and_flags, sizeof(u32));
+        data += MEMORY_WATCH_HIT_SIZE;
+    }
+    packet.SetPacketDataSize(static_cast<u32>(hits.size() * MEMORY_WATCH_HIT_SIZE));
+    packet.SendReply();
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
@@ -63,6 +148,33 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
                 return true;
             }
             break;
+        case PacketType::ReadCallStats:
+        case PacketType::StartMemoryScan:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
+        case PacketType::MemoryScan:
+            if (packet_header.packet_size >= sizeof(u32) + sizeof(u64)) {
+                return true;
+            }
+            break;
+        case PacketType::ReadMemoryScanResults:
+            if (packet_header.packet_size >= sizeof(u32) * 2) {
+                return true;
+            }
+            break;
+        case PacketType::AddMemoryWatch:
+        case PacketType::RemoveMemoryWatch:
+            if (packet_header.packet_size >= sizeof(u32) * 3) {
+                return true;
+            }
+            break;
+        case PacketType::ReadMemoryWatchHits:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
         default:
             break;
         }
@@ -74,7 +186,8 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        // Memory requests use the address/data_size wire format, the other requests reuse these
+        // words for their own arguments
         u32 address = 0;
         u32 data_size = 0;
         std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
@@ -88,6 +201,48 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ReadCallStats:
+            HandleReadCallStats(*request_packet, address);
+            success = true;
+            break;
+        case PacketType::StartMemoryScan:
+            if (address <= static_cast<u32>(Cheats::ScanValueType::Double)) {
+                HandleStartMemoryScan(*request_packet, address);
+                success = true;
+            }
+            break;
+        case PacketType::MemoryScan:
+            if (address <= static_cast<u32>(Cheats::ScanComparison::DecreasedBy)) {
+                u64 value = 0;
+                std::memcpy(&value, request_packet->GetPacketData().data() + sizeof(u32),
+                            sizeof(value));
+                HandleMemoryScan(*request_packet, address, value);
+                success = true;
+            }
+            break;
+        case PacketType::ReadMemoryScanResults:
+            if (data_size > 0 && data_size <= MAX_MEMORY_SCAN_RESULTS) {
+                HandleReadMemoryScanResults(*request_packet, address, data_size);
+                success = true;
+            }
+            break;
+        case PacketType::AddMemoryWatch:
+        case PacketType::RemoveMemoryWatch:
+            if (data_size > 0 && Core::System::GetInstance().Kernel().GetCurrentProcess()) {
+                u32 flags = 0;
+                std::memcpy(&flags, request_packet->GetPacketData().data() + sizeof(u32) * 2,
+                            sizeof(flags));
+                HandleMemoryWatch(*request_packet, address, data_size, flags,
+                                  request_packet->GetPacketType() == PacketType::AddMemoryWatch);
+                success = true;
+            }
+            break;
+        case PacketType::ReadMemoryWatchHits:
+            if (address > 0 && address <= MAX_MEMORY_WATCH_HITS) {
+                HandleReadMemoryWatchHits(*request_packet, address);
+                success = true;
+            }
+            break;
         case PacketType::WriteMemory:
             if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
                 const u8* data = request_packet->GetPacketData().data() + (sizeof(u32) * 2);
@@ -7,6 +7,7 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include "common/threadsafe_queue.h"
 #include "core/rpc/server.h"
@@ -28,6 +29,12 @@ private:
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadCallStats(Packet& packet, u32 offset);
+    void HandleStartMemoryScan(Packet& packet, u32 value_type);
+    void HandleMemoryScan(Packet& packet, u32 comparison, u64 value);
+    void HandleReadMemoryScanResults(Packet& packet, u32 first, u32 count);
+    void HandleMemoryWatch(Packet& packet, u32 address, u32 size, u32 flags, bool add);
+    void HandleReadMemoryWatchHits(Packet& packet, u32 count);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
@@ -35,6 +42,8 @@ private:
     Server server;
     Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+    /// JSON dump of the call statistics that is being read, taken when reading at offset 0
+    std::string call_stats_json;
 };
 
 } // namespace RPC
@@ -44,7 +44,7 @@ void Apply() {
 
 #ifndef ANDROID
     if (VideoCore::g_renderer) {
-        VideoCore::g_renderer->UpdateCurrentFramebufferLayout();
+        VideoCore::RunOnRenderer([] { VideoCore::g_renderer->UpdateCurrentFramebufferLayout(); });
     }
 #endif
 
@@ -58,6 +58,7 @@ void Apply() {
         system.CoreTiming().UpdateClockSpeed(values.cpu_clock_percentage);
         Core::DSP().SetSink(values.sink_id, values.audio_device_id);
         Core::DSP().EnableStretching(values.enable_audio_stretching);
+        Core::DSP().EnableLowLatency(values.enable_low_latency_audio, values.audio_latency_target);
 
         auto hid = Service::HID::GetModule(system);
         if (hid) {
@@ -91,12 +92,15 @@ void LogSettings() {
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage);
     log_setting("Renderer_GraphicsAPI", GetAPIName(values.graphics_api));
     log_setting("Renderer_AsyncRecording", values.async_command_recording);
+    log_setting("Renderer_UseAsyncGpu", values.use_async_gpu);
+    log_setting("Renderer_AsyncShaderCompilation", values.async_shader_compilation);
     log_setting("Renderer_UseHwRenderer", values.use_hw_renderer);
     log_setting("Renderer_UseHwShader", values.use_hw_shader);
     log_setting("Renderer_SeparableShader", values.separable_shader);
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul);
     log_setting("Renderer_UseShaderJit", values.use_shader_jit);
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor);
+    log_setting("Renderer_SurfaceCacheBudget", values.surface_cache_budget);
     log_setting("Renderer_FrameLimit", values.frame_limit);
     log_setting("Renderer_UseFrameLimitAlternate", values.use_frame_limit_alternate);
     log_setting("Renderer_FrameLimitAlternate", values.frame_limit_alternate);
@@ -116,6 +120,8 @@ void LogSettings() {
     log_setting("Audio_EnableDspLleMultithread", values.enable_dsp_lle_multithread);
     log_setting("Audio_OutputEngine", values.sink_id);
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching);
+    log_setting("Audio_EnableLowLatencyAudio", values.enable_low_latency_audio);
+    log_setting("Audio_LatencyTarget", values.audio_latency_target);
     log_setting("Audio_OutputDevice", values.audio_device_id);
     log_setting("Audio_InputDeviceType", values.mic_input_type);
     log_setting("Audio_InputDevice", values.mic_input_device);
@@ -138,6 +144,7 @@ void LogSettings() {
     log_setting("System_RegionValue", values.region_value);
     log_setting("Debugging_UseGdbstub", values.use_gdbstub);
     log_setting("Debugging_GdbstubPort", values.gdbstub_port);
+    log_setting("Debugging_FrameTelemetryFormat", values.frame_telemetry_format);
 }
 
 float Volume() {
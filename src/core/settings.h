@@ -44,6 +44,12 @@ enum class MicInputType {
     Static,
 };
 
+enum class FrameTelemetryFormat {
+    Disabled = 0,
+    CSV = 1,
+    JSON = 2,
+};
+
 enum class StereoRenderOption {
     Off,
     SideBySide,
@@ -173,6 +179,8 @@ struct Values {
     bool renderer_debug;
     bool dump_command_buffers;
     bool async_command_recording;
+    bool use_async_gpu;
+    bool async_shader_compilation;
     bool use_hw_renderer;
     bool use_hw_shader;
     bool separable_shader;
@@ -181,6 +189,7 @@ struct Values {
     bool use_shader_jit;
     bool use_vsync_new;
     u16 resolution_factor;
+    u32 surface_cache_budget;
     bool use_frame_limit_alternate;
     u16 frame_limit;
     u16 frame_limit_alternate;
@@ -226,6 +235,8 @@ struct Values {
     bool enable_dsp_lle_multithread;
     std::string sink_id;
     bool enable_audio_stretching;
+    bool enable_low_latency_audio;
+    u16 audio_latency_target; // in milliseconds
     std::string audio_device_id;
     float volume;
     MicInputType mic_input_type;
@@ -238,6 +249,7 @@ struct Values {
 
     // Debugging
     bool record_frame_times;
+    FrameTelemetryFormat frame_telemetry_format;
     bool use_gdbstub;
     u16 gdbstub_port;
     std::string log_filter;
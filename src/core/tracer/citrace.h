@@ -18,7 +18,7 @@ struct CTHeader {
     }
 
     static u32 ExpectedVersion() {
-        return 1;
+        return 2;
     }
 
     char magic[4];
@@ -56,10 +56,30 @@ struct CTHeader {
         // - Lookup tables for procedural textures
     } initial_state_offsets;
 
+    // Version 1: Offset of the CTStreamElement array and number of elements.
+    // Version 2: Offset of the CTBlockIndexEntry array and number of blocks.
     u32 stream_offset;
     u32 stream_size;
 };
 
+// Version 2 traces are written while recording. The initial state follows the header as in
+// version 1, then the memory data chunks and the stream blocks follow in recording order, and the
+// block index comes last. Chunks and blocks are compressed with Zstandard, each is preceded by a
+// CTChunkHeader. Memory loads refer to the chunk header of their data with their file_offset.
+
+struct CTChunkHeader {
+    u32 compressed_size;
+    u32 uncompressed_size;
+};
+
+/// Describes a block of consecutive stream elements, so that readers can start at any frame
+struct CTBlockIndexEntry {
+    u32 file_offset;   ///< Offset of the CTChunkHeader of the block
+    u32 first_element; ///< Index of the first element of the block in the stream
+    u32 num_elements;  ///< Number of elements in the block
+    u32 first_frame;   ///< Index of the frame the first element belongs to
+};
+
 enum CTStreamElementType : u32 {
     FrameMarker = 0xE1,
     MemoryLoad = 0xE2,
@@ -3,18 +3,38 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <limits>
+#include <fmt/format.h>
 #include "common/assert.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
 #include "core/tracer/recorder.h"
 
 namespace CiTrace {
 
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
+namespace {
 
-void Recorder::Finish(const std::string& filename) {
-    // Setup CiTrace header
-    CTHeader header;
+/// Number of elements after which a block is ended at the next frame marker
+constexpr std::size_t BLOCK_TARGET_ELEMENTS = 0x4000;
+
+/// Number of elements after which a block is ended even within a frame
+constexpr std::size_t BLOCK_MAX_ELEMENTS = 0x10000;
+
+/// Number of elements after which a batch is handed to the writer thread
+constexpr std::size_t BATCH_MAX_ELEMENTS = 0x400;
+
+/// Amount of data after which a batch is handed to the writer thread
+constexpr std::size_t BATCH_MAX_BYTES = 1024 * 1024;
+
+/// Amount of queued data after which the recording thread waits for the writer thread
+constexpr std::size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+} // Anonymous namespace
+
+Recorder::Recorder(const InitialState& initial_state, const std::string& filename)
+    : filename(filename), temp_filename(fmt::format("{}.tmp", filename)) {
+    // Setup CiTrace header, the block index is filled in once the recording is finished
     std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
     header.version = CTHeader::ExpectedVersion();
     header.header_size = sizeof(CTHeader);
@@ -32,12 +52,10 @@ void Recorder::Finish(const std::string& filename) {
     initial.gs_program_binary_size = static_cast<u32>(initial_state.gs_program_binary.size());
     initial.gs_swizzle_data_size = static_cast<u32>(initial_state.gs_swizzle_data.size());
     initial.gs_float_uniforms_size = static_cast<u32>(initial_state.gs_float_uniforms.size());
-    header.stream_size = static_cast<u32>(stream.size());
 
     initial.gpu_registers = sizeof(header);
     initial.lcd_registers = initial.gpu_registers + initial.gpu_registers_size * sizeof(u32);
     initial.pica_registers = initial.lcd_registers + initial.lcd_registers_size * sizeof(u32);
-    ;
     initial.default_attributes = initial.pica_registers + initial.pica_registers_size * sizeof(u32);
     initial.vs_program_binary =
         initial.default_attributes + initial.default_attributes_size * sizeof(u32);
@@ -51,120 +69,104 @@ void Recorder::Finish(const std::string& filename) {
         initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
     initial.gs_float_uniforms =
         initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
-
-    // Iterate through stream elements, update relevant stream element data
-    for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
-            }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
-        }
-
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
-    }
 
     try {
         // Open file and write header
-        FileUtil::IOFile file(filename, "wb");
+        file = FileUtil::IOFile(temp_filename, "wb");
         std::size_t written = file.WriteObject(header);
         if (written != 1 || file.Tell() != initial.gpu_registers)
             throw "Failed to write header";
 
         // Write initial state
-        written =
-            file.WriteArray(initial_state.gpu_registers.data(), initial_state.gpu_registers.size());
-        if (written != initial_state.gpu_registers.size() || file.Tell() != initial.lcd_registers)
-            throw "Failed to write GPU registers";
-
-        written =
-            file.WriteArray(initial_state.lcd_registers.data(), initial_state.lcd_registers.size());
-        if (written != initial_state.lcd_registers.size() || file.Tell() != initial.pica_registers)
-            throw "Failed to write LCD registers";
-
-        written = file.WriteArray(initial_state.pica_registers.data(),
-                                  initial_state.pica_registers.size());
-        if (written != initial_state.pica_registers.size() ||
-            file.Tell() != initial.default_attributes)
-            throw "Failed to write Pica registers";
-
-        written = file.WriteArray(initial_state.default_attributes.data(),
-                                  initial_state.default_attributes.size());
-        if (written != initial_state.default_attributes.size() ||
-            file.Tell() != initial.vs_program_binary)
-            throw "Failed to write default vertex attributes";
-
-        written = file.WriteArray(initial_state.vs_program_binary.data(),
-                                  initial_state.vs_program_binary.size());
-        if (written != initial_state.vs_program_binary.size() ||
-            file.Tell() != initial.vs_swizzle_data)
-            throw "Failed to write vertex shader program binary";
-
-        written = file.WriteArray(initial_state.vs_swizzle_data.data(),
-                                  initial_state.vs_swizzle_data.size());
-        if (written != initial_state.vs_swizzle_data.size() ||
-            file.Tell() != initial.vs_float_uniforms)
-            throw "Failed to write vertex shader swizzle data";
-
-        written = file.WriteArray(initial_state.vs_float_uniforms.data(),
-                                  initial_state.vs_float_uniforms.size());
-        if (written != initial_state.vs_float_uniforms.size() ||
-            file.Tell() != initial.gs_program_binary)
-            throw "Failed to write vertex shader float uniforms";
-
-        written = file.WriteArray(initial_state.gs_program_binary.data(),
-                                  initial_state.gs_program_binary.size());
-        if (written != initial_state.gs_program_binary.size() ||
-            file.Tell() != initial.gs_swizzle_data)
-            throw "Failed to write geomtry shader program binary";
-
-        written = file.WriteArray(initial_state.gs_swizzle_data.data(),
-                                  initial_state.gs_swizzle_data.size());
-        if (written != initial_state.gs_swizzle_data.size() ||
-            file.Tell() != initial.gs_float_uniforms)
-            throw "Failed to write geometry shader swizzle data";
-
-        written = file.WriteArray(initial_state.gs_float_uniforms.data(),
-                                  initial_state.gs_float_uniforms.size());
-        if (written != initial_state.gs_float_uniforms.size() ||
-            file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
-            throw "Failed to write geometry shader float uniforms";
-
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
-
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
+        const std::vector<u32>* const blocks[] = {
+            &initial_state.gpu_registers,     &initial_state.lcd_registers,
+            &initial_state.pica_registers,    &initial_state.default_attributes,
+            &initial_state.vs_program_binary, &initial_state.vs_swizzle_data,
+            &initial_state.vs_float_uniforms, &initial_state.gs_program_binary,
+            &initial_state.gs_swizzle_data,   &initial_state.gs_float_uniforms,
+        };
+        for (const std::vector<u32>* data : blocks) {
+            written = file.WriteArray(data->data(), data->size());
+            if (written != data->size())
+                throw "Failed to write initial state";
         }
 
-        if (file.Tell() != header.stream_offset)
-            throw "Unexpected end of extra data";
+        if (file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
+            throw "Unexpected end of initial state";
+    } catch (const char* str) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+        failed = true;
+    }
+
+    writer_thread = std::thread([this] { WriterLoop(); });
+}
 
-        // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
+Recorder::~Recorder() {
+    if (writer_thread.joinable()) {
+        {
+            std::scoped_lock lock{queue_mutex};
+            stop_writer = true;
         }
+        queue_cv.notify_all();
+        space_cv.notify_all();
+        writer_thread.join();
+    }
+
+    if (!temp_filename.empty()) {
+        file.Close();
+        FileUtil::Delete(temp_filename);
+    }
+}
+
+void Recorder::Finish() {
+    if (!writer_thread.joinable()) {
+        return;
+    }
+
+    // Let the writer thread drain the queue
+    SubmitBatch();
+    {
+        std::scoped_lock lock{queue_mutex};
+        stop_writer = true;
+    }
+    queue_cv.notify_all();
+    space_cv.notify_all();
+    writer_thread.join();
+
+    try {
+        if (failed)
+            throw "Failed to write stream";
+
+        const u64 index_offset = file.Tell();
+        if (index_offset > std::numeric_limits<u32>::max())
+            throw "Recording exceeds the maximum file size";
+
+        const std::size_t written = file.WriteArray(block_index.data(), block_index.size());
+        if (written != block_index.size())
+            throw "Failed to write block index";
+
+        header.stream_offset = static_cast<u32>(index_offset);
+        header.stream_size = static_cast<u32>(block_index.size());
+        if (!file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1)
+            throw "Failed to write header";
+
+        if (!file.Close())
+            throw "Failed to close file";
+
+        // The temporary file is in the same directory, so that it can be renamed into place
+        if (FileUtil::Exists(filename) && !FileUtil::Delete(filename))
+            throw "Failed to replace the destination file";
+        if (!FileUtil::Rename(temp_filename, filename))
+            throw "Failed to move the recording to its destination";
+        temp_filename.clear();
     } catch (const char* str) {
         LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
     }
 }
 
 void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+    Enqueue({{FrameMarker}});
+    SubmitBatch();
 }
 
 void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
@@ -177,14 +179,12 @@ void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
     result.process_bytes(data, size);
     element.hash = result.checksum();
 
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
+    // Batches are written in order, so the region is written before any element that reuses it
+    element.uses_existing_data = !queued_regions.insert(element.hash).second;
     if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
+        element.extra_data.assign(data, data + size);
     }
-
-    stream.push_back(element);
+    Enqueue(std::move(element));
 }
 
 template <typename T>
@@ -197,7 +197,132 @@ void Recorder::RegisterWritten(u32 physical_address, T value) {
     element.data.register_write.physical_address = physical_address;
     element.data.register_write.value = value;
 
-    stream.push_back(element);
+    Enqueue(std::move(element));
+}
+
+void Recorder::Enqueue(StreamElement&& element) {
+    batch_bytes += sizeof(StreamElement) + element.extra_data.size();
+    batch.push_back(std::move(element));
+    if (batch.size() >= BATCH_MAX_ELEMENTS || batch_bytes >= BATCH_MAX_BYTES) {
+        SubmitBatch();
+    }
+}
+
+void Recorder::SubmitBatch() {
+    if (batch.empty()) {
+        return;
+    }
+
+    std::unique_lock lock{queue_mutex};
+    space_cv.wait(lock, [this] { return stop_writer || queued_bytes < MAX_QUEUED_BYTES; });
+    if (!stop_writer) {
+        queued_bytes += batch_bytes;
+        queue.push_back(std::move(batch));
+    }
+    lock.unlock();
+    queue_cv.notify_one();
+
+    batch.clear();
+    batch_bytes = 0;
+}
+
+void Recorder::WriterLoop() {
+    while (true) {
+        std::unique_lock lock{queue_mutex};
+        queue_cv.wait(lock, [this] { return stop_writer || !queue.empty(); });
+        if (queue.empty()) {
+            break;
+        }
+
+        std::vector<StreamElement> elements = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+
+        std::size_t written_bytes = 0;
+        for (StreamElement& element : elements) {
+            written_bytes += sizeof(StreamElement) + element.extra_data.size();
+            WriteElement(element);
+        }
+
+        lock.lock();
+        queued_bytes -= written_bytes;
+        lock.unlock();
+        space_cv.notify_all();
+    }
+    FlushBlock();
+}
+
+void Recorder::WriteElement(StreamElement& element) {
+    if (element.data.type == MemoryLoad) {
+        auto& file_offset = memory_regions[element.hash];
+        if (!element.uses_existing_data) {
+            file_offset = WriteChunk(element.extra_data.data(), element.extra_data.size());
+        }
+        element.data.memory_load.file_offset = file_offset;
+    }
+
+    block.push_back(element.data);
+    num_elements++;
+
+    // Prefer ending blocks with a frame, so that readers can start at a block to seek to a frame
+    if (element.data.type == FrameMarker) {
+        num_frames++;
+        if (block.size() >= BLOCK_TARGET_ELEMENTS) {
+            FlushBlock();
+        }
+    } else if (block.size() >= BLOCK_MAX_ELEMENTS) {
+        FlushBlock();
+    }
+}
+
+void Recorder::FlushBlock() {
+    if (block.empty()) {
+        return;
+    }
+
+    const u32 file_offset = WriteChunk(reinterpret_cast<const u8*>(block.data()),
+                                       block.size() * sizeof(CTStreamElement));
+    block_index.push_back({
+        .file_offset = file_offset,
+        .first_element = num_elements - static_cast<u32>(block.size()),
+        .num_elements = static_cast<u32>(block.size()),
+        .first_frame = block_first_frame,
+    });
+
+    block.clear();
+    block_first_frame = num_frames;
+}
+
+u32 Recorder::WriteChunk(const u8* data, std::size_t size) {
+    if (failed) {
+        return 0;
+    }
+
+    const std::vector<u8> compressed = Common::Compression::CompressDataZSTDDefault(data, size);
+    const u64 file_offset = file.Tell();
+    if (compressed.empty() && size != 0) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: Failed to compress data");
+        failed = true;
+        return 0;
+    }
+    if (file_offset + sizeof(CTChunkHeader) + compressed.size() >
+        std::numeric_limits<u32>::max()) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: Recording exceeds the maximum file size");
+        failed = true;
+        return 0;
+    }
+
+    const CTChunkHeader chunk_header{
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .uncompressed_size = static_cast<u32>(size),
+    };
+    if (file.WriteObject(chunk_header) != 1 ||
+        file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: Failed to write data");
+        failed = true;
+        return 0;
+    }
+    return static_cast<u32>(file_offset);
 }
 
 template void Recorder::RegisterWritten(u32, u8);
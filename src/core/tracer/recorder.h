@@ -4,15 +4,27 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <boost/crc.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "core/tracer/citrace.h"
 
 namespace CiTrace {
 
+/**
+ * Records a CiTrace. Stream elements are collected in batches, which are handed to a background
+ * thread that compresses them and streams them to a temporary file next to the destination, so
+ * the length of a recording isn't bound by the host memory.
+ * @note Apart from Finish, the recording methods must be called from a single thread.
+ */
 class Recorder {
 public:
     struct InitialState {
@@ -31,11 +43,15 @@ public:
     /**
      * Recorder constructor
      * @param initial_state Initial recorder state
+     * @param filename File the recording is saved to once it is finished
      */
-    explicit Recorder(const InitialState& initial_state);
+    Recorder(const InitialState& initial_state, const std::string& filename);
 
-    /// Finish recording of this Citrace and save it using the given filename.
-    void Finish(const std::string& filename);
+    /// Discards the recording unless it was finished.
+    ~Recorder();
+
+    /// Finish recording of this Citrace and move it to its destination file.
+    void Finish();
 
     /// Mark end of a frame
     void FrameFinished();
@@ -55,9 +71,6 @@ public:
     void RegisterWritten(u32 physical_address, T value);
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
-
     // Command stream
     struct StreamElement {
         CTStreamElement data;
@@ -75,7 +88,52 @@ private:
         bool uses_existing_data;
     };
 
-    std::vector<StreamElement> stream;
+    /// Adds an element to the current batch, submitting the batch once it is full
+    void Enqueue(StreamElement&& element);
+
+    /// Hands the current batch to the writer thread, waiting if it didn't catch up yet
+    void SubmitBatch();
+
+    /// Writes the queued elements until the recording is finished. Runs on the writer thread.
+    void WriterLoop();
+
+    void WriteElement(StreamElement& element);
+
+    /// Compresses the elements of the current block and adds the block to the index
+    void FlushBlock();
+
+    /// Compresses and writes data preceded by its chunk header, returns the chunk offset
+    u32 WriteChunk(const u8* data, std::size_t size);
+
+    // State owned by the recording thread
+    std::vector<StreamElement> batch;
+    std::size_t batch_bytes = 0;
+
+    /// Hashes of the memory regions queued so far, whose data doesn't need to be copied again
+    std::unordered_set<boost::crc_32_type::value_type> queued_regions;
+
+    // State shared with the writer thread
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::condition_variable space_cv;
+    std::deque<std::vector<StreamElement>> queue;
+    std::size_t queued_bytes = 0;
+    bool stop_writer = false;
+
+    std::thread writer_thread;
+
+    // State owned by the writer thread until it is joined
+    FileUtil::IOFile file;
+    std::string filename;
+    std::string temp_filename;
+    CTHeader header{};
+    bool failed = false;
+
+    std::vector<CTStreamElement> block;
+    u32 num_elements = 0;
+    u32 num_frames = 0;
+    u32 block_first_frame = 0;
+    std::vector<CTBlockIndexEntry> block_index;
 
     /**
      * Internal cache which maps hashes of memory contents to file offsets at which those memory
@@ -0,0 +1,108 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <iostream>
+#include <string>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/filter.h"
+#include "common/logging/text_formatter.h"
+#include "common/scm_rev.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "Decodes a binary log recorded with --binary-log into text\n"
+                 "-f, --filter=FILTER  Only output the messages that pass FILTER\n"
+                 "                     (default *:Trace)\n"
+                 "-o, --output=FILE    Write the messages to FILE instead of the standard output\n"
+                 "-h, --help           Display this help and exit\n"
+                 "-v, --version        Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string filter_string = "*:Trace";
+    std::string output_file;
+
+    int option_index = 0;
+    static struct option long_options[] = {
+        {"filter", required_argument, 0, 'f'},
+        {"output", required_argument, 0, 'o'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "f:o:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'f':
+                filter_string.assign(optarg);
+                break;
+            case 'o':
+                output_file.assign(optarg);
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return 1;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+    const std::string filename = argv[optind];
+
+    Log::Filter filter;
+    filter.ParseFilterString(filter_string);
+
+    FileUtil::IOFile output;
+    if (!output_file.empty()) {
+        output = FileUtil::IOFile(output_file, "w");
+        if (!output.IsOpen()) {
+            std::cerr << "Could not open " << output_file << std::endl;
+            return 1;
+        }
+    }
+
+    const bool decoded = Log::DecodeBinaryLog(filename, [&](const Log::Entry& entry) {
+        if (!filter.CheckMessage(entry.log_class, entry.log_level)) {
+            return;
+        }
+        const std::string line = Log::FormatLogMessage(entry).append(1, '\n');
+        if (output.IsOpen()) {
+            output.WriteString(line);
+        } else {
+            std::cout << line;
+        }
+    });
+    if (!decoded) {
+        std::cerr << filename << " is not a valid binary log or is truncated" << std::endl;
+        return 1;
+    }
+    return 0;
+}
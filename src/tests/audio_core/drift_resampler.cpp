@@ -0,0 +1,76 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <deque>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/audio_types.h"
+#include "audio_core/drift_resampler.h"
+
+namespace {
+
+struct Result {
+    std::size_t underruns_after_settling;
+    std::size_t final_queued;
+};
+
+/// Feeds the resampler from a producer running at `speed` times the rate of the consumer
+Result Simulate(double speed) {
+    constexpr std::size_t frames_per_callback = 256;
+    constexpr std::size_t target = 640;
+    constexpr std::size_t num_callbacks = 20000;
+
+    AudioCore::DriftResampler resampler;
+    resampler.SetOutputSampleRate(AudioCore::native_sample_rate);
+    resampler.Clear();
+
+    std::deque<s16> fifo;
+    std::vector<s16> in;
+    std::vector<s16> out(frames_per_callback * 2);
+    double produced = 0.0;
+    Result result{};
+    for (std::size_t i = 0; i < num_callbacks; ++i) {
+        produced += frames_per_callback * speed;
+        while (produced >= AudioCore::samples_per_frame) {
+            fifo.insert(fifo.end(), AudioCore::samples_per_frame * 2, 0);
+            produced -= AudioCore::samples_per_frame;
+        }
+
+        const std::size_t queued = fifo.size() / 2;
+        const std::size_t wanted = resampler.Update(queued, target, frames_per_callback);
+        const std::size_t popped = std::min(wanted, queued);
+        in.assign(fifo.begin(), fifo.begin() + popped * 2);
+        fifo.erase(fifo.begin(), fifo.begin() + popped * 2);
+
+        const std::size_t written =
+            wanted == 0 ? 0 : resampler.Process(in.data(), popped, out.data(), frames_per_callback);
+        if (written < frames_per_callback && i > num_callbacks / 10) {
+            ++result.underruns_after_settling;
+        }
+    }
+    result.final_queued = fifo.size() / 2;
+    return result;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DriftResampler compensates for clock drift", "[audio_core]") {
+    for (const double speed : {0.995, 1.0, 1.005}) {
+        const Result result = Simulate(speed);
+        REQUIRE(result.underruns_after_settling == 0);
+        REQUIRE(result.final_queued < 2 * 640);
+    }
+}
+
+TEST_CASE("DriftResampler detects slow emulation", "[audio_core]") {
+    AudioCore::DriftResampler resampler;
+    resampler.SetOutputSampleRate(AudioCore::native_sample_rate);
+    resampler.Clear();
+
+    // Nothing is ever produced, so the resampler keeps waiting for the FIFO to refill.
+    for (std::size_t i = 0; i < 1000; ++i) {
+        REQUIRE(resampler.Update(0, 640, 256) == 0);
+    }
+    REQUIRE(resampler.IsStarved());
+}
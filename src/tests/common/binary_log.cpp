@@ -0,0 +1,118 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/log.h"
+
+namespace Log {
+
+static std::string GetTestPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static bool Decode(const std::string& path, std::vector<Entry>& entries) {
+    entries.clear();
+    return DecodeBinaryLog(path,
+                           [&entries](const Entry& entry) { entries.emplace_back() = entry; });
+}
+
+TEST_CASE("BinaryLog round trip", "[common]") {
+    const std::string path = GetTestPath("citra_binary_log_test.cblg");
+    Filter filter(Level::Critical);
+    filter.SetClassLevel(Class::Common, Level::Trace);
+
+    REQUIRE(StartBinaryLog(path, filter));
+    LOG_TRACE(Common, "value {} {:08X} {}", 42, 0xABCDu, "text");
+    LOG_TRACE(Service, "filtered out");
+    LOG_TRACE(Common, "{}", std::string(BinaryArgs::MAX_SIZE * 2, 'a'));
+    StopBinaryLog();
+
+    std::vector<Entry> entries;
+    REQUIRE(Decode(path, entries));
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].log_class == Class::Common);
+    REQUIRE(entries[0].log_level == Level::Trace);
+    REQUIRE(entries[0].message == "value 42 0000ABCD text");
+
+    // Strings are truncated so that the arguments fit in a record
+    REQUIRE(entries[1].message == std::string(BinaryArgs::MAX_SIZE - 3, 'a'));
+
+    // A file cut in the middle of a record is rejected
+    std::string data;
+    FileUtil::ReadFileToString(false, path, data);
+    data.pop_back();
+    FileUtil::WriteStringToFile(false, path, data);
+    REQUIRE(!Decode(path, entries));
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("BinaryLog counts dropped messages", "[common]") {
+    const std::string path = GetTestPath("citra_binary_log_dropped_test.cblg");
+    Filter filter(Level::Critical);
+    filter.SetClassLevel(Class::Common, Level::Trace);
+
+    // A new thread starts with an empty ring and no dropped messages
+    constexpr u64 num_messages = 20000;
+    REQUIRE(StartBinaryLog(path, filter));
+    std::thread([] {
+        const std::string payload(400, 'b');
+        for (u64 i = 0; i < num_messages; ++i) {
+            LOG_TRACE(Common, "burst {}", payload);
+        }
+    }).join();
+    StopBinaryLog();
+
+    std::vector<Entry> entries;
+    REQUIRE(Decode(path, entries));
+    u64 received = 0;
+    u64 dropped = 0;
+    for (const Entry& entry : entries) {
+        if (entry.log_class == Class::Log) {
+            dropped = std::stoull(entry.message);
+        } else if (entry.message.starts_with("burst ")) {
+            ++received;
+        }
+    }
+    REQUIRE(received + dropped == num_messages);
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("BinaryLog decodes dropped records", "[common]") {
+    const std::string path = GetTestPath("citra_binary_log_record_test.cblg");
+
+    // Header (magic and version), then a dropped record (type, thread ID and count)
+    std::string data{"CBLG"};
+    const auto append = [&data](const auto& value) {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    append(u32{1});
+    append(u8{2});
+    append(u32{7});
+    append(u64{3});
+    FileUtil::WriteStringToFile(false, path, data);
+
+    std::vector<Entry> entries;
+    REQUIRE(Decode(path, entries));
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].log_level == Level::Warning);
+    REQUIRE(entries[0].message == "3 messages of thread 7 were dropped so far");
+
+    // A record of an unknown type is rejected
+    append(u8{0xFF});
+    FileUtil::WriteStringToFile(false, path, data);
+    REQUIRE(!Decode(path, entries));
+
+    FileUtil::Delete(path);
+}
+
+} // namespace Log
@@ -0,0 +1,58 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_queue_list.h"
+
+namespace Common {
+
+struct TestThread : ThreadQueueListNode<TestThread> {};
+
+TEST_CASE("ThreadQueueList", "[common]") {
+    ThreadQueueList<TestThread, 64> queue;
+    TestThread a, b, c;
+
+    REQUIRE(queue.get_first() == nullptr);
+    REQUIRE(queue.pop_first() == nullptr);
+
+    queue.push_back(40, &a);
+    queue.push_back(40, &b);
+    queue.push_front(63, &c);
+    REQUIRE(queue.contains(&b) == 40);
+    REQUIRE(queue.get_first() == &a);
+
+    SECTION("pops in priority order") {
+        REQUIRE(queue.pop_first() == &a);
+        REQUIRE(queue.pop_first() == &b);
+        REQUIRE(queue.empty(40));
+        REQUIRE(queue.pop_first() == &c);
+        REQUIRE(queue.pop_first() == nullptr);
+    }
+
+    SECTION("only pops better priorities") {
+        REQUIRE(queue.pop_first_better(40) == nullptr);
+        REQUIRE(queue.pop_first_better(41) == &a);
+    }
+
+    SECTION("rotates and moves threads") {
+        queue.rotate(40);
+        REQUIRE(queue.get_first() == &b);
+
+        queue.move(&c, 63, 0);
+        REQUIRE(queue.pop_first() == &c);
+        REQUIRE(queue.empty(63));
+    }
+
+    SECTION("ignores threads that aren't queued at the priority") {
+        queue.remove(63, &a);
+        REQUIRE(queue.contains(&a) == 40);
+
+        queue.remove(40, &a);
+        REQUIRE(queue.contains(&a) == static_cast<unsigned int>(-1));
+        queue.remove(40, &a);
+        REQUIRE(queue.get_first() == &b);
+    }
+}
+
+} // namespace Common
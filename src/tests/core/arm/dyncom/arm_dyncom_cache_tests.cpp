@@ -0,0 +1,75 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "core/arm/dyncom/arm_dyncom_cache.h"
+
+namespace ArmTests {
+
+namespace {
+/// Adds a block translated from [pc, end_pc) that takes size bytes of instructions
+std::size_t AddBlock(TranslationCache& cache, u32 pc, u32 end_pc, std::size_t size = 64) {
+    const std::size_t offset = cache.BeginBlock(pc);
+    AllocTranslationBuffer(size);
+    cache.EndBlock(end_pc);
+    return offset;
+}
+} // Anonymous namespace
+
+TEST_CASE("ARM_DynCom (cache): Find", "[arm_dyncom]") {
+    TranslationCache cache;
+    REQUIRE(!cache.Find(0x1000));
+
+    const std::size_t offset = AddBlock(cache, 0x1000, 0x1010);
+    REQUIRE(cache.Find(0x1000) == offset);
+    REQUIRE(cache.GetBlock(offset).pc == 0x1000);
+    REQUIRE(cache.GetBlock(offset).end_pc == 0x1010);
+    REQUIRE(!cache.Find(0x1004));
+
+    const u32 generation = cache.GetGeneration();
+    cache.Clear();
+    REQUIRE(!cache.Find(0x1000));
+    REQUIRE(cache.GetGeneration() != generation);
+}
+
+TEST_CASE("ARM_DynCom (cache): Invalidate", "[arm_dyncom]") {
+    TranslationCache cache;
+    AddBlock(cache, 0x1000, 0x1010);
+    AddBlock(cache, 0x1ff0, 0x2002); // Straddles into the next page
+    AddBlock(cache, 0x3000, 0x3010);
+
+    const u32 generation = cache.GetGeneration();
+    cache.Invalidate(0x5000, 0x1000);
+    REQUIRE(cache.NumBlocks() == 3);
+    REQUIRE(cache.GetGeneration() == generation);
+
+    cache.Invalidate(0x2000, 4);
+    REQUIRE(cache.Find(0x1000));
+    REQUIRE(!cache.Find(0x1ff0));
+    REQUIRE(cache.Find(0x3000));
+    REQUIRE(cache.GetGeneration() != generation);
+
+    cache.Invalidate(0x1000, 0x3000);
+    REQUIRE(cache.NumBlocks() == 0);
+}
+
+TEST_CASE("ARM_DynCom (cache): Eviction", "[arm_dyncom]") {
+    TranslationCache cache;
+    constexpr std::size_t block_size = TranslationCache::MAX_BLOCK_SIZE / 2;
+    constexpr u32 num_blocks = TranslationCache::BUFFER_SIZE / block_size * 3;
+
+    for (u32 i = 0; i < num_blocks; ++i) {
+        const std::size_t offset = AddBlock(cache, i * 0x1000, i * 0x1000 + 0x10, block_size);
+        REQUIRE(offset + TranslationCache::MAX_BLOCK_SIZE <= TranslationCache::BUFFER_SIZE);
+    }
+
+    // The most recent blocks are kept, the oldest ones were evicted
+    REQUIRE(cache.NumBlocks() < num_blocks);
+    REQUIRE(cache.NumBlocks() > TranslationCache::BUFFER_SIZE / block_size / 2);
+    REQUIRE(!cache.Find(0));
+    REQUIRE(cache.Find((num_blocks - 1) * 0x1000));
+    REQUIRE(cache.Find((num_blocks - 2) * 0x1000));
+}
+
+} // namespace ArmTests
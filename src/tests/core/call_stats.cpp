@@ -0,0 +1,55 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "core/call_stats.h"
+
+TEST_CASE("CallStats::DumpJson", "[core]") {
+    Core::CallStats stats;
+    REQUIRE(stats.DumpJson() == "{\"frames\":0,\"svcs\":[],\"services\":[]}");
+
+    stats.RecordSVC(0x24, "WaitSynchronization1", 3);
+    stats.RecordSVC(0x24, "WaitSynchronization1", 5);
+    stats.EndFrame();
+
+    const std::string json = stats.DumpJson();
+    REQUIRE(json.find("\"frames\":1") != std::string::npos);
+    // 3 ns falls in bucket 2 ([2, 4) ns) and 5 ns in bucket 3 ([4, 8) ns)
+    REQUIRE(json.find("\"number\":36,\"name\":\"WaitSynchronization1\",\"calls\":2,"
+                      "\"total_ns\":8,\"max_ns\":5,\"last_frame_calls\":2,"
+                      "\"last_frame_ns\":8,\"histogram\":[0,0,1,1,0") != std::string::npos);
+}
+
+TEST_CASE("CallStats::RegisterServiceCommand", "[core]") {
+    Core::CallStats stats;
+    const int service = 0;
+    Core::CallCounters& counters =
+        stats.RegisterServiceCommand(&service, "fs:USER", 0x080201C2, "OpenFile");
+    stats.RegisterServiceCommand(&service, "fs:USER", 0x08030204, "OpenFileDirectly");
+    counters.Add(100);
+    counters.Add(300);
+    stats.EndFrame();
+    counters.Add(50);
+
+    const std::string json = stats.DumpJson();
+    REQUIRE(json.find("\"service\":\"fs:USER\",\"header\":\"0x080201c2\",\"function\":"
+                      "\"OpenFile\",\"calls\":3,\"total_ns\":450,\"max_ns\":300,"
+                      "\"last_frame_calls\":2,\"last_frame_ns\":400") != std::string::npos);
+
+    // Commands that weren't called are left out
+    REQUIRE(json.find("OpenFileDirectly") == std::string::npos);
+
+    stats.Reset();
+    REQUIRE(stats.DumpJson() == "{\"frames\":0,\"svcs\":[],\"services\":[]}");
+
+    // Registering the command again returns the same counters
+    REQUIRE(&stats.RegisterServiceCommand(&service, "fs:USER", 0x080201C2, "OpenFile") ==
+            &counters);
+    counters.Add(10);
+
+    // A service registered again after being destroyed starts from new counters
+    stats.UnregisterService(&service);
+    stats.RegisterServiceCommand(&service, "fs:USER", 0x080201C2, "OpenFile").Add(20);
+    REQUIRE(stats.DumpJson().find("\"calls\":1,\"total_ns\":20,") != std::string::npos);
+}
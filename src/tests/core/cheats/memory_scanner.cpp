@@ -0,0 +1,76 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <catch2/catch_test_macros.hpp>
+#include "core/cheats/memory_scanner.h"
+#include "core/memory.h"
+
+namespace {
+template <typename T>
+void WriteValue(Memory::MemorySystem& memory, PAddr address, T value) {
+    std::memcpy(memory.GetPhysicalPointer(address), &value, sizeof(T));
+}
+
+template <typename T>
+u64 ToBits(T value) {
+    u64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+} // Anonymous namespace
+
+TEST_CASE("MemoryScanner: Value comparisons", "[core][cheats]") {
+    Memory::MemorySystem memory;
+    Cheats::MemoryScanner scanner(memory);
+    WriteValue<u32>(memory, Memory::FCRAM_PADDR + 0x100, 1234);
+    WriteValue<u32>(memory, Memory::VRAM_PADDR + 0x40, 1234);
+
+    REQUIRE(scanner.NewScan(Cheats::ScanValueType::U32) > 0);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Equal, 1234) == 2);
+
+    const auto results = scanner.GetResults(0, 10);
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[0].address == Memory::FCRAM_PADDR + 0x100);
+    REQUIRE(results[0].value == 1234);
+    REQUIRE(results[1].address == Memory::VRAM_PADDR + 0x40);
+    REQUIRE(scanner.GetResults(1, 10).size() == 1);
+
+    WriteValue<u32>(memory, Memory::FCRAM_PADDR + 0x100, 1240);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::IncreasedBy, 6) == 1);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Unchanged, 0) == 1);
+    REQUIRE(scanner.GetResults(0, 10)[0].value == 1240);
+
+    scanner.Reset();
+    REQUIRE(!scanner.IsSearching());
+    REQUIRE(scanner.NumResults() == 0);
+}
+
+TEST_CASE("MemoryScanner: Unknown initial value", "[core][cheats]") {
+    Memory::MemorySystem memory;
+    Cheats::MemoryScanner scanner(memory);
+
+    const u64 num_candidates = scanner.NewScan(Cheats::ScanValueType::U8);
+    REQUIRE(num_candidates >= Memory::FCRAM_SIZE + Memory::VRAM_SIZE);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Unchanged, 0) == num_candidates);
+
+    WriteValue<u8>(memory, Memory::FCRAM_PADDR + 0x12345, 7);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Changed, 0) == 1);
+    REQUIRE(scanner.GetResults(0, 1)[0].address == Memory::FCRAM_PADDR + 0x12345);
+}
+
+TEST_CASE("MemoryScanner: Floating point values", "[core][cheats]") {
+    Memory::MemorySystem memory;
+    Cheats::MemoryScanner scanner(memory);
+    WriteValue<float>(memory, Memory::FCRAM_PADDR + 0x2000, 2.5f);
+
+    scanner.NewScan(Cheats::ScanValueType::Float);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Greater, ToBits(2.0f)) == 1);
+
+    WriteValue<double>(memory, Memory::FCRAM_PADDR + 0x3008, 10.0);
+    scanner.NewScan(Cheats::ScanValueType::Double);
+    WriteValue<double>(memory, Memory::FCRAM_PADDR + 0x3008, 9.0);
+    REQUIRE(scanner.Scan(Cheats::ScanComparison::Decreased, 0) == 1);
+    REQUIRE(scanner.GetResults(0, 1)[0].address == Memory::FCRAM_PADDR + 0x3008);
+}
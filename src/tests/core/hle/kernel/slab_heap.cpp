@@ -0,0 +1,91 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/slab_heap.h"
+
+namespace Kernel {
+
+static SlabHeapStats GetEventHeapStats() {
+    const auto stats = GetSlabHeapStats();
+    const auto itr = std::find_if(stats.begin(), stats.end(), [](const SlabHeapStats& heap) {
+        return heap.type == HandleType::Event;
+    });
+    REQUIRE(itr != stats.end());
+    return *itr;
+}
+
+TEST_CASE("SlabHeap", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+
+    auto event = kernel.CreateEvent(ResetType::OneShot, "first");
+    const SlabHeapStats before = GetEventHeapStats();
+    REQUIRE(before.in_use >= 1);
+    REQUIRE(before.capacity >= before.in_use);
+
+    SECTION("recycles the slots of destroyed objects") {
+        const void* address = event.get();
+        event.reset();
+        REQUIRE(GetEventHeapStats().in_use == before.in_use - 1);
+
+        event = kernel.CreateEvent(ResetType::OneShot, "second");
+        REQUIRE(event.get() == address);
+        REQUIRE(event->GetName() == "second");
+
+        const SlabHeapStats after = GetEventHeapStats();
+        REQUIRE(after.in_use == before.in_use);
+        REQUIRE(after.capacity == before.capacity);
+        REQUIRE(after.total_allocations == before.total_allocations + 1);
+    }
+
+    SECTION("grows when all slots are used") {
+        std::vector<std::shared_ptr<Event>> events;
+        for (std::size_t i = 0; i <= before.capacity; ++i) {
+            events.push_back(kernel.CreateEvent(ResetType::OneShot));
+        }
+
+        const SlabHeapStats after = GetEventHeapStats();
+        REQUIRE(after.capacity > before.capacity);
+        REQUIRE(after.peak_in_use >= before.in_use + events.size());
+    }
+}
+
+TEST_CASE("Kernel object create/close throughput", "[!benchmark][core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    BENCHMARK("Create and close an event") {
+        const Handle handle =
+            process->handle_table.Create(kernel.CreateEvent(ResetType::OneShot)).Unwrap();
+        return process->handle_table.Close(handle);
+    };
+
+    BENCHMARK("Create and close 256 events") {
+        std::array<Handle, 256> handles;
+        for (Handle& handle : handles) {
+            handle = process->handle_table.Create(kernel.CreateEvent(ResetType::OneShot)).Unwrap();
+        }
+        for (const Handle handle : handles) {
+            process->handle_table.Close(handle);
+        }
+        return handles[0];
+    };
+}
+
+} // namespace Kernel
@@ -0,0 +1,157 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/service/service.h"
+
+namespace Service {
+
+class TestService final : public ServiceFramework<TestService> {
+public:
+    TestService() : ServiceFramework("test", 1) {
+        static const FunctionInfo functions[] = {
+            {IPC::MakeHeader(0x0001, 1, 0), &TestService::Increment, "Increment"},
+            {IPC::MakeHeader(0x0002, 1, 0), &TestService::Decrement, "Decrement"},
+            // Shares its command id with Decrement, so it can't be directly indexed
+            {IPC::MakeHeader(0x0002, 2, 0), &TestService::Increment, "IncrementAlias"},
+            {IPC::MakeHeader(0x1001, 1, 0), &TestService::Decrement, "DecrementHigh"},
+        };
+        RegisterHandlers(functions);
+    }
+
+private:
+    void Increment(Kernel::HLERequestContext& ctx) {
+        IPC::RequestParser rp(ctx);
+        const u32 value = rp.Pop<u32>();
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(value + 1);
+    }
+
+    void Decrement(Kernel::HLERequestContext& ctx) {
+        IPC::RequestParser rp(ctx);
+        const u32 value = rp.Pop<u32>();
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(value - 1);
+    }
+};
+
+TEST_CASE("ServiceFrameworkBase::HandleSyncRequest", "[core][service]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    Kernel::HLERequestContext context(kernel, std::move(server), nullptr);
+    TestService service;
+
+    auto* cmd_buf = context.CommandBuffer();
+
+    SECTION("dispatches directly indexed handlers") {
+        cmd_buf[0] = IPC::MakeHeader(0x0001, 1, 0);
+        cmd_buf[1] = 41;
+        service.HandleSyncRequest(context);
+        REQUIRE(cmd_buf[0] == IPC::MakeHeader(0x0001, 2, 0));
+        REQUIRE(cmd_buf[2] == 42);
+
+        cmd_buf[0] = IPC::MakeHeader(0x1001, 1, 0);
+        cmd_buf[1] = 41;
+        service.HandleSyncRequest(context);
+        REQUIRE(cmd_buf[2] == 40);
+    }
+
+    SECTION("dispatches handlers sharing a command id") {
+        cmd_buf[0] = IPC::MakeHeader(0x0002, 1, 0);
+        cmd_buf[1] = 41;
+        service.HandleSyncRequest(context);
+        REQUIRE(cmd_buf[2] == 40);
+
+        cmd_buf[0] = IPC::MakeHeader(0x0002, 2, 0);
+        cmd_buf[1] = 41;
+        cmd_buf[2] = 0;
+        service.HandleSyncRequest(context);
+        REQUIRE(cmd_buf[2] == 42);
+    }
+
+    SECTION("reports unregistered headers") {
+        cmd_buf[0] = IPC::MakeHeader(0x0004, 1, 0);
+        cmd_buf[1] = 41;
+        service.HandleSyncRequest(context);
+        REQUIRE(cmd_buf[0] == IPC::MakeHeader(0x0004, 1, 0));
+        REQUIRE(cmd_buf[1] == 0);
+    }
+}
+
+TEST_CASE("HLERequestContext::Reset", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    Kernel::HLERequestContext context(kernel, server, nullptr);
+
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto event = kernel.CreateEvent(Kernel::ResetType::OneShot);
+    const Kernel::Handle handle = process->handle_table.Create(event).Unwrap();
+    const u32_le input[]{
+        IPC::MakeHeader(0x0001, 0, 2),
+        IPC::CopyHandleDesc(1),
+        handle,
+    };
+    context.PopulateFromIncomingCommandBuffer(input, process);
+    REQUIRE(context.GetIncomingHandle(context.CommandBuffer()[2]) == event);
+
+    context.Reset(nullptr, nullptr);
+
+    REQUIRE(context.Session() == nullptr);
+    REQUIRE(context.CommandBuffer()[0] == 0);
+    REQUIRE(context.AddOutgoingHandle(event) == 0);
+}
+
+TEST_CASE("HLE IPC round trip", "[!benchmark][core][service]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto [server, client] = kernel.CreateSessionPair();
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    TestService service;
+
+    const u32_le request[]{
+        IPC::MakeHeader(0x0001, 1, 0),
+        41,
+    };
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH> response;
+
+    BENCHMARK("Allocating a context per request") {
+        auto context = std::make_shared<Kernel::HLERequestContext>(kernel, server, nullptr);
+        context->PopulateFromIncomingCommandBuffer(request, process);
+        service.HandleSyncRequest(*context);
+        context->WriteToOutgoingCommandBuffer(response.data(), *process);
+        return response[2];
+    };
+
+    auto recycled_context = std::make_shared<Kernel::HLERequestContext>(kernel, server, nullptr);
+    BENCHMARK("Recycling the context") {
+        recycled_context->Reset(server, nullptr);
+        recycled_context->PopulateFromIncomingCommandBuffer(request, process);
+        service.HandleSyncRequest(*recycled_context);
+        recycled_context->WriteToOutgoingCommandBuffer(response.data(), *process);
+        return response[2];
+    };
+}
+
+} // namespace Service
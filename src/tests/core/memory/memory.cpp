@@ -52,3 +52,138 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.Watch", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.MapSharedPages(process->vm_manager);
+
+    auto& page_table = *process->vm_manager.page_table;
+    const std::size_t page = Memory::SHARED_PAGE_VADDR >> Memory::CITRA_PAGE_BITS;
+    const Memory::WatchRange range{Memory::SHARED_PAGE_VADDR + 0x10, 4, true, true};
+
+    SECTION("watched pages have no pointer but stay accessible") {
+        u32 before = 0;
+        memory.ReadBlock(*process, Memory::SHARED_PAGE_VADDR + 0x10, &before, sizeof(before));
+
+        memory.AddWatch(page_table, range);
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+        CHECK(page_table.GetPointerArray()[page] == nullptr);
+        CHECK(page_table.attributes[page + 1] != Memory::PageType::Watched);
+        CHECK(memory.IsValidVirtualAddress(*process, Memory::SHARED_PAGE_VADDR));
+
+        u32 after = 0;
+        memory.ReadBlock(*process, Memory::SHARED_PAGE_VADDR + 0x10, &after, sizeof(after));
+        CHECK(after == before);
+
+        memory.RemoveWatch(page_table, range);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+        CHECK(page_table.GetPointerArray()[page] != nullptr);
+    }
+
+    SECTION("a watched range stays watched when it is mapped again") {
+        memory.AddWatch(page_table, range);
+        const MemoryRef backing = page_table.pointers.GetRef(page);
+
+        process->vm_manager.UnmapRange(Memory::SHARED_PAGE_VADDR, Memory::SHARED_PAGE_SIZE);
+        CHECK(page_table.attributes[page] == Memory::PageType::Unmapped);
+
+        process->vm_manager
+            .MapBackingMemory(Memory::SHARED_PAGE_VADDR, backing, Memory::SHARED_PAGE_SIZE,
+                              Kernel::MemoryState::Shared)
+            .Unwrap();
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+        CHECK(page_table.GetPointerArray()[page] == nullptr);
+
+        memory.ClearWatches(page_table);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+    }
+
+    SECTION("accesses to a watch range are recorded") {
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+        memory.AddWatch(page_table, range);
+
+        memory.Write32(Memory::SHARED_PAGE_VADDR + 0x10, 0x12345678);
+        CHECK(memory.Read16(Memory::SHARED_PAGE_VADDR + 0x12) == 0x1234);
+        // Accesses to the same page outside of the range aren't recorded
+        memory.Read32(Memory::SHARED_PAGE_VADDR + 0x20);
+        memory.Read8(Memory::SHARED_PAGE_VADDR + 0x0F);
+
+        const auto hits = memory.PopWatchHits(16);
+        REQUIRE(hits.size() == 2);
+        CHECK(hits[0].address == Memory::SHARED_PAGE_VADDR + 0x10);
+        CHECK(hits[0].size == 4);
+        CHECK(hits[0].write);
+        CHECK(hits[0].value == 0x12345678);
+        CHECK(hits[1].address == Memory::SHARED_PAGE_VADDR + 0x12);
+        CHECK(hits[1].size == 2);
+        CHECK_FALSE(hits[1].write);
+        CHECK(hits[1].value == 0x1234);
+
+        // Read-only watches don't record writes
+        memory.RemoveWatch(page_table, range);
+        memory.AddWatch(page_table, {range.start, range.size, true, false});
+        memory.Write8(Memory::SHARED_PAGE_VADDR + 0x10, 1);
+        CHECK(memory.PopWatchHits(16).empty());
+    }
+
+    SECTION("watch hits are dropped when the ring buffer is full and wrap around") {
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+        memory.AddWatch(page_table, range);
+
+        const u64 dropped = memory.GetDroppedWatchHits();
+        for (std::size_t i = 0; i < Memory::WATCH_HIT_BUFFER_SIZE + 3; ++i) {
+            memory.Write32(Memory::SHARED_PAGE_VADDR + 0x10, static_cast<u32>(i));
+        }
+        CHECK(memory.GetDroppedWatchHits() == dropped + 3);
+
+        // The oldest hits are kept
+        auto hits = memory.PopWatchHits(Memory::WATCH_HIT_BUFFER_SIZE - 1);
+        REQUIRE(hits.size() == Memory::WATCH_HIT_BUFFER_SIZE - 1);
+        CHECK(hits.front().value == 0);
+        CHECK(hits.back().value == Memory::WATCH_HIT_BUFFER_SIZE - 2);
+
+        // New hits wrap around the end of the ring buffer
+        memory.Write32(Memory::SHARED_PAGE_VADDR + 0x10, 0xCAFE);
+        hits = memory.PopWatchHits(16);
+        REQUIRE(hits.size() == 2);
+        CHECK(hits[0].value == Memory::WATCH_HIT_BUFFER_SIZE - 1);
+        CHECK(hits[1].value == 0xCAFE);
+    }
+
+    SECTION("queued watch changes are applied by the emulation thread") {
+        memory.QueueWatchChange(process->vm_manager.page_table, range, true);
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+
+        memory.ApplyQueuedWatchChanges();
+        CHECK(page_table.attributes[page] == Memory::PageType::Watched);
+
+        memory.QueueWatchChange(process->vm_manager.page_table, range, false);
+        memory.ApplyQueuedWatchChanges();
+        CHECK(page_table.attributes[page] == Memory::PageType::Memory);
+        CHECK(page_table.GetPointerArray()[page] != nullptr);
+    }
+
+    SECTION("watched pages stay watched while the rasterizer caches them") {
+        kernel.HandleSpecialMapping(process->vm_manager,
+                                    {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+        const std::size_t vram_page = Memory::VRAM_VADDR >> Memory::CITRA_PAGE_BITS;
+        const Memory::WatchRange vram_range{Memory::VRAM_VADDR, 4, true, true};
+        memory.AddWatch(page_table, vram_range);
+
+        memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, 4, true);
+        CHECK(page_table.attributes[vram_page] == Memory::PageType::Watched);
+        CHECK(page_table.GetPointerArray()[vram_page] == nullptr);
+
+        memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, 4, false);
+        CHECK(page_table.attributes[vram_page] == Memory::PageType::Watched);
+        CHECK(page_table.GetPointerArray()[vram_page] == nullptr);
+
+        memory.RemoveWatch(page_table, vram_range);
+        CHECK(page_table.attributes[vram_page] == Memory::PageType::Memory);
+        CHECK(page_table.GetPointerArray()[vram_page] != nullptr);
+    }
+}
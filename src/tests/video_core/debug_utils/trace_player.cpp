@@ -0,0 +1,111 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/memory.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/trace_player.h"
+#include "video_core/regs.h"
+
+TEST_CASE("CiTrace::Player loads recorded traces", "[video_core]") {
+    CiTrace::Recorder::InitialState state;
+    state.pica_registers.assign(Pica::Regs::NUM_REGS, 0);
+    state.vs_float_uniforms.assign(96 * 4, 0);
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "citra_trace_player_test.ctf").string();
+    CiTrace::Recorder recorder(state, path);
+    const std::array<u8, 4> data{1, 2, 3, 4};
+    recorder.MemoryAccessed(data.data(), static_cast<u32>(data.size()), Memory::VRAM_PADDR);
+    recorder.RegisterWritten<u32>(0x10400010, 0x1234);
+    recorder.FrameFinished();
+    recorder.MemoryAccessed(data.data(), static_cast<u32>(data.size()), Memory::VRAM_PADDR + 4);
+    recorder.FrameFinished();
+    recorder.RegisterWritten<u32>(0x10400014, 0x5678);
+    recorder.Finish();
+
+    CiTrace::Player player;
+    const bool loaded = player.Load(path);
+    FileUtil::Delete(path);
+    REQUIRE(loaded);
+
+    const auto& stream = player.GetStream();
+    REQUIRE(stream.size() == 6);
+    REQUIRE(stream[0].type == CiTrace::MemoryLoad);
+    REQUIRE(stream[1].type == CiTrace::RegisterWrite);
+    REQUIRE(stream[1].register_write.value == 0x1234);
+
+    // Elements after the last frame marker make up a last frame
+    const auto& frames = player.GetFrames();
+    REQUIRE(frames.size() == 3);
+    REQUIRE(frames[0] == CiTrace::Player::FrameRange{0, 3});
+    REQUIRE(frames[1] == CiTrace::Player::FrameRange{3, 5});
+    REQUIRE(frames[2] == CiTrace::Player::FrameRange{5, 6});
+
+    // Both loads share the recorded data
+    Memory::MemorySystem memory;
+    player.ReplayElement(stream[0], memory);
+    player.ReplayElement(stream[3], memory);
+    REQUIRE(std::memcmp(memory.GetPhysicalPointer(Memory::VRAM_PADDR), data.data(), 4) == 0);
+    REQUIRE(std::memcmp(memory.GetPhysicalPointer(Memory::VRAM_PADDR + 4), data.data(), 4) == 0);
+}
+
+TEST_CASE("CiTrace::Player rejects invalid traces", "[video_core]") {
+    CiTrace::Player player;
+    REQUIRE(!player.Load(std::vector<u8>{'C', 'i', 'T', 'r'}));
+
+    std::vector<u8> data(sizeof(CiTrace::CTHeader));
+    REQUIRE(!player.Load(data));
+
+    CiTrace::CTHeader header{};
+    std::memcpy(header.magic, CiTrace::CTHeader::ExpectedMagicWord(), 4);
+    header.version = CiTrace::CTHeader::ExpectedVersion();
+    header.header_size = sizeof(header);
+    header.stream_offset = sizeof(header);
+    header.stream_size = 1;
+    std::memcpy(data.data(), &header, sizeof(header));
+    REQUIRE(!player.Load(data));
+
+    header.stream_size = 0;
+    std::memcpy(data.data(), &header, sizeof(header));
+    REQUIRE(player.Load(data));
+    REQUIRE(player.GetFrames().empty());
+}
+
+TEST_CASE("CiTrace::Player loads uncompressed version 1 traces", "[video_core]") {
+    const std::array<u8, 4> memory_data{5, 6, 7, 8};
+
+    CiTrace::CTHeader header{};
+    std::memcpy(header.magic, CiTrace::CTHeader::ExpectedMagicWord(), 4);
+    header.version = 1;
+    header.header_size = sizeof(header);
+    header.stream_offset = static_cast<u32>(sizeof(header) + memory_data.size());
+    header.stream_size = 2;
+
+    std::array<CiTrace::CTStreamElement, 2> stream{};
+    stream[0].type = CiTrace::MemoryLoad;
+    stream[0].memory_load.file_offset = sizeof(header);
+    stream[0].memory_load.size = static_cast<u32>(memory_data.size());
+    stream[0].memory_load.physical_address = Memory::VRAM_PADDR;
+    stream[1].type = CiTrace::FrameMarker;
+
+    std::vector<u8> data(sizeof(header));
+    std::memcpy(data.data(), &header, sizeof(header));
+    data.insert(data.end(), memory_data.begin(), memory_data.end());
+    const auto* stream_bytes = reinterpret_cast<const u8*>(stream.data());
+    data.insert(data.end(), stream_bytes, stream_bytes + sizeof(stream));
+
+    CiTrace::Player player;
+    REQUIRE(player.Load(data));
+    REQUIRE(player.GetFrames().size() == 1);
+
+    Memory::MemorySystem memory;
+    player.ReplayElement(player.GetStream()[0], memory);
+    REQUIRE(std::memcmp(memory.GetPhysicalPointer(Memory::VRAM_PADDR), memory_data.data(), 4) ==
+            0);
+}
@@ -0,0 +1,321 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/frontend/emu_window.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/perf_stats.h"
+#include "video_core/debug_utils/trace_player.h"
+#include "video_core/pica.h"
+#include "video_core/renderer_base.h"
+#include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <filename>\n"
+                 "Replays a CiTrace with the software rasterizer and reports its timings\n"
+                 "-n, --iterations=N      Replay the trace N times (default 1)\n"
+                 "-j, --shader-jit        Run the shaders with the JIT instead of the interpreter\n"
+                 "-s, --hash              Hash the displayed framebuffers after every frame\n"
+                 "-e, --expect-hash=HASH  Fail unless the hash of the last frame is HASH\n"
+                 "-c, --csv=FILE          Write the results of every frame to FILE\n"
+                 "-h, --help              Display this help and exit\n"
+                 "-v, --version           Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
+}
+
+namespace {
+
+/// Window that is never shown, the benchmark doesn't present anything
+class HeadlessWindow final : public Frontend::EmuWindow {
+public:
+    void PollEvents() override {}
+};
+
+/// Renderer that rasterizes with the software rasterizer and doesn't present frames
+class HeadlessRenderer final : public RendererBase {
+public:
+    explicit HeadlessRenderer(Frontend::EmuWindow& window) : RendererBase(window, nullptr) {}
+
+    VideoCore::ResultStatus Init() override {
+        return VideoCore::ResultStatus::Success;
+    }
+
+    VideoCore::RasterizerInterface* Rasterizer() override {
+        return &rasterizer;
+    }
+
+    using RendererBase::TryPresent;
+
+    void ShutDown() override {}
+    void SwapBuffers() override {}
+    void TryPresent(int timeout_ms, bool is_secondary) override {}
+    void PrepareVideoDumping() override {}
+    void CleanupVideoDumping() override {}
+    void Sync() override {}
+
+private:
+    VideoCore::SWRasterizer rasterizer;
+};
+
+struct FrameResult {
+    u32 iteration;
+    u32 frame;
+    u64 time_ns;     ///< Host time spent replaying the frame
+    u64 command_ns;  ///< Host time spent processing PICA command lists
+    u64 draw_calls;  ///< Number of draws the PICA command processor processed
+    u64 hash;        ///< Hash of the displayed framebuffers, if requested
+};
+
+/// Returns how much a perf stats counter grew since the previous call
+u64 TakeFrameCounter(Core::FrameCounter counter) {
+    static std::array<u64, static_cast<std::size_t>(Core::FrameCounter::NumCounters)> previous{};
+    const u64 value = Core::GetFrameCounter(counter);
+    return value - std::exchange(previous[static_cast<std::size_t>(counter)], value);
+}
+
+/// Clears the memory the GPU can access, so that every iteration renders the same frames
+void ClearMemory(Memory::MemorySystem& memory) {
+    std::memset(memory.GetPhysicalPointer(Memory::VRAM_PADDR), 0, Memory::VRAM_SIZE);
+    std::memset(memory.GetPhysicalPointer(Memory::FCRAM_PADDR), 0, Memory::FCRAM_SIZE);
+}
+
+/// Hashes the framebuffers the LCDs currently display
+u64 HashFramebuffers(Memory::MemorySystem& memory) {
+    std::size_t hash = 0;
+    for (const auto& config : GPU::g_regs.framebuffer_config) {
+        const PAddr address = config.active_fb == 0 ? config.address_left1 : config.address_left2;
+        const u32 size = config.stride * config.height.Value();
+        if (size == 0 || !memory.IsValidPhysicalAddress(address) ||
+            !memory.IsValidPhysicalAddress(address + size - 1)) {
+            continue;
+        }
+        Common::HashCombine(hash, Common::ComputeHash64(memory.GetPhysicalPointer(address), size));
+    }
+    return hash;
+}
+
+/// Returns the value below which the given fraction of the sorted values lie
+u64 Percentile(const std::vector<u64>& sorted_values, double fraction) {
+    const auto index = static_cast<std::size_t>(fraction * (sorted_values.size() - 1) + 0.5);
+    return sorted_values[index];
+}
+
+void WriteCsv(const std::string& filename, const std::vector<FrameResult>& results) {
+    FileUtil::IOFile file(filename, "w");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Frontend, "Could not open {} for writing", filename);
+        return;
+    }
+    file.WriteString("iteration,frame,time_ns,command_ns,draw_calls,hash\n");
+    for (const FrameResult& result : results) {
+        file.WriteString(fmt::format("{},{},{},{},{},{:016x}\n", result.iteration, result.frame,
+                                     result.time_ns, result.command_ns, result.draw_calls,
+                                     result.hash));
+    }
+}
+
+void PrintSummary(const std::vector<FrameResult>& results) {
+    std::vector<u64> frame_times;
+    u64 total_ns = 0;
+    u64 command_ns = 0;
+    u64 draw_calls = 0;
+    for (const FrameResult& result : results) {
+        frame_times.push_back(result.time_ns);
+        total_ns += result.time_ns;
+        command_ns += result.command_ns;
+        draw_calls += result.draw_calls;
+    }
+    std::sort(frame_times.begin(), frame_times.end());
+
+    const auto ms = [](u64 ns) { return static_cast<double>(ns) / 1000000.0; };
+    const std::size_t num_frames = results.size();
+    fmt::print("Frames replayed: {}\n", num_frames);
+    fmt::print("Frame time (ms): mean {:.3f}, min {:.3f}, median {:.3f}, p99 {:.3f}, "
+               "max {:.3f}\n",
+               ms(total_ns) / static_cast<double>(num_frames), ms(frame_times.front()),
+               ms(Percentile(frame_times, 0.5)), ms(Percentile(frame_times, 0.99)),
+               ms(frame_times.back()));
+    fmt::print("Draw calls: {} ({:.1f} per frame)\n", draw_calls,
+               static_cast<double>(draw_calls) / static_cast<double>(num_frames));
+    if (draw_calls != 0) {
+        fmt::print("Command processing time per draw (us): {:.3f}\n",
+                   static_cast<double>(command_ns) / 1000.0 / static_cast<double>(draw_calls));
+    }
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    u32 iterations = 1;
+    bool use_shader_jit = false;
+    bool hash_frames = false;
+    bool check_hash = false;
+    u64 expected_hash = 0;
+    std::string csv_file;
+    char* endarg;
+
+    int option_index = 0;
+    static struct option long_options[] = {
+        {"iterations", required_argument, 0, 'n'},
+        {"shader-jit", no_argument, 0, 'j'},
+        {"hash", no_argument, 0, 's'},
+        {"expect-hash", required_argument, 0, 'e'},
+        {"csv", required_argument, 0, 'c'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "n:jse:c:hv", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'n':
+                iterations = static_cast<u32>(std::strtoul(optarg, &endarg, 0));
+                break;
+            case 'j':
+                use_shader_jit = true;
+                break;
+            case 's':
+                hash_frames = true;
+                break;
+            case 'e':
+                expected_hash = std::strtoull(optarg, &endarg, 16);
+                check_hash = true;
+                hash_frames = true;
+                break;
+            case 'c':
+                csv_file.assign(optarg);
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            default:
+                PrintHelp(argv[0]);
+                return 1;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (optind + 1 != argc || iterations == 0) {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+    const std::string filename = argv[optind];
+
+    Log::Filter log_filter(Log::Level::Info);
+    Log::SetGlobalFilter(log_filter);
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    CiTrace::Player player;
+    if (!player.Load(filename)) {
+        return 1;
+    }
+    const auto& frames = player.GetFrames();
+    if (frames.empty()) {
+        LOG_ERROR(Frontend, "{} doesn't contain any frame", filename);
+        return 1;
+    }
+
+    // Only the GPU side of the system is set up: no CPU, kernel or services are running, so
+    // nothing but the trace writes to the GPU registers and memory.
+    auto memory = std::make_unique<Memory::MemorySystem>();
+    HeadlessWindow window;
+    VideoCore::g_memory = memory.get();
+    VideoCore::g_shader_jit_enabled = use_shader_jit;
+    VideoCore::g_renderer = std::make_unique<HeadlessRenderer>(window);
+    Pica::Init();
+
+    std::vector<FrameResult> results;
+    results.reserve(static_cast<std::size_t>(iterations) * frames.size());
+    for (u32 iteration = 0; iteration < iterations; ++iteration) {
+        ClearMemory(*memory);
+        GPU::InitRegisters(*memory);
+        LCD::Init();
+        player.ApplyInitialState();
+        TakeFrameCounter(Core::FrameCounter::GpuCommandTime);
+        TakeFrameCounter(Core::FrameCounter::DrawCalls);
+
+        for (std::size_t frame = 0; frame < frames.size(); ++frame) {
+            const auto begin = std::chrono::steady_clock::now();
+            player.ReplayFrame(frames[frame], *memory);
+            const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+            results.push_back({
+                .iteration = iteration,
+                .frame = static_cast<u32>(frame),
+                .time_ns = static_cast<u64>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                .command_ns = TakeFrameCounter(Core::FrameCounter::GpuCommandTime),
+                .draw_calls = TakeFrameCounter(Core::FrameCounter::DrawCalls),
+                .hash = hash_frames ? HashFramebuffers(*memory) : 0,
+            });
+        }
+    }
+
+    Pica::Shutdown();
+    VideoCore::g_renderer.reset();
+
+    PrintSummary(results);
+    if (!csv_file.empty()) {
+        WriteCsv(csv_file, results);
+    }
+
+    if (!hash_frames) {
+        return 0;
+    }
+
+    // Every iteration starts from the same state, so they must all render the same frames
+    bool deterministic = true;
+    for (std::size_t i = frames.size(); i < results.size(); ++i) {
+        if (results[i].hash != results[i % frames.size()].hash) {
+            LOG_ERROR(Frontend, "Frame {} of iteration {} differs from the first iteration",
+                      results[i].frame, results[i].iteration);
+            deterministic = false;
+        }
+    }
+
+    const u64 last_hash = results.back().hash;
+    fmt::print("Last frame hash: {:016x}\n", last_hash);
+    if (check_hash && last_hash != expected_hash) {
+        LOG_ERROR(Frontend, "Expected the last frame hash to be {:016x}", expected_hash);
+        return 1;
+    }
+    return deterministic ? 0 : 1;
+}
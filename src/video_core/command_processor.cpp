@@ -14,9 +14,11 @@
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica_state.h"
 #include "video_core/pica_types.h"
 #include "video_core/primitive_assembly.h"
@@ -113,6 +115,351 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+/**
+ * Returns true when a register write may change the state that the software shaded triangles
+ * queued in the rasterizer have to be drawn with. Those triangles are drawn as one batch when it
+ * happens, so that consecutive draws sharing the same state become a single host draw.
+ */
+static bool ChangesQueuedTrianglesState(u32 id, u32 old_value, u32 new_value) {
+    // Pipeline and shader registers only affect how the vertices are loaded and shaded
+    if (id >= PICA_REG_INDEX(pipeline)) {
+        return false;
+    }
+
+    switch (id) {
+    case PICA_REG_INDEX(trigger_irq):
+    case PICA_REG_INDEX(lighting.lut_data[0]):
+    case PICA_REG_INDEX(lighting.lut_data[1]):
+    case PICA_REG_INDEX(lighting.lut_data[2]):
+    case PICA_REG_INDEX(lighting.lut_data[3]):
+    case PICA_REG_INDEX(lighting.lut_data[4]):
+    case PICA_REG_INDEX(lighting.lut_data[5]):
+    case PICA_REG_INDEX(lighting.lut_data[6]):
+    case PICA_REG_INDEX(lighting.lut_data[7]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[0]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[1]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[2]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[3]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[4]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[5]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[6]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[7]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[0]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[1]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[2]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[3]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[4]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[5]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[6]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[7]):
+        // Data ports write to tables outside of the register file
+        return true;
+    default:
+        return old_value != new_value;
+    }
+}
+
+/// Loads and shades the vertices of a draw on the CPU, queueing its triangles in the rasterizer
+static void DrawSoftwareShaded(bool is_indexed) {
+    const auto& regs = g_state.regs;
+
+    // Processes information about internal vertex attributes to figure out how a vertex is
+    // loaded.
+    // Later, these can be compiled and cached.
+    const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
+    VertexLoader loader(regs.pipeline);
+    Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
+
+    // Load vertices
+    const auto& index_info = regs.pipeline.index_array;
+    const u8* index_address_8 =
+        VideoCore::g_memory->GetPhysicalPointer(base_address + index_info.offset);
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    bool index_u16 = index_info.format != 0;
+
+    if (g_debug_context && g_debug_context->recorder) {
+        for (int i = 0; i < 3; ++i) {
+            const auto texture = regs.texturing.GetTextures()[i];
+            if (!texture.enabled)
+                continue;
+
+            u8* texture_data =
+                VideoCore::g_memory->GetPhysicalPointer(texture.config.GetPhysicalAddress());
+            g_debug_context->recorder->MemoryAccessed(
+                texture_data,
+                Pica::TexturingRegs::NibblesPerPixel(texture.format) * texture.config.width /
+                    2 * texture.config.height,
+                texture.config.GetPhysicalAddress());
+        }
+    }
+
+    DebugUtils::MemoryAccessTracker memory_accesses;
+
+    // Simple circular-replacement vertex cache
+    // The size has been tuned for optimal balance between hit-rate and the cost of lookup
+    const std::size_t VERTEX_CACHE_SIZE = 32;
+    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
+    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
+    std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
+    Shader::AttributeBuffer vs_output;
+
+    unsigned int vertex_cache_pos = 0;
+
+    auto* shader_engine = Shader::GetEngine();
+    Shader::UnitState shader_unit;
+
+    shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+
+    g_state.geometry_pipeline.Reconfigure();
+    g_state.geometry_pipeline.Setup(shader_engine);
+    if (g_state.geometry_pipeline.NeedIndexInput())
+        ASSERT(is_indexed);
+
+    for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+        // Indexed rendering doesn't use the start offset
+        unsigned int vertex =
+            is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                       : (index + regs.pipeline.vertex_offset);
+
+        bool vertex_cache_hit = false;
+
+        if (is_indexed) {
+            if (g_state.geometry_pipeline.NeedIndexInput()) {
+                g_state.geometry_pipeline.SubmitIndex(vertex);
+                continue;
+            }
+
+            if (g_debug_context && Pica::g_debug_context->recorder) {
+                int size = index_u16 ? 2 : 1;
+                memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                          size);
+            }
+
+            for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
+                    vs_output = vertex_cache[i];
+                    vertex_cache_hit = true;
+                    break;
+                }
+            }
+        }
+
+        if (!vertex_cache_hit) {
+            // Initialize data for the current vertex
+            Shader::AttributeBuffer input;
+            loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+
+            // Send to vertex shader
+            if (g_debug_context)
+                g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                         (void*)&input);
+            shader_unit.LoadInput(regs.vs, input);
+            shader_engine->Run(g_state.vs, shader_unit);
+            shader_unit.WriteOutput(regs.vs, vs_output);
+
+            if (is_indexed) {
+                vertex_cache[vertex_cache_pos] = vs_output;
+                vertex_cache_valid[vertex_cache_pos] = true;
+                vertex_cache_ids[vertex_cache_pos] = vertex;
+                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+            }
+        }
+
+        // Send to geometry pipeline
+        g_state.geometry_pipeline.SubmitVertex(vs_output);
+    }
+
+    for (auto& range : memory_accesses.ranges) {
+        g_debug_context->recorder->MemoryAccessed(
+            VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
+    }
+
+    // Triangles are drawn once the drawing state changes, unless debugging
+    if (g_debug_context) {
+        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+        g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
+    }
+}
+
+/**
+ * A hardware shaded triangle list whose submission is held back, so that the following draws that
+ * continue its vertices or indices with the same state are merged into a single host draw.
+ */
+struct PendingDraw {
+    bool active = false;
+    bool is_indexed = false;
+    u32 index_array = 0;
+    u32 num_vertices = 0;
+    u32 vertex_offset = 0;
+};
+
+static PendingDraw pending_draw;
+
+/**
+ * Returns true when a register write may change the state that the pending hardware draw has to
+ * be drawn with. Unlike the queued triangles, the draw isn't shaded yet, so the pipeline and
+ * shader registers matter as well.
+ */
+static bool ChangesPendingDrawState(u32 id, u32 old_value, u32 new_value) {
+    switch (id) {
+    case PICA_REG_INDEX(pipeline.index_array):
+    case PICA_REG_INDEX(pipeline.num_vertices):
+    case PICA_REG_INDEX(pipeline.vertex_offset):
+    case PICA_REG_INDEX(pipeline.trigger_draw):
+    case PICA_REG_INDEX(pipeline.trigger_draw_indexed):
+        // The pending draw keeps its own copy of the ranges, the next trigger decides whether
+        // they can be merged
+        return false;
+    case PICA_REG_INDEX(pipeline.restart_primitive):
+    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.index):
+    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]):
+    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[1]):
+    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[2]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[0]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[1]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[2]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[3]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[4]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[5]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[6]):
+    case PICA_REG_INDEX(gs.uniform_setup.set_value[7]):
+    case PICA_REG_INDEX(gs.program.set_word[0]):
+    case PICA_REG_INDEX(gs.program.set_word[1]):
+    case PICA_REG_INDEX(gs.program.set_word[2]):
+    case PICA_REG_INDEX(gs.program.set_word[3]):
+    case PICA_REG_INDEX(gs.program.set_word[4]):
+    case PICA_REG_INDEX(gs.program.set_word[5]):
+    case PICA_REG_INDEX(gs.program.set_word[6]):
+    case PICA_REG_INDEX(gs.program.set_word[7]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[1]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[2]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[3]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[4]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[5]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[6]):
+    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[7]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[0]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[1]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[2]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[3]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[4]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[5]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[6]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[7]):
+    case PICA_REG_INDEX(vs.program.set_word[0]):
+    case PICA_REG_INDEX(vs.program.set_word[1]):
+    case PICA_REG_INDEX(vs.program.set_word[2]):
+    case PICA_REG_INDEX(vs.program.set_word[3]):
+    case PICA_REG_INDEX(vs.program.set_word[4]):
+    case PICA_REG_INDEX(vs.program.set_word[5]):
+    case PICA_REG_INDEX(vs.program.set_word[6]):
+    case PICA_REG_INDEX(vs.program.set_word[7]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[1]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[2]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[3]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[4]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[5]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[6]):
+    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[7]):
+        // Data ports and triggers act on state outside of the register file
+        return true;
+    default:
+        return id < PICA_REG_INDEX(pipeline) ? ChangesQueuedTrianglesState(id, old_value, new_value)
+                                             : old_value != new_value;
+    }
+}
+
+static void StartPendingDraw(bool is_indexed) {
+    const auto& regs = g_state.regs;
+    pending_draw = {
+        .active = true,
+        .is_indexed = is_indexed,
+        .index_array = regs.reg_array[PICA_REG_INDEX(pipeline.index_array)],
+        .num_vertices = regs.pipeline.num_vertices,
+        .vertex_offset = regs.pipeline.vertex_offset,
+    };
+}
+
+/// Extends the pending draw with the triggered one if its vertices or indices directly follow
+static bool MergeIntoPendingDraw(bool is_indexed) {
+    const auto& pipeline = g_state.regs.pipeline;
+    if (!pending_draw.active || pending_draw.is_indexed != is_indexed) {
+        return false;
+    }
+
+    if (is_indexed) {
+        using IndexOffset = decltype(pipeline.index_array.offset);
+        using IndexFormat = decltype(pipeline.index_array.format);
+        const u32 pending_offset =
+            (pending_draw.index_array & IndexOffset::mask) >> IndexOffset::position;
+        const bool pending_u16 = (pending_draw.index_array & IndexFormat::mask) != 0;
+        const bool index_u16 = pipeline.index_array.format != 0;
+        if (pending_u16 != index_u16 ||
+            pipeline.index_array.offset !=
+                pending_offset + pending_draw.num_vertices * (index_u16 ? 2 : 1)) {
+            return false;
+        }
+    } else if (pipeline.vertex_offset != pending_draw.vertex_offset + pending_draw.num_vertices) {
+        return false;
+    }
+
+    // A merged draw that the rasterizer can't upload would be shaded on the CPU entirely. Indices
+    // may refer to any vertex of their range, so indexed draws are bounded by that range.
+    const u32 num_vertices = pending_draw.num_vertices + pipeline.num_vertices;
+    const bool index_u16 = pipeline.index_array.format != 0;
+    const u32 vertex_range = is_indexed ? (index_u16 ? 0x10000 : 0x100) : num_vertices;
+    std::size_t vertex_size = 0;
+    for (const auto& loader : pipeline.vertex_attributes.attribute_loaders) {
+        if (loader.component_count != 0) {
+            vertex_size += loader.byte_count;
+        }
+    }
+    const std::size_t index_size = is_indexed ? num_vertices * (index_u16 ? 2 : 1) : 0;
+    if (!VideoCore::g_renderer->Rasterizer()->FitsDrawBatch(vertex_size * vertex_range,
+                                                             index_size)) {
+        return false;
+    }
+
+    pending_draw.num_vertices = num_vertices;
+    return true;
+}
+
+/// Draws the pending hardware draw with its merged ranges, on the CPU if the rasterizer refuses it
+static void FlushPendingDraw() {
+    if (!pending_draw.active) {
+        return;
+    }
+    pending_draw.active = false;
+
+    // The ranges of the draws triggered since are restored afterwards
+    auto& reg_array = g_state.regs.reg_array;
+    constexpr std::array range_regs{
+        PICA_REG_INDEX(pipeline.index_array),
+        PICA_REG_INDEX(pipeline.num_vertices),
+        PICA_REG_INDEX(pipeline.vertex_offset),
+    };
+    const std::array pending_values{
+        pending_draw.index_array,
+        pending_draw.num_vertices,
+        pending_draw.vertex_offset,
+    };
+    std::array<u32, range_regs.size()> current_values;
+    for (std::size_t i = 0; i < range_regs.size(); i++) {
+        current_values[i] = reg_array[range_regs[i]];
+        reg_array[range_regs[i]] = pending_values[i];
+    }
+
+    if (!VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(pending_draw.is_indexed)) {
+        DrawSoftwareShaded(pending_draw.is_indexed);
+    }
+
+    for (std::size_t i = 0; i < range_regs.size(); i++) {
+        reg_array[range_regs[i]] = current_values[i];
+    }
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -128,8 +475,17 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     u32 old_value = regs.reg_array[id];
 
     const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    if (pending_draw.active && ChangesPendingDrawState(id, old_value, new_value)) {
+        FlushPendingDraw();
+    }
+
+    if (ChangesQueuedTrianglesState(id, old_value, new_value)) {
+        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+    }
+
+    regs.reg_array[id] = new_value;
 
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
@@ -143,7 +499,11 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        if (VideoCore::g_gpu_thread) {
+            VideoCore::g_gpu_thread->DeferInterrupt(Service::GSP::InterruptId::P3D);
+        } else {
+            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        }
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -241,11 +601,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     g_state.geometry_pipeline.Setup(shader_engine);
                     g_state.geometry_pipeline.SubmitVertex(output);
 
-                    // TODO: If drawing after every immediate mode triangle kills performance,
-                    // change it to flush triangles whenever a drawing config register changes
-                    // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
-                    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+                    // Triangles are drawn once the drawing state changes, unless debugging
                     if (g_debug_context) {
+                        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
                         g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
                                                  nullptr);
                     }
@@ -274,6 +632,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
         MICROPROFILE_SCOPE(GPU_Drawing);
+        Core::AddFrameCounter(Core::FrameCounter::DrawCalls);
 
 #if PICA_LOG_TEV
         DebugUtils::DumpTevStageConfig(regs.GetTevStages());
@@ -303,130 +662,36 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         bool is_indexed = (id == PICA_REG_INDEX(pipeline.trigger_draw_indexed));
 
-        if (accelerate_draw &&
-            VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
-            if (g_debug_context) {
-                g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
-            }
-            break;
-        }
-
-        // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
-        const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
-        VertexLoader loader(regs.pipeline);
-        Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
-
-        // Load vertices
-        const auto& index_info = regs.pipeline.index_array;
-        const u8* index_address_8 =
-            VideoCore::g_memory->GetPhysicalPointer(base_address + index_info.offset);
-        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
-        bool index_u16 = index_info.format != 0;
-
-        if (g_debug_context && g_debug_context->recorder) {
-            for (int i = 0; i < 3; ++i) {
-                const auto texture = regs.texturing.GetTextures()[i];
-                if (!texture.enabled)
-                    continue;
-
-                u8* texture_data =
-                    VideoCore::g_memory->GetPhysicalPointer(texture.config.GetPhysicalAddress());
-                g_debug_context->recorder->MemoryAccessed(
-                    texture_data,
-                    Pica::TexturingRegs::NibblesPerPixel(texture.format) * texture.config.width /
-                        2 * texture.config.height,
-                    texture.config.GetPhysicalAddress());
-            }
-        }
-
-        DebugUtils::MemoryAccessTracker memory_accesses;
-
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const std::size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::AttributeBuffer vs_output;
-
-        unsigned int vertex_cache_pos = 0;
-
-        auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
-
-        shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
-
-        g_state.geometry_pipeline.Reconfigure();
-        g_state.geometry_pipeline.Setup(shader_engine);
-        if (g_state.geometry_pipeline.NeedIndexInput())
-            ASSERT(is_indexed);
-
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
-
-            bool vertex_cache_hit = false;
-
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
-                }
-
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
-                }
-
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
-                    }
+        if (accelerate_draw) {
+            // Queued software shaded triangles have to be drawn before hardware shaded ones
+            VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+
+            // Triangle lists are held back to be merged with the following draws, unless
+            // debugging
+            const auto topology = primitive_assembler.GetTopology();
+            const bool is_list = topology == PipelineRegs::TriangleTopology::Shader ||
+                                 topology == PipelineRegs::TriangleTopology::List;
+            if (is_list && !g_debug_context) {
+                if (!MergeIntoPendingDraw(is_indexed)) {
+                    FlushPendingDraw();
+                    StartPendingDraw(is_indexed);
                 }
+                break;
             }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-
-                // Send to vertex shader
-                if (g_debug_context)
-                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
-
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+            FlushPendingDraw();
+            if (VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+                if (g_debug_context) {
+                    g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch,
+                                             nullptr);
                 }
+                break;
             }
-
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
-        }
-
-        for (auto& range : memory_accesses.ranges) {
-            g_debug_context->recorder->MemoryAccessed(
-                VideoCore::g_memory->GetPhysicalPointer(range.first), range.second, range.first);
-        }
-
-        VideoCore::g_renderer->Rasterizer()->DrawTriangles();
-        if (g_debug_context) {
-            g_debug_context->OnEvent(DebugContext::Event::FinishedPrimitiveBatch, nullptr);
+        } else {
+            FlushPendingDraw();
         }
 
+        DrawSoftwareShaded(is_indexed);
         break;
     }
 
@@ -673,6 +938,10 @@ void ProcessCommandList(PAddr list, u32 size) {
             WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
         }
     }
+
+    // Draw the remaining queued triangles, the guest may access their output after the list
+    FlushPendingDraw();
+    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
 }
 
 } // namespace Pica::CommandProcessor
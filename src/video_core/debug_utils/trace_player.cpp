@@ -0,0 +1,304 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "video_core/debug_utils/trace_player.h"
+#include "video_core/pica_state.h"
+
+namespace CiTrace {
+
+namespace {
+
+/// Returns whether [offset, offset + size) lies within a file of file_size bytes
+bool IsInFile(u64 offset, u64 size, std::size_t file_size) {
+    return offset <= file_size && size <= file_size - offset;
+}
+
+} // Anonymous namespace
+
+bool Player::Load(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Could not open CiTrace {}", filename);
+        return false;
+    }
+
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(HW_GPU, "Could not read CiTrace {}", filename);
+        return false;
+    }
+    return Load(std::move(data));
+}
+
+bool Player::Load(std::vector<u8> data) {
+    file_data = std::move(data);
+    stream.clear();
+    frames.clear();
+
+    if (file_data.size() < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "CiTrace is too small to hold a header");
+        return false;
+    }
+    std::memcpy(&header, file_data.data(), sizeof(CTHeader));
+
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), sizeof(header.magic)) != 0 ||
+        header.version == 0 || header.version > CTHeader::ExpectedVersion() ||
+        header.header_size < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "Unsupported CiTrace, version {}", header.version);
+        return false;
+    }
+
+    const auto& initial = header.initial_state_offsets;
+    const std::pair<u32, u32> blocks[] = {
+        {initial.gpu_registers, initial.gpu_registers_size},
+        {initial.lcd_registers, initial.lcd_registers_size},
+        {initial.pica_registers, initial.pica_registers_size},
+        {initial.default_attributes, initial.default_attributes_size},
+        {initial.vs_program_binary, initial.vs_program_binary_size},
+        {initial.vs_swizzle_data, initial.vs_swizzle_data_size},
+        {initial.vs_float_uniforms, initial.vs_float_uniforms_size},
+        {initial.gs_program_binary, initial.gs_program_binary_size},
+        {initial.gs_swizzle_data, initial.gs_swizzle_data_size},
+        {initial.gs_float_uniforms, initial.gs_float_uniforms_size},
+    };
+    for (const auto& [offset, size] : blocks) {
+        if (!IsInFile(offset, u64{size} * sizeof(u32), file_data.size())) {
+            LOG_ERROR(HW_GPU, "CiTrace initial state at {:#x} is out of bounds", offset);
+            return false;
+        }
+    }
+
+    const bool stream_read = header.version == 1 ? ReadStream() : ReadCompressedStream();
+    if (!stream_read) {
+        return false;
+    }
+
+    std::size_t frame_begin = 0;
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        const CTStreamElement& element = stream[i];
+        switch (element.type) {
+        case FrameMarker:
+            frames.emplace_back(frame_begin, i + 1);
+            frame_begin = i + 1;
+            break;
+        case MemoryLoad:
+            if (!IsInFile(element.memory_load.file_offset, element.memory_load.size,
+                          file_data.size())) {
+                LOG_ERROR(HW_GPU, "CiTrace memory load {} is out of bounds", i);
+                return false;
+            }
+            break;
+        case RegisterWrite:
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown CiTrace stream element type {:#x}",
+                      static_cast<u32>(element.type));
+            return false;
+        }
+    }
+    if (frame_begin != stream.size()) {
+        frames.emplace_back(frame_begin, stream.size());
+    }
+    return true;
+}
+
+bool Player::ReadStream() {
+    if (!IsInFile(header.stream_offset, u64{header.stream_size} * sizeof(CTStreamElement),
+                  file_data.size())) {
+        LOG_ERROR(HW_GPU, "CiTrace stream is out of bounds");
+        return false;
+    }
+
+    stream.resize(header.stream_size);
+    std::memcpy(stream.data(), file_data.data() + header.stream_offset,
+                stream.size() * sizeof(CTStreamElement));
+    return true;
+}
+
+bool Player::ReadCompressedStream() {
+    if (!IsInFile(header.stream_offset, u64{header.stream_size} * sizeof(CTBlockIndexEntry),
+                  file_data.size())) {
+        LOG_ERROR(HW_GPU, "CiTrace block index is out of bounds");
+        return false;
+    }
+
+    std::vector<CTBlockIndexEntry> block_index(header.stream_size);
+    std::memcpy(block_index.data(), file_data.data() + header.stream_offset,
+                block_index.size() * sizeof(CTBlockIndexEntry));
+
+    for (const CTBlockIndexEntry& entry : block_index) {
+        const std::optional<std::vector<u8>> block = ReadChunk(entry.file_offset);
+        if (!block || entry.first_element != stream.size() ||
+            block->size() != u64{entry.num_elements} * sizeof(CTStreamElement)) {
+            LOG_ERROR(HW_GPU, "CiTrace block at {:#x} is invalid", entry.file_offset);
+            return false;
+        }
+        stream.resize(stream.size() + entry.num_elements);
+        std::memcpy(stream.data() + entry.first_element, block->data(), block->size());
+    }
+
+    // Decompress the memory data after the file data, so that loads read it like in version 1
+    std::unordered_map<u32, u32> data_offsets;
+    const std::size_t compressed_size = file_data.size();
+    for (CTStreamElement& element : stream) {
+        if (element.type != MemoryLoad) {
+            continue;
+        }
+
+        CTMemoryLoad& load = element.memory_load;
+        const auto [itr, inserted] = data_offsets.try_emplace(load.file_offset);
+        if (inserted) {
+            const std::optional<std::vector<u8>> data =
+                load.file_offset < compressed_size ? ReadChunk(load.file_offset) : std::nullopt;
+            if (!data || file_data.size() + data->size() > std::numeric_limits<u32>::max()) {
+                LOG_ERROR(HW_GPU, "CiTrace memory data at {:#x} is invalid", load.file_offset);
+                return false;
+            }
+            itr->second = static_cast<u32>(file_data.size());
+            file_data.insert(file_data.end(), data->begin(), data->end());
+        }
+        load.file_offset = itr->second;
+    }
+    return true;
+}
+
+std::optional<std::vector<u8>> Player::ReadChunk(u32 offset) const {
+    if (!IsInFile(offset, sizeof(CTChunkHeader), file_data.size())) {
+        return std::nullopt;
+    }
+    CTChunkHeader chunk_header;
+    std::memcpy(&chunk_header, file_data.data() + offset, sizeof(CTChunkHeader));
+
+    const u64 data_offset = u64{offset} + sizeof(CTChunkHeader);
+    if (!IsInFile(data_offset, chunk_header.compressed_size, file_data.size())) {
+        return std::nullopt;
+    }
+    const auto compressed_begin = file_data.begin() + static_cast<std::ptrdiff_t>(data_offset);
+    std::vector<u8> data = Common::Compression::DecompressDataZSTD(
+        {compressed_begin, compressed_begin + chunk_header.compressed_size});
+    if (data.size() != chunk_header.uncompressed_size) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+std::vector<u32> Player::ReadWords(u32 offset, u32 size) const {
+    std::vector<u32> words(size);
+    std::memcpy(words.data(), file_data.data() + offset, words.size() * sizeof(u32));
+    return words;
+}
+
+void Player::CopyWords(void* dest, std::size_t dest_size, u32 offset, u32 size) const {
+    std::memcpy(dest, file_data.data() + offset,
+                std::min<std::size_t>(dest_size, std::size_t{size} * sizeof(u32)));
+}
+
+void Player::CopyVectors(Common::Vec4<Pica::float24>* dest, std::size_t count, u32 offset,
+                         u32 size) const {
+    // Vectors are stored as four float24 words each
+    const std::vector<u32> words = ReadWords(offset, size);
+    for (std::size_t i = 0; i < count && i * 4 + 3 < words.size(); ++i) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            dest[i][comp] = Pica::float24::FromRaw(words[i * 4 + comp]);
+        }
+    }
+}
+
+void Player::ApplyInitialState() const {
+    const auto& initial = header.initial_state_offsets;
+
+    CopyWords(&GPU::g_regs, sizeof(GPU::g_regs), initial.gpu_registers,
+              initial.gpu_registers_size);
+    CopyWords(&LCD::g_regs, sizeof(LCD::g_regs), initial.lcd_registers,
+              initial.lcd_registers_size);
+    CopyWords(&Pica::g_state.regs, sizeof(Pica::g_state.regs), initial.pica_registers,
+              initial.pica_registers_size);
+    CopyVectors(Pica::g_state.input_default_attributes.attr,
+                std::size(Pica::g_state.input_default_attributes.attr),
+                initial.default_attributes, initial.default_attributes_size);
+
+    auto& vs = Pica::g_state.vs;
+    CopyWords(vs.program_code.data(), sizeof(vs.program_code), initial.vs_program_binary,
+              initial.vs_program_binary_size);
+    CopyWords(vs.swizzle_data.data(), sizeof(vs.swizzle_data), initial.vs_swizzle_data,
+              initial.vs_swizzle_data_size);
+    CopyVectors(vs.uniforms.f, std::size(vs.uniforms.f), initial.vs_float_uniforms,
+                initial.vs_float_uniforms_size);
+    vs.MarkProgramCodeDirty();
+    vs.MarkSwizzleDataDirty();
+
+    // The recorder doesn't capture the geometry shader yet, keep the current one in that case
+    auto& gs = Pica::g_state.gs;
+    if (initial.gs_program_binary_size != 0) {
+        CopyWords(gs.program_code.data(), sizeof(gs.program_code), initial.gs_program_binary,
+                  initial.gs_program_binary_size);
+        CopyWords(gs.swizzle_data.data(), sizeof(gs.swizzle_data), initial.gs_swizzle_data,
+                  initial.gs_swizzle_data_size);
+        CopyVectors(gs.uniforms.f, std::size(gs.uniforms.f), initial.gs_float_uniforms,
+                    initial.gs_float_uniforms_size);
+        gs.MarkProgramCodeDirty();
+        gs.MarkSwizzleDataDirty();
+    }
+}
+
+void Player::ReplayElement(const CTStreamElement& element, Memory::MemorySystem& memory) const {
+    switch (element.type) {
+    case MemoryLoad: {
+        const CTMemoryLoad& load = element.memory_load;
+        if (load.size == 0) {
+            break;
+        }
+        if (!memory.IsValidPhysicalAddress(load.physical_address) ||
+            !memory.IsValidPhysicalAddress(load.physical_address + load.size - 1)) {
+            LOG_ERROR(HW_GPU, "CiTrace memory load to invalid address {:#010x}",
+                      load.physical_address);
+            break;
+        }
+        std::memcpy(memory.GetPhysicalPointer(load.physical_address),
+                    file_data.data() + load.file_offset, load.size);
+        break;
+    }
+    case RegisterWrite: {
+        // Registers are recorded by their physical address, the handlers expect the virtual one
+        const CTRegisterWrite& write = element.register_write;
+        const u32 addr = write.physical_address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR;
+        switch (write.size) {
+        case CTRegisterWrite::SIZE_8:
+            HW::Write<u8>(addr, static_cast<u8>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_16:
+            HW::Write<u16>(addr, static_cast<u16>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_32:
+            HW::Write<u32>(addr, static_cast<u32>(write.value));
+            break;
+        case CTRegisterWrite::SIZE_64:
+            HW::Write<u64>(addr, write.value);
+            break;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Player::ReplayFrame(const FrameRange& frame, Memory::MemorySystem& memory) const {
+    for (std::size_t i = frame.first; i < frame.second; ++i) {
+        ReplayElement(stream[i], memory);
+    }
+}
+
+} // namespace CiTrace
@@ -0,0 +1,85 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/tracer/citrace.h"
+#include "video_core/pica_types.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace CiTrace {
+
+/**
+ * Replays a CiTrace written by the Recorder on the emulated GPU. This only touches the GPU, LCD and
+ * PICA state and the given memory, so traces can be replayed without an emulation session.
+ */
+class Player {
+public:
+    /// Range of stream element indices [first, second) that make up a frame
+    using FrameRange = std::pair<std::size_t, std::size_t>;
+
+    /**
+     * Reads a CiTrace file, decompressing the stream of version 2 traces.
+     * @returns false if the file can't be read or isn't a valid CiTrace
+     */
+    bool Load(const std::string& filename);
+
+    /// Reads a CiTrace from memory, see Load.
+    bool Load(std::vector<u8> data);
+
+    const std::vector<CTStreamElement>& GetStream() const {
+        return stream;
+    }
+
+    /// Returns the frames of the stream. Elements after the last frame marker form a last frame.
+    const std::vector<FrameRange>& GetFrames() const {
+        return frames;
+    }
+
+    /// Sets the GPU, LCD and PICA registers and the shader setup to the state the trace starts with
+    void ApplyInitialState() const;
+
+    /// Performs the memory load or register write of a stream element. Frame markers are ignored.
+    void ReplayElement(const CTStreamElement& element, Memory::MemorySystem& memory) const;
+
+    /// Replays the elements of a frame.
+    void ReplayFrame(const FrameRange& frame, Memory::MemorySystem& memory) const;
+
+private:
+    /// Reads the uncompressed stream elements of a version 1 trace
+    bool ReadStream();
+
+    /// Decompresses the stream blocks and memory data of a version 2 trace
+    bool ReadCompressedStream();
+
+    /// Returns the decompressed data of the chunk at the given file offset, if it's valid
+    std::optional<std::vector<u8>> ReadChunk(u32 offset) const;
+
+    /// Returns the `size` words of the initial state at the given file offset
+    std::vector<u32> ReadWords(u32 offset, u32 size) const;
+
+    /// Copies the `size` words at the given file offset to dest, up to dest_size bytes
+    void CopyWords(void* dest, std::size_t dest_size, u32 offset, u32 size) const;
+
+    /// Decodes the float24 vectors at the given file offset to dest, up to `count` vectors
+    void CopyVectors(Common::Vec4<Pica::float24>* dest, std::size_t count, u32 offset,
+                     u32 size) const;
+
+    std::vector<u8> file_data;
+    CTHeader header{};
+    std::vector<CTStreamElement> stream;
+    std::vector<FrameRange> frames;
+};
+
+} // namespace CiTrace
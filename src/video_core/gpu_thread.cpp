@@ -0,0 +1,143 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <type_traits>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "core/perf_stats.h"
+#include "video_core/command_processor.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace VideoCore {
+
+std::unique_ptr<GPUThread> g_gpu_thread;
+
+GPUThread::GPUThread(std::unique_ptr<Frontend::GraphicsContext> context_)
+    : context{std::move(context_)} {
+    thread = std::thread(&GPUThread::ThreadLoop, this);
+}
+
+GPUThread::~GPUThread() {
+    PushCommand(EndCommand{});
+    thread.join();
+}
+
+u64 GPUThread::PushCommand(CommandData&& command) {
+    std::scoped_lock lock{push_mutex};
+    const u64 fence = last_fence.load(std::memory_order_relaxed) + 1;
+    queue.Push(CommandDataContainer{std::move(command), fence});
+    last_fence.store(fence, std::memory_order_release);
+    return fence;
+}
+
+void GPUThread::PushCommandSync(CommandData&& command) {
+    if (IsGpuThread()) {
+        ExecuteCommand(command);
+        return;
+    }
+    WaitForFence(PushCommand(std::move(command)));
+}
+
+void GPUThread::WaitForFence(u64 fence) {
+    // Fences from a loaded savestate may be newer than anything queued since
+    fence = std::min(fence, last_fence.load(std::memory_order_acquire));
+    if (signaled_fence.load(std::memory_order_acquire) >= fence) {
+        return;
+    }
+
+    std::unique_lock lock{fence_mutex};
+    fence_cv.wait(lock, [this, fence] {
+        return signaled_fence.load(std::memory_order_acquire) >= fence;
+    });
+}
+
+void GPUThread::WaitIdle() {
+    WaitForFence(last_fence.load(std::memory_order_acquire));
+}
+
+bool GPUThread::IsGpuThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void GPUThread::DeferInterrupt(Service::GSP::InterruptId interrupt_id) {
+    deferred_interrupts.Push(interrupt_id);
+}
+
+void GPUThread::SignalDeferredInterrupts() {
+    Service::GSP::InterruptId interrupt_id;
+    while (deferred_interrupts.Pop(interrupt_id)) {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
+MICROPROFILE_DEFINE(GPU_ThreadIdle, "GPU", "GPU Thread Idle", MP_RGB(128, 128, 128));
+MICROPROFILE_DEFINE(GPU_ThreadCmdlist, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
+
+void GPUThread::ThreadLoop() {
+    Common::SetCurrentThreadName("GPUThread");
+    MicroProfileOnThreadCreate("GPUThread");
+    context->MakeCurrent();
+
+    while (true) {
+        CommandDataContainer next;
+        {
+            MICROPROFILE_SCOPE(GPU_ThreadIdle);
+            next = queue.PopWait();
+        }
+
+        const bool end = std::holds_alternative<EndCommand>(next.data);
+        if (!end) {
+            ExecuteCommand(next.data);
+        }
+
+        signaled_fence.store(next.fence, std::memory_order_release);
+        {
+            // Acquire the mutex so that a waiter can't miss the notification
+            std::scoped_lock lock{fence_mutex};
+        }
+        fence_cv.notify_all();
+
+        if (end) {
+            break;
+        }
+    }
+
+    context->DoneCurrent();
+    MicroProfileOnThreadExit();
+}
+
+void GPUThread::ExecuteCommand(CommandData& command) {
+    std::visit(
+        [](auto& data) {
+            using T = std::decay_t<decltype(data)>;
+            if constexpr (std::is_same_v<T, SubmitListCommand>) {
+                MICROPROFILE_FRAME_SCOPE(GPU_ThreadCmdlist, Core::FrameCounter::GpuCommandTime);
+                Pica::CommandProcessor::ProcessCommandList(data.list, data.size);
+            } else if constexpr (std::is_same_v<T, MemoryFillCommand>) {
+                GPU::ExecuteMemoryFill(data.config, data.is_second_filler);
+            } else if constexpr (std::is_same_v<T, DisplayTransferCommand>) {
+                GPU::ExecuteDisplayTransfer(data.config);
+            } else if constexpr (std::is_same_v<T, SwapBuffersCommand>) {
+                g_renderer->SwapBuffers();
+            } else if constexpr (std::is_same_v<T, FlushRegionCommand>) {
+                g_renderer->Rasterizer()->FlushRegion(data.addr, data.size);
+            } else if constexpr (std::is_same_v<T, InvalidateRegionCommand>) {
+                g_renderer->Rasterizer()->InvalidateRegion(data.addr, data.size);
+            } else if constexpr (std::is_same_v<T, FlushAndInvalidateRegionCommand>) {
+                g_renderer->Rasterizer()->FlushAndInvalidateRegion(data.addr, data.size);
+            } else if constexpr (std::is_same_v<T, ClearAllCommand>) {
+                g_renderer->Rasterizer()->ClearAll(data.flush);
+            } else if constexpr (std::is_same_v<T, FunctionCommand>) {
+                data.func();
+            }
+        },
+        command);
+}
+
+} // namespace VideoCore
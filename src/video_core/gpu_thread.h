@@ -0,0 +1,143 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "core/hle/service/gsp/gsp.h"
+#include "core/hw/gpu.h"
+
+namespace Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Frontend
+
+namespace VideoCore {
+
+/// Processes a PICA command list
+struct SubmitListCommand {
+    PAddr list;
+    u32 size;
+};
+
+/// Performs a memory fill with one of the two fill units
+struct MemoryFillCommand {
+    GPU::Regs::MemoryFillConfig config;
+    bool is_second_filler;
+};
+
+/// Performs a display transfer or texture copy
+struct DisplayTransferCommand {
+    GPU::Regs::DisplayTransferConfig config;
+};
+
+/// Presents the current framebuffers
+struct SwapBuffersCommand {};
+
+/// Writes back cached surfaces in the region to emulated memory
+struct FlushRegionCommand {
+    PAddr addr;
+    u32 size;
+};
+
+/// Drops cached surfaces in the region
+struct InvalidateRegionCommand {
+    PAddr addr;
+    u32 size;
+};
+
+/// Writes back and drops cached surfaces in the region
+struct FlushAndInvalidateRegionCommand {
+    PAddr addr;
+    u32 size;
+};
+
+/// Drops all cached surfaces, optionally writing them back first
+struct ClearAllCommand {
+    bool flush;
+};
+
+/// Runs arbitrary renderer code, such as its creation or destruction, on the GPU thread
+struct FunctionCommand {
+    std::function<void()> func;
+};
+
+/// Stops the GPU thread
+struct EndCommand {};
+
+using CommandData =
+    std::variant<EndCommand, SubmitListCommand, MemoryFillCommand, DisplayTransferCommand,
+                 SwapBuffersCommand, FlushRegionCommand, InvalidateRegionCommand,
+                 FlushAndInvalidateRegionCommand, ClearAllCommand, FunctionCommand>;
+
+/**
+ * Runs the PICA GPU emulation (command lists, memory fills, display transfers and presentation)
+ * on a dedicated thread that owns the renderer, so that it overlaps with the ARM11 emulation.
+ *
+ * Commands are queued by the emulation thread and identified by a fence, which increases with each
+ * command. Interrupts raised while processing a command are deferred until the emulation thread
+ * calls SignalDeferredInterrupts, as the kernel may only be accessed from the emulation thread.
+ */
+class GPUThread {
+public:
+    explicit GPUThread(std::unique_ptr<Frontend::GraphicsContext> context);
+    ~GPUThread();
+
+    /// Queues a command for the GPU thread and returns its fence
+    u64 PushCommand(CommandData&& command);
+
+    /// Queues a command for the GPU thread and waits until it has been processed
+    void PushCommandSync(CommandData&& command);
+
+    /// Blocks until the command with the given fence has been processed
+    void WaitForFence(u64 fence);
+
+    /// Blocks until all queued commands have been processed
+    void WaitIdle();
+
+    /// Returns whether the caller is running on the GPU thread
+    bool IsGpuThread() const;
+
+    /// Queues an interrupt raised by the GPU thread for the emulation thread
+    void DeferInterrupt(Service::GSP::InterruptId interrupt_id);
+
+    /// Signals the interrupts raised by the GPU thread so far. Called from the emulation thread.
+    void SignalDeferredInterrupts();
+
+private:
+    struct CommandDataContainer {
+        CommandData data;
+        u64 fence = 0;
+    };
+
+    void ThreadLoop();
+    void ExecuteCommand(CommandData& command);
+
+    std::unique_ptr<Frontend::GraphicsContext> context;
+
+    Common::SPSCQueue<CommandDataContainer> queue;
+    std::mutex push_mutex;
+    std::atomic<u64> last_fence{0};
+
+    std::atomic<u64> signaled_fence{0};
+    std::mutex fence_mutex;
+    std::condition_variable fence_cv;
+
+    Common::SPSCQueue<Service::GSP::InterruptId> deferred_interrupts;
+
+    std::thread thread;
+};
+
+/// The GPU thread, if asynchronous GPU emulation is enabled
+extern std::unique_ptr<GPUThread> g_gpu_thread;
+
+} // namespace VideoCore
@@ -5,17 +5,26 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "core/core.h"
+#include "core/custom_tex_cache.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/rasterizer_accelerated.h"
 #include "video_core/rasterizer_cache/surface_base.h"
 #include "video_core/rasterizer_cache/surface_params.h"
+#include "video_core/rasterizer_cache/texture_dumper.h"
 #include "video_core/rasterizer_cache/utils.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/video_core.h"
@@ -58,15 +67,19 @@ private:
     using SurfaceMap = boost::icl::interval_map<PAddr, Surface, boost::icl::partial_absorber,
                                                 std::less, boost::icl::inplace_plus,
                                                 boost::icl::inter_section, SurfaceInterval>;
-    using SurfaceCache = boost::icl::interval_map<PAddr, SurfaceSet, boost::icl::partial_absorber,
-                                                  std::less, boost::icl::inplace_plus,
-                                                  boost::icl::inter_section, SurfaceInterval>;
 
-    static_assert(
-        std::is_same<SurfaceRegions::interval_type, typename SurfaceCache::interval_type>() &&
-            std::is_same<typename SurfaceMap::interval_type,
-                         typename SurfaceCache::interval_type>(),
-        "Incorrect interval types");
+    static_assert(std::is_same<SurfaceRegions::interval_type, typename SurfaceMap::interval_type>(),
+                  "Incorrect interval types");
+
+    /// Surfaces read back by the CPU within this many frames are downloaded ahead of time
+    static constexpr u64 READ_BACK_FRAMES = 60;
+
+    /// Surfaces are indexed by the 4KiB pages they overlap, so that a lookup only visits the
+    /// pages of the requested region
+    static constexpr u32 CACHE_PAGE_BITS = 12;
+    static constexpr u32 CACHE_PAGE_SIZE = 1U << CACHE_PAGE_BITS;
+    using PageSurfaces = boost::container::small_vector<Surface, 4>;
+    using PageTable = std::unordered_map<u32, PageSurfaces, Common::IdentityHash<u32>>;
 
     using SurfaceRect_Tuple = std::tuple<Surface, Common::Rectangle<u32>>;
     using SurfaceSurfaceRect_Tuple = std::tuple<Surface, Surface, Common::Rectangle<u32>>;
@@ -77,8 +90,7 @@ public:
 
     /// Get the best surface match (and its match type) for the given flags
     template <MatchFlags find_flags>
-    Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
-                      ScaleMatch match_scale_type,
+    Surface FindMatch(const SurfaceParams& params, ScaleMatch match_scale_type,
                       std::optional<SurfaceInterval> validate_interval = std::nullopt);
 
     /// Blit one surface's texture to another
@@ -124,7 +136,14 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Evicts the least recently used surfaces when the cache exceeds its memory budget
+    void TickFrame();
+
 private:
+    /// Iterates over the cached surfaces overlapping the region, visiting each surface once
+    template <typename Func>
+    void ForEachSurfaceInRegion(PAddr addr, u32 size, Func&& func);
+
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
     /// Update surface's texture for given region when necessary
@@ -139,6 +158,26 @@ private:
     /// Downloads a fill surface to guest VRAM
     void DownloadFillSurface(const Surface& surface, SurfaceInterval interval);
 
+    /// Starts downloading the dirty regions of a surface the CPU has read back before, so that
+    /// a later flush does not have to wait for the GPU
+    void DownloadAhead(const Surface& surface);
+
+    /// Writes the downloads made ahead that cover dirty regions of flush_interval to guest VRAM
+    void WriteBackPendingDownloads(SurfaceInterval flush_interval, const Surface& flush_surface,
+                                   SurfaceRegions& flushed_intervals);
+
+    /// Queues writing a fully uploaded texture to the dump directory unless it was dumped already
+    void DumpTexture(const Surface& surface, u64 hash, std::span<const std::byte> data);
+
+    /// Queues decoding the custom texture that replaces a fully uploaded surface
+    void RequestCustomTexture(const Surface& surface, u64 hash);
+
+    /// Replaces the surfaces whose custom textures finished decoding
+    void ApplyCustomTextures();
+
+    /// Uploads a decoded custom texture to all levels of the surface, scaling it up if needed
+    void UploadCustomTexture(const Surface& surface, const Core::CustomTexInfo& tex_info);
+
     /// Returns false if there is a surface in the cache at the interval with the same bit-width,
     bool NoUnimplementedReinterpretations(const Surface& surface, SurfaceParams& params,
                                           SurfaceInterval interval);
@@ -159,14 +198,37 @@ private:
     /// Remove surface from the cache
     void UnregisterSurface(const Surface& surface);
 
+    /// Returns an estimate of the host memory used by the texture of the surface
+    static u64 GetHostSize(const Surface& surface);
+
 private:
+    struct PendingDownload {
+        Surface surface;
+        SurfaceInterval interval;
+        std::function<void()> write_back;
+    };
+
+    struct PendingCustomTexture {
+        std::shared_ptr<Watcher> watcher;
+        u64 hash;
+    };
+
     VideoCore::RasterizerAccelerated& rasterizer;
     TextureRuntime& runtime;
-    SurfaceCache surface_cache;
+    PageTable page_table;
     SurfaceMap dirty_regions;
     SurfaceSet remove_surfaces;
     u16 resolution_scale_factor;
+    u64 frame_tick = 1;
+    u64 cache_size = 0;
     std::vector<std::function<void()>> download_queue;
+    std::vector<PendingDownload> pending_downloads;
+    u64 download_fence = 0;
+    u64 last_download_offset = 0;
+    std::array<Surface, 2> render_targets;
+    std::vector<PendingCustomTexture> pending_custom_textures;
+    std::vector<Surface> custom_upload_surfaces;
+    std::unique_ptr<TextureDumper> texture_dumper;
     std::vector<std::byte> staging_buffer;
     std::unordered_map<TextureCubeConfig, Surface> texture_cube_cache;
     std::recursive_mutex mutex;
@@ -179,92 +241,131 @@ RasterizerCache<T>::RasterizerCache(VideoCore::RasterizerAccelerated& rasterizer
     resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
 }
 
+template <class T>
+template <typename Func>
+void RasterizerCache<T>::ForEachSurfaceInRegion(PAddr addr, u32 size, Func&& func) {
+    const u64 end = static_cast<u64>(addr) + size;
+    const u32 page_start = addr >> CACHE_PAGE_BITS;
+    const u32 page_end = static_cast<u32>((end + CACHE_PAGE_SIZE - 1) >> CACHE_PAGE_BITS);
+
+    const auto visit_page = [&](u32 page, const PageSurfaces& surfaces) {
+        for (const Surface& surface : surfaces) {
+            if (surface->addr >= end || surface->end <= addr) {
+                continue;
+            }
+            // Surfaces spanning several pages are only visited on the first page they share
+            // with the region
+            if ((std::max(surface->addr, addr) >> CACHE_PAGE_BITS) != page) {
+                continue;
+            }
+            func(surface);
+        }
+    };
+
+    // Walking the table is cheaper than looking up every page of large regions
+    if (page_end - page_start > page_table.size()) {
+        for (const auto& [page, surfaces] : page_table) {
+            if (page >= page_start && page < page_end) {
+                visit_page(page, surfaces);
+            }
+        }
+        return;
+    }
+
+    for (u32 page = page_start; page < page_end; page++) {
+        if (const auto it = page_table.find(page); it != page_table.end()) {
+            visit_page(page, it->second);
+        }
+    }
+}
+
 template <class T>
 template <MatchFlags find_flags>
-auto RasterizerCache<T>::FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
-                                   ScaleMatch match_scale_type,
+auto RasterizerCache<T>::FindMatch(const SurfaceParams& params, ScaleMatch match_scale_type,
                                    std::optional<SurfaceInterval> validate_interval) -> Surface {
     Surface match_surface = nullptr;
     bool match_valid = false;
     u32 match_scale = 0;
     SurfaceInterval match_interval{};
 
-    for (const auto& pair : RangeFromInterval(surface_cache, params.GetInterval())) {
-        for (const auto& surface : pair.second) {
-            const bool res_scale_matched = match_scale_type == ScaleMatch::Exact
-                                               ? (params.res_scale == surface->res_scale)
-                                               : (params.res_scale <= surface->res_scale);
-            // validity will be checked in GetCopyableInterval
-            const bool is_valid =
-                True(find_flags & MatchFlags::Copy)
-                    ? true
-                    : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
-
-            if (False(find_flags & MatchFlags::Invalid) && !is_valid) {
-                continue;
+    ForEachSurfaceInRegion(params.addr, params.end - params.addr, [&](const Surface& surface) {
+        const bool res_scale_matched = match_scale_type == ScaleMatch::Exact
+                                           ? (params.res_scale == surface->res_scale)
+                                           : (params.res_scale <= surface->res_scale);
+        // validity will be checked in GetCopyableInterval
+        const bool is_valid =
+            True(find_flags & MatchFlags::Copy)
+                ? true
+                : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
+
+        if (False(find_flags & MatchFlags::Invalid) && !is_valid) {
+            return;
+        }
+
+        auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
+            if (False(find_flags & check_type))
+                return;
+
+            bool matched;
+            SurfaceInterval surface_interval;
+            std::tie(matched, surface_interval) = match_fn();
+            if (!matched)
+                return;
+
+            if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
+                surface->type != SurfaceType::Fill)
+                return;
+
+            // Found a match, update only if this is better than the previous one
+            auto UpdateMatch = [&] {
+                match_surface = surface;
+                match_valid = is_valid;
+                match_scale = surface->res_scale;
+                match_interval = surface_interval;
+            };
+
+            if (surface->res_scale > match_scale) {
+                UpdateMatch();
+                return;
+            } else if (surface->res_scale < match_scale) {
+                return;
             }
 
-            auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
-                if (False(find_flags & check_type))
-                    return;
-
-                bool matched;
-                SurfaceInterval surface_interval;
-                std::tie(matched, surface_interval) = match_fn();
-                if (!matched)
-                    return;
-
-                if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
-                    surface->type != SurfaceType::Fill)
-                    return;
-
-                // Found a match, update only if this is better than the previous one
-                auto UpdateMatch = [&] {
-                    match_surface = surface;
-                    match_valid = is_valid;
-                    match_scale = surface->res_scale;
-                    match_interval = surface_interval;
-                };
-
-                if (surface->res_scale > match_scale) {
-                    UpdateMatch();
-                    return;
-                } else if (surface->res_scale < match_scale) {
-                    return;
-                }
+            if (is_valid && !match_valid) {
+                UpdateMatch();
+                return;
+            } else if (is_valid != match_valid) {
+                return;
+            }
 
-                if (is_valid && !match_valid) {
-                    UpdateMatch();
-                    return;
-                } else if (is_valid != match_valid) {
-                    return;
-                }
+            if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
+                UpdateMatch();
+            }
+        };
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
+            return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
+            return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
+            ASSERT(validate_interval);
+            auto copy_interval =
+                surface->GetCopyableInterval(params.FromInterval(*validate_interval));
+            bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
+                           surface->CanCopy(params, copy_interval);
+            return std::make_pair(matched, copy_interval);
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
+            return std::make_pair(surface->CanExpand(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
+            return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
+        });
+    });
 
-                if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
-                    UpdateMatch();
-                }
-            };
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
-                return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
-                return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
-                ASSERT(validate_interval);
-                auto copy_interval =
-                    surface->GetCopyableInterval(params.FromInterval(*validate_interval));
-                bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
-                               surface->CanCopy(params, copy_interval);
-                return std::make_pair(matched, copy_interval);
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
-                return std::make_pair(surface->CanExpand(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
-                return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
-            });
-        }
+    if (match_surface) {
+        match_surface->last_used_frame = frame_tick;
     }
     return match_surface;
 }
@@ -365,16 +466,18 @@ auto RasterizerCache<T>::GetSurface(const SurfaceParams& params, ScaleMatch matc
 
     // Check for an exact match in existing surfaces
     Surface surface =
-        FindMatch<MatchFlags::Exact | MatchFlags::Invalid>(surface_cache, params, match_res_scale);
+        FindMatch<MatchFlags::Exact | MatchFlags::Invalid>(params, match_res_scale);
 
-    if (!surface) {
+    if (surface) {
+        Core::AddFrameCounter(Core::FrameCounter::SurfaceCacheHits);
+    } else {
         u16 target_res_scale = params.res_scale;
         if (match_res_scale != ScaleMatch::Exact) {
             // This surface may have a subrect of another surface with a higher res_scale, find
             // it to adjust our params
             SurfaceParams find_params = params;
             Surface expandable = FindMatch<MatchFlags::Expand | MatchFlags::Invalid>(
-                surface_cache, find_params, match_res_scale);
+                find_params, match_res_scale);
             if (expandable && expandable->res_scale > target_res_scale) {
                 target_res_scale = expandable->res_scale;
             }
@@ -383,7 +486,7 @@ auto RasterizerCache<T>::GetSurface(const SurfaceParams& params, ScaleMatch matc
             if (params.pixel_format == PixelFormat::RGBA8) {
                 find_params.pixel_format = PixelFormat::D24S8;
                 expandable = FindMatch<MatchFlags::Expand | MatchFlags::Invalid>(
-                    surface_cache, find_params, match_res_scale);
+                    find_params, match_res_scale);
                 if (expandable && expandable->res_scale > target_res_scale) {
                     target_res_scale = expandable->res_scale;
                 }
@@ -411,16 +514,17 @@ auto RasterizerCache<T>::GetSurfaceSubRect(const SurfaceParams& params, ScaleMat
     }
 
     // Attempt to find encompassing surface
-    Surface surface = FindMatch<MatchFlags::SubRect | MatchFlags::Invalid>(surface_cache, params,
-                                                                           match_res_scale);
+    Surface surface = FindMatch<MatchFlags::SubRect | MatchFlags::Invalid>(params, match_res_scale);
+    if (surface) {
+        Core::AddFrameCounter(Core::FrameCounter::SurfaceCacheHits);
+    }
 
     // Check if FindMatch failed because of res scaling
     // If that's the case create a new surface with
     // the dimensions of the lower res_scale surface
     // to suggest it should not be used again
     if (!surface && match_res_scale != ScaleMatch::Ignore) {
-        surface = FindMatch<MatchFlags::SubRect | MatchFlags::Invalid>(surface_cache, params,
-                                                                       ScaleMatch::Ignore);
+        surface = FindMatch<MatchFlags::SubRect | MatchFlags::Invalid>(params, ScaleMatch::Ignore);
         if (surface) {
             SurfaceParams new_params = *surface;
             new_params.res_scale = params.res_scale;
@@ -440,7 +544,7 @@ auto RasterizerCache<T>::GetSurfaceSubRect(const SurfaceParams& params, ScaleMat
 
     // Check for a surface we can expand before creating a new one
     if (!surface) {
-        surface = FindMatch<MatchFlags::Expand | MatchFlags::Invalid>(surface_cache, aligned_params,
+        surface = FindMatch<MatchFlags::Expand | MatchFlags::Invalid>(aligned_params,
                                                                       match_res_scale);
         if (surface) {
             aligned_params.width = aligned_params.stride;
@@ -676,8 +780,11 @@ auto RasterizerCache<T>::GetFramebufferSurfaces(bool using_color_fb, bool using_
     if (resolution_scale_changed || texture_filter_changed) [[unlikely]] {
         resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
         FlushAll();
-        while (!surface_cache.empty()) {
-            UnregisterSurface(*surface_cache.begin()->second.begin());
+        std::vector<Surface> surfaces;
+        ForEachSurfaceInRegion(0, 0xFFFFFFFF,
+                               [&surfaces](const Surface& surface) { surfaces.push_back(surface); });
+        for (const Surface& surface : surfaces) {
+            UnregisterSurface(surface);
         }
 
         texture_cube_cache.clear();
@@ -756,6 +863,14 @@ auto RasterizerCache<T>::GetFramebufferSurfaces(bool using_color_fb, bool using_
         depth_surface->InvalidateAllWatcher();
     }
 
+    // Render targets that are no longer drawn to are likely to be read back soon
+    for (const Surface& target : render_targets) {
+        if (target && target != color_surface && target != depth_surface) {
+            DownloadAhead(target);
+        }
+    }
+    render_targets = {color_surface, depth_surface};
+
     return std::make_tuple(color_surface, depth_surface, fb_rect);
 }
 
@@ -787,8 +902,8 @@ template <class T>
 auto RasterizerCache<T>::GetTexCopySurface(const SurfaceParams& params) -> SurfaceRect_Tuple {
     Common::Rectangle<u32> rect{};
 
-    Surface match_surface = FindMatch<MatchFlags::TexCopy | MatchFlags::Invalid>(
-        surface_cache, params, ScaleMatch::Ignore);
+    Surface match_surface =
+        FindMatch<MatchFlags::TexCopy | MatchFlags::Invalid>(params, ScaleMatch::Ignore);
 
     if (match_surface) {
         ValidateSurface(match_surface, params.addr, params.size);
@@ -863,8 +978,7 @@ void RasterizerCache<T>::ValidateSurface(const Surface& surface, PAddr addr, u32
         const auto interval = *it & validate_interval;
         SurfaceParams params = surface->FromInterval(interval);
 
-        Surface copy_surface =
-            FindMatch<MatchFlags::Copy>(surface_cache, params, ScaleMatch::Ignore, interval);
+        Surface copy_surface = FindMatch<MatchFlags::Copy>(params, ScaleMatch::Ignore, interval);
         if (copy_surface != nullptr) {
             SurfaceInterval copy_interval = copy_surface->GetCopyableInterval(params);
             CopySurface(copy_surface, surface, copy_interval);
@@ -929,6 +1043,154 @@ void RasterizerCache<T>::UploadSurface(const Surface& surface, SurfaceInterval i
                                       .texture_level = 0};
 
     surface->Upload(upload, staging);
+
+    // Custom textures are looked up and dumped by the hash of the whole guest texture
+    const bool use_hash = Settings::values.custom_textures || Settings::values.dump_textures;
+    if (use_hash && interval == surface->GetInterval() &&
+        surface->texture_type == TextureType::Texture2D &&
+        (surface->type == SurfaceType::Color || surface->type == SurfaceType::Texture)) {
+        const u64 hash = Common::ComputeHash64(upload_data.data(), upload_data.size());
+        if (Settings::values.dump_textures) {
+            DumpTexture(surface, hash, upload_data);
+        }
+        if (Settings::values.custom_textures) {
+            RequestCustomTexture(surface, hash);
+        }
+    }
+}
+
+template <class T>
+void RasterizerCache<T>::DumpTexture(const Surface& surface, u64 hash,
+                                     std::span<const std::byte> data) {
+    Core::System& system = Core::System::GetInstance();
+    Core::CustomTexCache& custom_tex_cache = system.CustomTexCache();
+    if (!surface->is_tiled || surface->stride != surface->width ||
+        custom_tex_cache.IsTextureDumped(hash)) {
+        return;
+    }
+
+    if (!texture_dumper) {
+        texture_dumper = std::make_unique<TextureDumper>(system);
+    }
+
+    // Textures dropped by a full queue are retried the next time they are uploaded
+    if (texture_dumper->DumpTexture(*surface, hash, data)) {
+        custom_tex_cache.SetTextureDumped(hash);
+    }
+}
+
+template <class T>
+void RasterizerCache<T>::RequestCustomTexture(const Surface& surface, u64 hash) {
+    Core::System& system = Core::System::GetInstance();
+    Core::CustomTexCache& custom_tex_cache = system.CustomTexCache();
+    if (!custom_tex_cache.CustomTextureExists(hash)) {
+        return;
+    }
+
+    // The watcher is invalidated when the surface is written again before the decode finishes
+    auto watcher = surface->CreateWatcher();
+    watcher->Validate();
+    pending_custom_textures.push_back({std::move(watcher), hash});
+    custom_tex_cache.QueueTextureDecode(hash, system.GetImageInterface());
+}
+
+template <class T>
+void RasterizerCache<T>::ApplyCustomTextures() {
+    Core::CustomTexCache& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
+    std::erase_if(pending_custom_textures, [&](const PendingCustomTexture& pending) {
+        const Surface surface = pending.watcher->Get();
+        if (!surface || !surface->registered || !pending.watcher->IsValid()) {
+            return true;
+        }
+
+        // The original texture stays in use until the replacement is ready
+        if (custom_tex_cache.IsTextureDecoding(pending.hash)) {
+            return false;
+        }
+        if (custom_tex_cache.IsTextureCached(pending.hash)) {
+            UploadCustomTexture(surface, custom_tex_cache.LookupTexture(pending.hash));
+        }
+        return true;
+    });
+
+    // Hand the textures of the upload surfaces back to the runtime for reuse
+    custom_upload_surfaces.clear();
+}
+
+template <class T>
+void RasterizerCache<T>::UploadCustomTexture(const Surface& surface,
+                                             const Core::CustomTexInfo& tex_info) {
+    // Replace the surface with an upscaled one to preserve the resolution of the custom texture
+    const u32 scale = std::clamp(
+        std::min(tex_info.width / surface->width, tex_info.height / surface->height), 1U, 16U);
+    Surface target = surface;
+    if (scale > surface->res_scale) {
+        SurfaceParams params = *surface;
+        params.res_scale = static_cast<u16>(scale);
+        target = CreateSurface(params);
+        DuplicateSurface(surface, target);
+        target->max_level = surface->max_level;
+        target->level_watchers = surface->level_watchers;
+        for (Surface& render_target : render_targets) {
+            if (render_target == surface) {
+                render_target = target;
+            }
+        }
+
+        // Delete the replaced surface like an expanded one, as it may still be in use
+        surface->UnlinkAllWatcher();
+        remove_surfaces.emplace(surface);
+        RegisterSurface(target);
+    }
+
+    // Levels are uploaded to an RGBA8 texture and blitted to convert them to the surface format.
+    // The textures replaced during a frame share the upload surfaces of the same size.
+    const auto get_upload_surface = [this](u32 width, u32 height) -> Surface {
+        const auto it = std::find_if(custom_upload_surfaces.begin(), custom_upload_surfaces.end(),
+                                     [width, height](const Surface& upload_surface) {
+                                         return upload_surface->width == width &&
+                                                upload_surface->height == height;
+                                     });
+        if (it != custom_upload_surfaces.end()) {
+            return *it;
+        }
+        SurfaceParams params;
+        params.width = width;
+        params.height = height;
+        params.pixel_format = PixelFormat::RGBA8;
+        params.UpdateParams();
+        return custom_upload_surfaces.emplace_back(
+            std::make_shared<typename T::SurfaceType>(params, runtime));
+    };
+
+    const u32 max_level = std::min(target->max_level, static_cast<u32>(tex_info.mips.size()));
+    for (u32 level = 0; level <= max_level; level++) {
+        const auto& pixels = level == 0 ? tex_info.tex : tex_info.mips[level - 1];
+        const Surface level_surface =
+            get_upload_surface(tex_info.width >> level, tex_info.height >> level);
+
+        const auto staging = runtime.FindStaging(level_surface->width * level_surface->height * 4,
+                                                 true);
+        runtime.FormatConvert(*level_surface, true, std::as_bytes(std::span{pixels}),
+                              staging.mapped);
+
+        const BufferTextureCopy upload = {.buffer_offset = 0,
+                                          .buffer_size = staging.size,
+                                          .texture_rect = level_surface->GetRect(),
+                                          .texture_level = 0};
+        level_surface->Upload(upload, staging);
+
+        const TextureBlit blit = {.src_level = 0,
+                                  .dst_level = level,
+                                  .src_layer = 0,
+                                  .dst_layer = 0,
+                                  .src_rect = level_surface->GetRect(),
+                                  .dst_rect = {0, target->GetScaledHeight() >> level,
+                                               target->GetScaledWidth() >> level, 0}};
+        runtime.BlitTextures(*level_surface, *target, blit);
+    }
+
+    target->InvalidateAllWatcher();
 }
 
 MICROPROFILE_DECLARE(RasterizerCache_SurfaceFlush);
@@ -941,6 +1203,12 @@ void RasterizerCache<T>::DownloadSurface(const Surface& surface, SurfaceInterval
 
     const auto staging = runtime.FindStaging(
         flush_info.width * flush_info.height * surface->GetInternalBytesPerPixel(), false);
+    // The staging memory of downloads made ahead is reused once the buffer wraps around
+    if (static_cast<u64>(staging.buffer_offset) < last_download_offset) {
+        pending_downloads.clear();
+    }
+    last_download_offset = staging.buffer_offset;
+
     const BufferTextureCopy download = {.buffer_offset = 0,
                                         .buffer_size = staging.size,
                                         .texture_rect = surface->GetSubRect(flush_info),
@@ -966,6 +1234,82 @@ void RasterizerCache<T>::DownloadSurface(const Surface& surface, SurfaceInterval
     });
 }
 
+template <class T>
+void RasterizerCache<T>::DownloadAhead(const Surface& surface) {
+    if (!surface->registered || surface->read_back_frame == 0 ||
+        frame_tick - surface->read_back_frame > READ_BACK_FRAMES) {
+        return;
+    }
+
+    bool queued = false;
+    for (const auto& [interval, owner] : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        const bool is_pending =
+            std::any_of(pending_downloads.begin(), pending_downloads.end(),
+                        [&surface, interval](const PendingDownload& download) {
+                            return download.surface == surface &&
+                                   boost::icl::contains(download.interval, interval);
+                        });
+        if (owner != surface || is_pending) {
+            continue;
+        }
+
+        const std::size_t queue_size = download_queue.size();
+        DownloadSurface(surface, interval);
+        if (download_queue.size() == queue_size) {
+            continue;
+        }
+
+        pending_downloads.push_back({surface, interval, std::move(download_queue.back())});
+        download_queue.pop_back();
+        queued = true;
+    }
+
+    // Submit the copies right away so that they are complete by the time the CPU reads
+    if (queued) {
+        download_fence = runtime.SubmitDownloads();
+    }
+}
+
+template <class T>
+void RasterizerCache<T>::WriteBackPendingDownloads(SurfaceInterval flush_interval,
+                                                   const Surface& flush_surface,
+                                                   SurfaceRegions& flushed_intervals) {
+    std::vector<PendingDownload> ready_downloads;
+    for (const auto& [interval, surface] : RangeFromInterval(dirty_regions, flush_interval)) {
+        if (flush_surface != nullptr && surface != flush_surface) {
+            continue;
+        }
+
+        const auto it =
+            std::find_if(pending_downloads.begin(), pending_downloads.end(),
+                         [&surface, interval = interval & flush_interval](
+                             const PendingDownload& download) {
+                             return download.surface == surface &&
+                                    boost::icl::contains(download.interval, interval);
+                         });
+        if (it == pending_downloads.end()) {
+            continue;
+        }
+
+        // Nothing wrote to the downloaded interval since, so it can be flushed as a whole
+        surface->read_back_frame = frame_tick;
+        flushed_intervals += it->interval;
+        ready_downloads.push_back(std::move(*it));
+        pending_downloads.erase(it);
+    }
+
+    if (ready_downloads.empty()) {
+        return;
+    }
+
+    // Every download recorded so far was submitted, so waiting on the last one leaves the whole
+    // staging buffer ready to be read
+    runtime.WaitDownloads(download_fence);
+    for (const auto& download : ready_downloads) {
+        download.write_back();
+    }
+}
+
 template <class T>
 void RasterizerCache<T>::DownloadFillSurface(const Surface& surface, SurfaceInterval interval) {
     const u32 flush_start = boost::icl::first(interval);
@@ -1015,8 +1359,7 @@ bool RasterizerCache<T>::NoUnimplementedReinterpretations(const Surface& surface
         if (GetFormatBpp(format) == surface->GetFormatBpp()) {
             params.pixel_format = format;
             // This could potentially be expensive, although experimentally it hasn't been too bad
-            Surface test_surface =
-                FindMatch<MatchFlags::Copy>(surface_cache, params, ScaleMatch::Ignore, interval);
+            Surface test_surface = FindMatch<MatchFlags::Copy>(params, ScaleMatch::Ignore, interval);
 
             if (test_surface) {
                 LOG_WARNING(HW_GPU, "Missing pixel_format reinterpreter: {} -> {}",
@@ -1034,16 +1377,17 @@ template <class T>
 bool RasterizerCache<T>::IntervalHasInvalidPixelFormat(SurfaceParams& params,
                                                        SurfaceInterval interval) {
     params.pixel_format = PixelFormat::Invalid;
-    for (const auto& set : RangeFromInterval(surface_cache, interval)) {
-        for (const auto& surface : set.second) {
-            if (surface->pixel_format == PixelFormat::Invalid) {
-                LOG_DEBUG(HW_GPU, "Surface {:#x} found with invalid pixel format", surface->addr);
-                return true;
-            }
-        }
-    }
-
-    return false;
+    bool has_invalid = false;
+    ForEachSurfaceInRegion(boost::icl::first(interval), boost::icl::length(interval),
+                           [&has_invalid](const Surface& surface) {
+                               if (!has_invalid && surface->pixel_format == PixelFormat::Invalid) {
+                                   LOG_DEBUG(HW_GPU, "Surface {:#x} found with invalid pixel format",
+                                             surface->addr);
+                                   has_invalid = true;
+                               }
+                           });
+
+    return has_invalid;
 }
 
 template <class T>
@@ -1053,7 +1397,7 @@ bool RasterizerCache<T>::ValidateByReinterpretation(const Surface& surface, Surf
     for (const auto& reinterpreter : runtime.GetPossibleReinterpretations(dest_format)) {
         params.pixel_format = reinterpreter->GetSourceFormat();
         Surface reinterpret_surface =
-            FindMatch<MatchFlags::Copy>(surface_cache, params, ScaleMatch::Ignore, interval);
+            FindMatch<MatchFlags::Copy>(params, ScaleMatch::Ignore, interval);
 
         if (reinterpret_surface) {
             auto reinterpret_interval = reinterpret_surface->GetCopyableInterval(params);
@@ -1080,6 +1424,11 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, Surface flush_surface
     const SurfaceInterval flush_interval(addr, addr + size);
     SurfaceRegions flushed_intervals;
 
+    // Downloads made ahead were submitted earlier, usually the CPU does not have to wait for them
+    if (!pending_downloads.empty()) {
+        WriteBackPendingDownloads(flush_interval, flush_surface, flushed_intervals);
+    }
+
     for (auto& pair : RangeFromInterval(dirty_regions, flush_interval)) {
         // small sizes imply that this most likely comes from the cpu, flush the entire region
         // the point is to avoid thousands of small writes every frame if the cpu decides to
@@ -1090,12 +1439,17 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, Surface flush_surface
         if (flush_surface != nullptr && surface != flush_surface)
             continue;
 
+        if (boost::icl::contains(flushed_intervals, interval)) {
+            continue;
+        }
+
         // Sanity check, this surface is the last one that marked this region dirty
         ASSERT(surface->IsRegionValid(interval));
 
         if (surface->type == SurfaceType::Fill) {
             DownloadFillSurface(surface, interval);
         } else {
+            surface->read_back_frame = frame_tick;
             DownloadSurface(surface, interval);
         }
 
@@ -1105,7 +1459,8 @@ void RasterizerCache<T>::FlushRegion(PAddr addr, u32 size, Surface flush_surface
     // Batch execute all requested downloads. This gives more time for them to complete
     // before we issue the CPU to GPU flush and reduces scheduler slot switches in Vulkan
     if (!download_queue.empty()) {
-        runtime.Finish();
+        download_fence = runtime.SubmitDownloads();
+        runtime.WaitDownloads(download_fence);
         for (const auto& download_func : download_queue) {
             download_func();
         }
@@ -1122,6 +1477,75 @@ void RasterizerCache<T>::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+template <class T>
+void RasterizerCache<T>::TickFrame() {
+    std::lock_guard lock{mutex};
+
+    if (!pending_custom_textures.empty()) {
+        ApplyCustomTextures();
+    }
+
+    // The game may read back what it rendered during the frame before drawing to it again
+    for (const Surface& target : render_targets) {
+        if (target) {
+            DownloadAhead(target);
+        }
+    }
+
+    const u64 budget = static_cast<u64>(Settings::values.surface_cache_budget) << 20;
+    const u64 last_frame = frame_tick++;
+    if (budget != 0 && cache_size > budget) {
+        // Surfaces used during the last frame are likely to be bound again by the next one
+        std::vector<Surface> candidates;
+        ForEachSurfaceInRegion(0, 0xFFFFFFFF, [&](const Surface& surface) {
+            if (surface->last_used_frame < last_frame) {
+                candidates.push_back(surface);
+            }
+        });
+        std::sort(candidates.begin(), candidates.end(), [](const Surface& a, const Surface& b) {
+            return a->last_used_frame < b->last_used_frame;
+        });
+
+        const auto is_dirty = [this](const Surface& surface) {
+            for (const auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+                if (pair.second == surface) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // Evict clean surfaces first, as dirty ones have to be written back to guest memory
+        u64 num_evicted = 0;
+        for (const bool evict_dirty : {false, true}) {
+            for (const Surface& surface : candidates) {
+                if (cache_size <= budget) {
+                    break;
+                }
+                if (!surface->registered || is_dirty(surface) != evict_dirty) {
+                    continue;
+                }
+                if (evict_dirty) {
+                    FlushRegion(surface->addr, surface->size, surface);
+                }
+                surface->InvalidateAllWatcher();
+                UnregisterSurface(surface);
+                num_evicted++;
+            }
+        }
+
+        LOG_DEBUG(HW_GPU, "Evicted {} surfaces, cache size is now {} MiB", num_evicted,
+                  cache_size >> 20);
+        Core::AddFrameCounter(Core::FrameCounter::SurfaceEvictions, num_evicted);
+
+        // Evicted surfaces hand their textures to the runtime for reuse, release them instead
+        candidates.clear();
+        runtime.ReleaseRecycledTextures();
+    }
+
+    Core::SetFrameGauge(Core::FrameGauge::SurfaceCacheSize, cache_size);
+}
+
 template <class T>
 void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     std::lock_guard lock{mutex};
@@ -1139,31 +1563,34 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, const Surface& r
         region_owner->invalid_regions.erase(invalid_interval);
     }
 
-    for (const auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
-        for (const auto& cached_surface : pair.second) {
-            if (cached_surface == region_owner) {
-                continue;
-            }
+    ForEachSurfaceInRegion(addr, size, [&](const Surface& cached_surface) {
+        if (cached_surface == region_owner) {
+            return;
+        }
 
-            // If cpu is invalidating this region we want to remove it
-            // to (likely) mark the memory pages as uncached
-            if (!region_owner && size <= 8) {
-                FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
-                remove_surfaces.emplace(cached_surface);
-                continue;
-            }
+        // If cpu is invalidating this region we want to remove it
+        // to (likely) mark the memory pages as uncached
+        if (!region_owner && size <= 8) {
+            FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
+            remove_surfaces.emplace(cached_surface);
+            return;
+        }
 
-            const auto interval = cached_surface->GetInterval() & invalid_interval;
-            cached_surface->invalid_regions.insert(interval);
-            cached_surface->InvalidateAllWatcher();
+        const auto interval = cached_surface->GetInterval() & invalid_interval;
+        cached_surface->invalid_regions.insert(interval);
+        cached_surface->InvalidateAllWatcher();
 
-            // If the surface has no salvageable data it should be removed from the cache to avoid
-            // clogging the data structure
-            if (cached_surface->IsSurfaceFullyInvalid()) {
-                remove_surfaces.emplace(cached_surface);
-            }
+        // If the surface has no salvageable data it should be removed from the cache to avoid
+        // clogging the data structure
+        if (cached_surface->IsSurfaceFullyInvalid()) {
+            remove_surfaces.emplace(cached_surface);
         }
-    }
+    });
+
+    // Downloads made ahead of the region no longer match what is in memory
+    std::erase_if(pending_downloads, [&invalid_interval](const PendingDownload& download) {
+        return boost::icl::intersects(download.interval, invalid_interval);
+    });
 
     if (region_owner != nullptr)
         dirty_regions.set({invalid_interval, region_owner});
@@ -1173,7 +1600,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, const Surface& r
     for (const auto& remove_surface : remove_surfaces) {
         if (remove_surface == region_owner) {
             Surface expanded_surface = FindMatch<MatchFlags::SubRect | MatchFlags::Invalid>(
-                surface_cache, *region_owner, ScaleMatch::Ignore);
+                *region_owner, ScaleMatch::Ignore);
             ASSERT(expanded_surface);
 
             if ((region_owner->invalid_regions - expanded_surface->invalid_regions).empty()) {
@@ -1190,6 +1617,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, const Surface& r
 
 template <class T>
 auto RasterizerCache<T>::CreateSurface(SurfaceParams& params) -> Surface {
+    Core::AddFrameCounter(Core::FrameCounter::SurfaceCacheMisses);
     Surface surface = std::make_shared<typename T::SurfaceType>(params, runtime);
     surface->invalid_regions.insert(surface->GetInterval());
     return surface;
@@ -1204,7 +1632,12 @@ void RasterizerCache<T>::RegisterSurface(const Surface& surface) {
     }
 
     surface->registered = true;
-    surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
+    surface->last_used_frame = frame_tick;
+    cache_size += GetHostSize(surface);
+    const u32 page_end = (surface->end - 1) >> CACHE_PAGE_BITS;
+    for (u32 page = surface->addr >> CACHE_PAGE_BITS; page <= page_end; page++) {
+        page_table[page].push_back(surface);
+    }
     rasterizer.UpdatePagesCachedCount(surface->addr, surface->size, 1);
 }
 
@@ -1217,8 +1650,31 @@ void RasterizerCache<T>::UnregisterSurface(const Surface& surface) {
     }
 
     surface->registered = false;
+    cache_size -= GetHostSize(surface);
+    std::erase_if(pending_downloads, [&surface](const PendingDownload& download) {
+        return download.surface == surface;
+    });
     rasterizer.UpdatePagesCachedCount(surface->addr, surface->size, -1);
-    surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+    const u32 page_end = (surface->end - 1) >> CACHE_PAGE_BITS;
+    for (u32 page = surface->addr >> CACHE_PAGE_BITS; page <= page_end; page++) {
+        const auto it = page_table.find(page);
+        ASSERT(it != page_table.end());
+        PageSurfaces& surfaces = it->second;
+        surfaces.erase(std::remove(surfaces.begin(), surfaces.end(), surface), surfaces.end());
+        if (surfaces.empty()) {
+            page_table.erase(it);
+        }
+    }
+}
+
+template <class T>
+u64 RasterizerCache<T>::GetHostSize(const Surface& surface) {
+    // Apart from the 16-bit formats, textures are stored with four bytes per pixel on the host
+    const u64 bytes_per_pixel = surface->GetFormatBpp() == 16 ? 2 : 4;
+    const u64 size = static_cast<u64>(surface->GetScaledWidth()) * surface->GetScaledHeight() *
+                     bytes_per_pixel;
+    // The runtimes allocate the full mipmap chain
+    return size + size / 3;
 }
 
 } // namespace VideoCore
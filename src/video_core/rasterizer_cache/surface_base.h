@@ -84,6 +84,8 @@ public:
 
 public:
     bool registered = false;
+    u64 last_used_frame = 0;
+    u64 read_back_frame = 0;
     SurfaceRegions invalid_regions;
     std::array<std::shared_ptr<Watcher>, 7> level_watchers;
     u32 max_level = 0;
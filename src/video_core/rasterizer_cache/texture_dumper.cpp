@@ -0,0 +1,97 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/frontend/image_interface.h"
+#include "core/hle/kernel/process.h"
+#include "core/perf_stats.h"
+#include "video_core/rasterizer_cache/texture_dumper.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace VideoCore {
+
+/// Guest data waiting to be dumped is limited to this many bytes
+constexpr std::size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+TextureDumper::TextureDumper(Core::System& system)
+    : image_interface{system.GetImageInterface()},
+      dump_path{fmt::format("{}textures/{:016X}/",
+                            FileUtil::GetUserPath(FileUtil::UserPath::DumpDir),
+                            system.Kernel().GetCurrentProcess()->codeset->program_id)} {
+    FileUtil::CreateFullPath(dump_path);
+    thread = std::thread(&TextureDumper::WriterThread, this);
+}
+
+TextureDumper::~TextureDumper() {
+    // An empty request signals the writer thread to exit after draining the queue
+    queue.Push(std::nullopt);
+    thread.join();
+}
+
+bool TextureDumper::DumpTexture(const SurfaceParams& params, u64 hash,
+                                std::span<const std::byte> data) {
+    if (queued_bytes.load(std::memory_order_relaxed) + data.size() > MAX_QUEUED_BYTES) {
+        if (!warned_full) {
+            LOG_WARNING(HW_GPU, "Texture dump queue is full, textures will be dumped later");
+            warned_full = true;
+        }
+        Core::AddFrameCounter(Core::FrameCounter::TextureDumpsDropped);
+        return false;
+    }
+
+    queued_bytes += data.size();
+    queue.Push(DumpRequest{params, hash, std::vector<std::byte>(data.begin(), data.end())});
+    Core::SetFrameGauge(Core::FrameGauge::TextureDumpQueue, queue.Size());
+    return true;
+}
+
+void TextureDumper::WriterThread() {
+    Common::SetCurrentThreadName("TextureDumper");
+    while (const auto request = queue.PopWait()) {
+        WriteTexture(*request);
+        queued_bytes -= request->data.size();
+        Core::SetFrameGauge(Core::FrameGauge::TextureDumpQueue, queue.Size());
+    }
+}
+
+void TextureDumper::WriteTexture(const DumpRequest& request) const {
+    const SurfaceParams& params = request.params;
+    const std::string path =
+        fmt::format("{}tex1_{}x{}_{:016X}_{}.png", dump_path, params.width, params.height,
+                    request.hash, static_cast<u32>(params.pixel_format));
+
+    // Textures dumped in previous sessions are kept
+    if (FileUtil::Exists(path)) {
+        return;
+    }
+
+    // Surface pixel formats of textures match the PICA texture formats
+    Pica::Texture::TextureInfo info = {
+        .physical_address = params.addr,
+        .width = params.width,
+        .height = params.height,
+        .format = static_cast<Pica::TexturingRegs::TextureFormat>(params.pixel_format),
+    };
+    info.SetDefaultStride();
+
+    std::vector<u8> pixels(params.width * params.height * 4);
+    const auto source = reinterpret_cast<const u8*>(request.data.data());
+    for (u32 y = 0; y < params.height; y++) {
+        for (u32 x = 0; x < params.width; x++) {
+            const auto texel = Pica::Texture::LookupTexture(source, x, y, info);
+            std::memcpy(pixels.data() + (y * params.width + x) * 4, texel.AsArray(), 4);
+        }
+    }
+
+    if (!image_interface->EncodePNG(path, pixels, params.width, params.height)) {
+        LOG_ERROR(HW_GPU, "Failed to dump texture {}", path);
+    }
+}
+
+} // namespace VideoCore
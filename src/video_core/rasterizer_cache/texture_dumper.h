@@ -0,0 +1,65 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "video_core/rasterizer_cache/surface_params.h"
+
+namespace Core {
+class System;
+}
+
+namespace Frontend {
+class ImageInterface;
+}
+
+namespace VideoCore {
+
+/**
+ * Decodes guest textures and writes them as PNG files on a background thread, so that dumping
+ * does not stall rendering. The queue is bounded: textures queued while it is full are dropped
+ * and dumped the next time they are uploaded. Queued textures are written before destruction.
+ */
+class TextureDumper {
+public:
+    explicit TextureDumper(Core::System& system);
+    ~TextureDumper();
+
+    TextureDumper(const TextureDumper&) = delete;
+    TextureDumper& operator=(const TextureDumper&) = delete;
+
+    /// Queues the guest data of a tiled texture for dumping. Returns false if the queue is full
+    bool DumpTexture(const SurfaceParams& params, u64 hash, std::span<const std::byte> data);
+
+private:
+    struct DumpRequest {
+        SurfaceParams params;
+        u64 hash;
+        std::vector<std::byte> data;
+    };
+
+    void WriterThread();
+
+    /// Decodes the texture of the request to RGBA8 and encodes it to a PNG file
+    void WriteTexture(const DumpRequest& request) const;
+
+    std::shared_ptr<Frontend::ImageInterface> image_interface;
+    std::string dump_path;
+    std::atomic<std::size_t> queued_bytes{0};
+    bool warned_full = false;
+    Common::SPSCQueue<std::optional<DumpRequest>> queue;
+    std::thread thread;
+};
+
+} // namespace VideoCore
@@ -54,6 +54,9 @@ public:
     /// Removes as much state as possible from the rasterizer in preparation for a save/load state
     virtual void ClearAll(bool flush) = 0;
 
+    /// Notify rasterizer that a frame has been presented
+    virtual void TickFrame() {}
+
     /// Attempt to use a faster method to perform a display transfer with is_texture_copy = 0
     virtual bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
         return false;
@@ -74,6 +77,12 @@ public:
         return false;
     }
 
+    /// Returns whether a draw with this much vertex and index data fits in the buffers used by
+    /// AccelerateDrawBatch
+    virtual bool FitsDrawBatch(std::size_t vs_input_size, std::size_t index_size) const {
+        return false;
+    }
+
     /// Increase/decrease the number of surface in pages touching the specified region
     virtual void UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {}
 
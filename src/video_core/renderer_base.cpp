@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include "core/core.h"
 #include "core/frontend/emu_window.h"
+#include "core/settings.h"
 #include "video_core/renderer_base.h"
 
 RendererBase::RendererBase(Frontend::EmuWindow& window, Frontend::EmuWindow* secondary_window_)
@@ -11,6 +13,22 @@ RendererBase::RendererBase(Frontend::EmuWindow& window, Frontend::EmuWindow* sec
 
 RendererBase::~RendererBase() = default;
 
+void RendererBase::EndFrame() {
+    Core::System& system = Core::System::GetInstance();
+    system.perf_stats->EndSystemFrame();
+
+    render_window.PollEvents();
+#ifndef ANDROID
+    if (secondary_window &&
+        Settings::values.layout_option == Settings::LayoutOption::SeparateWindows) {
+        secondary_window->PollEvents();
+    }
+#endif
+
+    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
+    system.perf_stats->BeginSystemFrame();
+}
+
 void RendererBase::UpdateCurrentFramebufferLayout(bool is_portrait_mode) {
     const auto update_layout = [is_portrait_mode](Frontend::EmuWindow& window) {
         const Layout::FramebufferLayout& layout = window.GetFramebufferLayout();
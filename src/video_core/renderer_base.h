@@ -30,6 +30,12 @@ public:
     /// Finalize rendering the guest frame and draw into the presentation texture
     virtual void SwapBuffers() = 0;
 
+    /**
+     * Ends the emulated frame on the emulation thread, after its buffers were swapped: updates the
+     * performance statistics, polls the window events and paces emulation with the frame limiter.
+     */
+    void EndFrame();
+
     /// Draws the latest frame to the window waiting timeout_ms for a frame to arrive (Renderer
     /// specific implementation)
     virtual void TryPresent(int timeout_ms, bool is_secondary) = 0;
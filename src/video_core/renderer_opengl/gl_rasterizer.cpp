@@ -16,6 +16,7 @@
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/shader/shader_uniforms.h"
 #include "video_core/video_core.h"
 
 namespace OpenGL {
@@ -28,11 +29,11 @@ constexpr std::size_t TEXTURE_BUFFER_SIZE = 1 * 1024 * 1024;
 RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& emu_window, Driver& driver)
     : driver{driver}, runtime{driver}, res_cache{*this, runtime},
       shader_program_manager{emu_window, driver, !driver.IsOpenGLES()},
-      vertex_buffer{GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE},
-      uniform_buffer{GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE},
-      index_buffer{GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE},
-      texture_buffer{GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE},
-      texture_lf_buffer{GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE} {
+      vertex_buffer{GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, false, true},
+      uniform_buffer{GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false, true},
+      index_buffer{GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false, true},
+      texture_buffer{GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false, true},
+      texture_lf_buffer{GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false, true} {
 
     // Clipping plane 0 is always enabled for PICA fixed clip plane z <= 0
     state.clip_distance[0] = true;
@@ -63,6 +64,8 @@ RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& emu_window, Driver& driv
         Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
+    uniform_size_aligned_uber = Common::AlignUp<std::size_t>(sizeof(Pica::Shader::UberShaderData),
+                                                             uniform_buffer_alignment);
 
     // Set vertex attributes for software shader path
     state.draw.vertex_array = sw_vao.handle;
@@ -286,6 +289,10 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     return true;
 }
 
+bool RasterizerOpenGL::FitsDrawBatch(std::size_t vs_input_size, std::size_t index_size) const {
+    return vs_input_size <= VERTEX_BUFFER_SIZE && index_size <= INDEX_BUFFER_SIZE;
+}
+
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
@@ -624,8 +631,10 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         }
     }
 
-    // Sync and bind the shader
-    if (shader_dirty) {
+    // Sync and bind the shader. While the ubershader is in use, keep checking whether the
+    // specialized shader has finished compiling.
+    if (shader_dirty || shader_program_manager.IsUsingUberShader()) {
+        uber_shader_data_dirty |= shader_dirty;
         SetShader();
         shader_dirty = false;
     }
@@ -811,6 +820,11 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
+void RasterizerOpenGL::TickFrame() {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    res_cache.TickFrame();
+}
+
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(100, 100, 255));
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
@@ -1400,11 +1414,14 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
 
     bool sync_vs = accelerate_draw;
     bool sync_fs = uniform_block_data.dirty;
+    const bool use_uber = shader_program_manager.IsUsingUberShader();
+    bool sync_uber = use_uber && uber_shader_data_dirty;
 
-    if (!sync_vs && !sync_fs)
+    if (!sync_vs && !sync_fs && !sync_uber)
         return;
 
-    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_fs;
+    std::size_t uniform_size =
+        uniform_size_aligned_vs + uniform_size_aligned_fs + uniform_size_aligned_uber;
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
@@ -1429,6 +1446,16 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
         used_bytes += uniform_size_aligned_fs;
     }
 
+    if (sync_uber || (use_uber && invalidate)) {
+        Pica::Shader::UberShaderData uber_data;
+        uber_data.SetFromRegs(Pica::g_state.regs);
+        std::memcpy(uniforms + used_bytes, &uber_data, sizeof(uber_data));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::UberShader),
+                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(uber_data));
+        uber_shader_data_dirty = false;
+        used_bytes += uniform_size_aligned_uber;
+    }
+
     uniform_buffer.Unmap(used_bytes);
 }
 
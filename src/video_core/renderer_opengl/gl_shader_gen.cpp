@@ -12,6 +12,7 @@
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/shader/shader_uber_gen.h"
 #include "video_core/video_core.h"
 
 using Pica::FramebufferRegs;
@@ -71,6 +72,206 @@ layout (std140) uniform shader_data {
 };
 )";
 
+/// Inputs and resources shared by the fragment shaders
+constexpr std::string_view FragmentShaderDecls = R"(
+#ifndef CITRA_GLES
+in vec4 gl_FragCoord;
+#endif // CITRA_GLES
+
+layout (location = 0) out vec4 color;
+
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform samplerCube tex_cube;
+uniform samplerBuffer texture_buffer_lut_lf;
+uniform samplerBuffer texture_buffer_lut_rg;
+uniform samplerBuffer texture_buffer_lut_rgba;
+
+layout(r32ui) uniform readonly uimage2D shadow_texture_px;
+layout(r32ui) uniform readonly uimage2D shadow_texture_nx;
+layout(r32ui) uniform readonly uimage2D shadow_texture_py;
+layout(r32ui) uniform readonly uimage2D shadow_texture_ny;
+layout(r32ui) uniform readonly uimage2D shadow_texture_pz;
+layout(r32ui) uniform readonly uimage2D shadow_texture_nz;
+layout(r32ui) uniform uimage2D shadow_buffer;
+)";
+
+/// Helper functions shared by the fragment shaders. Ends with the opening of shadowTexture, which
+/// must be followed by the projection of its coordinates and FragmentShaderShadowFunctions.
+constexpr std::string_view FragmentShaderHelpers = R"(
+// Rotate the vector v by the quaternion q
+vec3 quaternion_rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+float LookupLightingLUT(int lut_index, int index, float delta) {
+    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
+    return entry.r + entry.g * delta;
+}
+
+float LookupLightingLUTUnsigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 256.0), 0, 255);
+    float delta = pos * 256.0 - float(index);
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float LookupLightingLUTSigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 128.0), -128, 127);
+    float delta = pos * 128.0 - float(index);
+    if (index < 0) index += 256;
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float byteround(float x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec2 byteround(vec2 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec3 byteround(vec3 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec4 byteround(vec4 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+// PICA's LOD formula for 2D textures.
+// This LOD formula is the same as the LOD lower limit defined in OpenGL.
+// f(x, y) >= max{m_u, m_v, m_w}
+// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
+float getLod(vec2 coord) {
+    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+    return log2(max(d.x, d.y));
+}
+
+uvec2 DecodeShadow(uint pixel) {
+    return uvec2(pixel >> 8, pixel & 0xFFu);
+}
+
+uint EncodeShadow(uvec2 pixel) {
+    return (pixel.x << 8) | pixel.y;
+}
+
+float CompareShadow(uint pixel, uint z) {
+    uvec2 p = DecodeShadow(pixel);
+    return mix(float(p.y) * (1.0 / 255.0), 0.0, p.x <= z);
+}
+
+float SampleShadow2D(ivec2 uv, uint z) {
+    if (any(bvec4( lessThan(uv, ivec2(0)), greaterThanEqual(uv, imageSize(shadow_texture_px)) )))
+        return 1.0;
+    return CompareShadow(imageLoad(shadow_texture_px, uv).x, z);
+}
+
+float mix2(vec4 s, vec2 a) {
+    vec2 t = mix(s.xy, s.zw, a.yy);
+    return mix(t.x, t.y, a.x);
+}
+
+vec4 shadowTexture(vec2 uv, float w) {
+)";
+
+/// Remainder of shadowTexture and the cube shadow lookup
+constexpr std::string_view FragmentShaderShadowFunctions = R"(
+    uint z = uint(max(0, int(min(abs(w), 1.0) * float(0xFFFFFF)) - shadow_texture_bias));
+    vec2 coord = vec2(imageSize(shadow_texture_px)) * uv - vec2(0.5);
+    vec2 coord_floor = floor(coord);
+    vec2 f = coord - coord_floor;
+    ivec2 i = ivec2(coord_floor);
+    vec4 s = vec4(
+        SampleShadow2D(i              , z),
+        SampleShadow2D(i + ivec2(1, 0), z),
+        SampleShadow2D(i + ivec2(0, 1), z),
+        SampleShadow2D(i + ivec2(1, 1), z));
+    return vec4(mix2(s, f));
+}
+
+vec4 shadowTextureCube(vec2 uv, float w) {
+    ivec2 size = imageSize(shadow_texture_px);
+    vec3 c = vec3(uv, w);
+    vec3 a = abs(c);
+    if (a.x > a.y && a.x > a.z) {
+        w = a.x;
+        uv = -c.zy;
+        if (c.x < 0.0) uv.x = -uv.x;
+    } else if (a.y > a.z) {
+        w = a.y;
+        uv = c.xz;
+        if (c.y < 0.0) uv.y = -uv.y;
+    } else {
+        w = a.z;
+        uv = -c.xy;
+        if (c.z > 0.0) uv.x = -uv.x;
+    }
+    uint z = uint(max(0, int(min(w, 1.0) * float(0xFFFFFF)) - shadow_texture_bias));
+    vec2 coord = vec2(size) * (uv / w * vec2(0.5) + vec2(0.5)) - vec2(0.5);
+    vec2 coord_floor = floor(coord);
+    vec2 f = coord - coord_floor;
+    ivec2 i00 = ivec2(coord_floor);
+    ivec2 i10 = i00 + ivec2(1, 0);
+    ivec2 i01 = i00 + ivec2(0, 1);
+    ivec2 i11 = i00 + ivec2(1, 1);
+    ivec2 cmin = ivec2(0), cmax = size - ivec2(1, 1);
+    i00 = clamp(i00, cmin, cmax);
+    i10 = clamp(i10, cmin, cmax);
+    i01 = clamp(i01, cmin, cmax);
+    i11 = clamp(i11, cmin, cmax);
+    uvec4 pixels;
+    // This part should have been refactored into functions,
+    // but many drivers don't like passing uimage2D as parameters
+    if (a.x > a.y && a.x > a.z) {
+        if (c.x > 0.0)
+            pixels = uvec4(
+                imageLoad(shadow_texture_px, i00).r,
+                imageLoad(shadow_texture_px, i10).r,
+                imageLoad(shadow_texture_px, i01).r,
+                imageLoad(shadow_texture_px, i11).r);
+        else
+            pixels = uvec4(
+                imageLoad(shadow_texture_nx, i00).r,
+                imageLoad(shadow_texture_nx, i10).r,
+                imageLoad(shadow_texture_nx, i01).r,
+                imageLoad(shadow_texture_nx, i11).r);
+    } else if (a.y > a.z) {
+        if (c.y > 0.0)
+            pixels = uvec4(
+                imageLoad(shadow_texture_py, i00).r,
+                imageLoad(shadow_texture_py, i10).r,
+                imageLoad(shadow_texture_py, i01).r,
+                imageLoad(shadow_texture_py, i11).r);
+        else
+            pixels = uvec4(
+                imageLoad(shadow_texture_ny, i00).r,
+                imageLoad(shadow_texture_ny, i10).r,
+                imageLoad(shadow_texture_ny, i01).r,
+                imageLoad(shadow_texture_ny, i11).r);
+    } else {
+        if (c.z > 0.0)
+            pixels = uvec4(
+                imageLoad(shadow_texture_pz, i00).r,
+                imageLoad(shadow_texture_pz, i10).r,
+                imageLoad(shadow_texture_pz, i01).r,
+                imageLoad(shadow_texture_pz, i11).r);
+        else
+            pixels = uvec4(
+                imageLoad(shadow_texture_nz, i00).r,
+                imageLoad(shadow_texture_nz, i10).r,
+                imageLoad(shadow_texture_nz, i01).r,
+                imageLoad(shadow_texture_nz, i11).r);
+    }
+    vec4 s = vec4(
+        CompareShadow(pixels.x, z),
+        CompareShadow(pixels.y, z),
+        CompareShadow(pixels.z, z),
+        CompareShadow(pixels.w, z));
+    return vec4(mix2(s, f));
+}
+)";
+
 static std::string GetVertexInterfaceDeclaration(bool is_output, bool separable_shader) {
     std::string out;
 
@@ -1235,207 +1436,14 @@ ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& confi
 
     out += GetVertexInterfaceDeclaration(false, separable_shader);
 
-    out += R"(
-#ifndef CITRA_GLES
-in vec4 gl_FragCoord;
-#endif // CITRA_GLES
-
-layout (location = 0) out vec4 color;
-
-uniform sampler2D tex0;
-uniform sampler2D tex1;
-uniform sampler2D tex2;
-uniform samplerCube tex_cube;
-uniform samplerBuffer texture_buffer_lut_lf;
-uniform samplerBuffer texture_buffer_lut_rg;
-uniform samplerBuffer texture_buffer_lut_rgba;
-
-layout(r32ui) uniform readonly uimage2D shadow_texture_px;
-layout(r32ui) uniform readonly uimage2D shadow_texture_nx;
-layout(r32ui) uniform readonly uimage2D shadow_texture_py;
-layout(r32ui) uniform readonly uimage2D shadow_texture_ny;
-layout(r32ui) uniform readonly uimage2D shadow_texture_pz;
-layout(r32ui) uniform readonly uimage2D shadow_texture_nz;
-layout(r32ui) uniform uimage2D shadow_buffer;
-)";
-
+    out += FragmentShaderDecls;
     out += UniformBlockDef;
 
-    out += R"(
-// Rotate the vector v by the quaternion q
-vec3 quaternion_rotate(vec4 q, vec3 v) {
-    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
-}
-
-float LookupLightingLUT(int lut_index, int index, float delta) {
-    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
-    return entry.r + entry.g * delta;
-}
-
-float LookupLightingLUTUnsigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 256.0), 0, 255);
-    float delta = pos * 256.0 - float(index);
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float LookupLightingLUTSigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 128.0), -128, 127);
-    float delta = pos * 128.0 - float(index);
-    if (index < 0) index += 256;
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float byteround(float x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec2 byteround(vec2 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec3 byteround(vec3 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec4 byteround(vec4 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-// PICA's LOD formula for 2D textures.
-// This LOD formula is the same as the LOD lower limit defined in OpenGL.
-// f(x, y) >= max{m_u, m_v, m_w}
-// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
-float getLod(vec2 coord) {
-    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
-    return log2(max(d.x, d.y));
-}
-
-uvec2 DecodeShadow(uint pixel) {
-    return uvec2(pixel >> 8, pixel & 0xFFu);
-}
-
-uint EncodeShadow(uvec2 pixel) {
-    return (pixel.x << 8) | pixel.y;
-}
-
-float CompareShadow(uint pixel, uint z) {
-    uvec2 p = DecodeShadow(pixel);
-    return mix(float(p.y) * (1.0 / 255.0), 0.0, p.x <= z);
-}
-
-float SampleShadow2D(ivec2 uv, uint z) {
-    if (any(bvec4( lessThan(uv, ivec2(0)), greaterThanEqual(uv, imageSize(shadow_texture_px)) )))
-        return 1.0;
-    return CompareShadow(imageLoad(shadow_texture_px, uv).x, z);
-}
-
-float mix2(vec4 s, vec2 a) {
-    vec2 t = mix(s.xy, s.zw, a.yy);
-    return mix(t.x, t.y, a.x);
-}
-
-vec4 shadowTexture(vec2 uv, float w) {
-)";
+    out += FragmentShaderHelpers;
     if (!config.state.shadow_texture_orthographic) {
-        out += "uv /= w;";
-    }
-    out += "uint z = uint(max(0, int(min(abs(w), 1.0) * float(0xFFFFFF)) - shadow_texture_bias));";
-    out += R"(
-    vec2 coord = vec2(imageSize(shadow_texture_px)) * uv - vec2(0.5);
-    vec2 coord_floor = floor(coord);
-    vec2 f = coord - coord_floor;
-    ivec2 i = ivec2(coord_floor);
-    vec4 s = vec4(
-        SampleShadow2D(i              , z),
-        SampleShadow2D(i + ivec2(1, 0), z),
-        SampleShadow2D(i + ivec2(0, 1), z),
-        SampleShadow2D(i + ivec2(1, 1), z));
-    return vec4(mix2(s, f));
-}
-
-vec4 shadowTextureCube(vec2 uv, float w) {
-    ivec2 size = imageSize(shadow_texture_px);
-    vec3 c = vec3(uv, w);
-    vec3 a = abs(c);
-    if (a.x > a.y && a.x > a.z) {
-        w = a.x;
-        uv = -c.zy;
-        if (c.x < 0.0) uv.x = -uv.x;
-    } else if (a.y > a.z) {
-        w = a.y;
-        uv = c.xz;
-        if (c.y < 0.0) uv.y = -uv.y;
-    } else {
-        w = a.z;
-        uv = -c.xy;
-        if (c.z > 0.0) uv.x = -uv.x;
+        out += "uv /= w;\n";
     }
-)";
-    out += "uint z = uint(max(0, int(min(w, 1.0) * float(0xFFFFFF)) - shadow_texture_bias));";
-    out += R"(
-    vec2 coord = vec2(size) * (uv / w * vec2(0.5) + vec2(0.5)) - vec2(0.5);
-    vec2 coord_floor = floor(coord);
-    vec2 f = coord - coord_floor;
-    ivec2 i00 = ivec2(coord_floor);
-    ivec2 i10 = i00 + ivec2(1, 0);
-    ivec2 i01 = i00 + ivec2(0, 1);
-    ivec2 i11 = i00 + ivec2(1, 1);
-    ivec2 cmin = ivec2(0), cmax = size - ivec2(1, 1);
-    i00 = clamp(i00, cmin, cmax);
-    i10 = clamp(i10, cmin, cmax);
-    i01 = clamp(i01, cmin, cmax);
-    i11 = clamp(i11, cmin, cmax);
-    uvec4 pixels;
-    // This part should have been refactored into functions,
-    // but many drivers don't like passing uimage2D as parameters
-    if (a.x > a.y && a.x > a.z) {
-        if (c.x > 0.0)
-            pixels = uvec4(
-                imageLoad(shadow_texture_px, i00).r,
-                imageLoad(shadow_texture_px, i10).r,
-                imageLoad(shadow_texture_px, i01).r,
-                imageLoad(shadow_texture_px, i11).r);
-        else
-            pixels = uvec4(
-                imageLoad(shadow_texture_nx, i00).r,
-                imageLoad(shadow_texture_nx, i10).r,
-                imageLoad(shadow_texture_nx, i01).r,
-                imageLoad(shadow_texture_nx, i11).r);
-    } else if (a.y > a.z) {
-        if (c.y > 0.0)
-            pixels = uvec4(
-                imageLoad(shadow_texture_py, i00).r,
-                imageLoad(shadow_texture_py, i10).r,
-                imageLoad(shadow_texture_py, i01).r,
-                imageLoad(shadow_texture_py, i11).r);
-        else
-            pixels = uvec4(
-                imageLoad(shadow_texture_ny, i00).r,
-                imageLoad(shadow_texture_ny, i10).r,
-                imageLoad(shadow_texture_ny, i01).r,
-                imageLoad(shadow_texture_ny, i11).r);
-    } else {
-        if (c.z > 0.0)
-            pixels = uvec4(
-                imageLoad(shadow_texture_pz, i00).r,
-                imageLoad(shadow_texture_pz, i10).r,
-                imageLoad(shadow_texture_pz, i01).r,
-                imageLoad(shadow_texture_pz, i11).r);
-        else
-            pixels = uvec4(
-                imageLoad(shadow_texture_nz, i00).r,
-                imageLoad(shadow_texture_nz, i10).r,
-                imageLoad(shadow_texture_nz, i01).r,
-                imageLoad(shadow_texture_nz, i11).r);
-    }
-    vec4 s = vec4(
-        CompareShadow(pixels.x, z),
-        CompareShadow(pixels.y, z),
-        CompareShadow(pixels.z, z),
-        CompareShadow(pixels.w, z));
-    return vec4(mix2(s, f));
-}
-)";
+    out += FragmentShaderShadowFunctions;
 
     if (config.state.proctex.enable)
         AppendProcTexSampler(out, config);
@@ -1583,6 +1591,36 @@ do {
     return {std::move(out)};
 }
 
+ShaderDecompiler::ProgramResult GenerateFragmentUberShader(bool separable_shader) {
+    std::string out;
+
+    if (separable_shader && !GLES) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n";
+    }
+
+    if (GLES) {
+        out += fragment_shader_precision_OES;
+    }
+
+    out += GetVertexInterfaceDeclaration(false, separable_shader);
+
+    out += FragmentShaderDecls;
+    out += UniformBlockDef;
+    out += Pica::Shader::GenerateUberShaderBlockDef("std140");
+
+    out += FragmentShaderHelpers;
+    out += "if (shadow_texture_orthographic == 0) uv /= w;\n";
+    out += FragmentShaderShadowFunctions;
+
+    out += "#define TEX0 tex0\n"
+           "#define TEX1 tex1\n"
+           "#define TEX2 tex2\n"
+           "#define TEX_CUBE tex_cube\n";
+    out += Pica::Shader::GetUberShaderMain();
+
+    return {std::move(out)};
+}
+
 ShaderDecompiler::ProgramResult GenerateTrivialVertexShader(bool separable_shader) {
     std::string out;
     if (separable_shader && !GLES) {
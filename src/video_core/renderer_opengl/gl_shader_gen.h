@@ -229,6 +229,15 @@ ShaderDecompiler::ProgramResult GenerateFixedGeometryShader(const PicaFixedGSCon
 ShaderDecompiler::ProgramResult GenerateFragmentShader(const PicaFSConfig& config,
                                                        bool separable_shader);
 
+/**
+ * Generates the GLSL fragment ubershader program source code. Instead of baking the Pica state
+ * into the code, it reads it from the uber_data uniform block, so a single program can render any
+ * configuration accepted by Pica::Shader::CanUseUberShader.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+ShaderDecompiler::ProgramResult GenerateFragmentUberShader(bool separable_shader);
+
 } // namespace OpenGL
 
 namespace std {
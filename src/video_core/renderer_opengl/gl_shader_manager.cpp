@@ -3,15 +3,22 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/variant.hpp>
+#include "common/thread_worker.h"
+#include "core/frontend/emu_window.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_driver.h"
+#include "video_core/shader/shader_uniforms.h"
 #include "video_core/video_core.h"
 
 namespace OpenGL {
@@ -102,6 +109,8 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
     SetShaderUniformBlockBinding(shader, "shader_data", UniformBindings::Common,
                                  sizeof(UniformData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
+    SetShaderUniformBlockBinding(shader, "uber_data", UniformBindings::UberShader,
+                                 sizeof(Pica::Shader::UberShaderData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -235,12 +244,17 @@ public:
         OGLShaderStage& cached_shader = iter->second;
         std::optional<ShaderDecompiler::ProgramResult> result{};
         if (new_shader) {
+            Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
             result = CodeGenerator(config, separable);
             cached_shader.Create(result->code.c_str(), ShaderType);
         }
         return {cached_shader.GetHandle(), std::move(result)};
     }
 
+    bool Contains(const KeyConfigType& key) const {
+        return shaders.contains(key);
+    }
+
     void Inject(const KeyConfigType& key, OGLProgram&& program) {
         OGLShaderStage stage{separable};
         stage.Inject(std::move(program));
@@ -283,6 +297,7 @@ public:
             auto [iter, new_shader] = shader_cache.emplace(program, OGLShaderStage{separable});
             OGLShaderStage& cached_shader = iter->second;
             if (new_shader) {
+                Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
                 result.emplace();
                 result->code = program;
                 cached_shader.Create(program.c_str(), ShaderType);
@@ -337,6 +352,76 @@ public:
         }
     }
 
+    ~Impl() {
+        if (compile_worker) {
+            // Skip the queued shaders and release the context on the thread that holds it
+            stop_compiling = true;
+            compile_worker->QueueWork([this] { compile_context->DoneCurrent(); });
+            compile_worker.reset();
+        }
+    }
+
+    /// A fragment shader compiled in the background, waiting to be added to the cache
+    struct CompiledFragmentShader {
+        PicaFSConfig config;
+        ShaderDiskCacheRaw raw;
+        ShaderDecompiler::ProgramResult result;
+        OGLProgram program;
+    };
+
+    void EnableAsyncCompilation(std::unique_ptr<Frontend::GraphicsContext> context) {
+        uber_shader.emplace(separable);
+        uber_shader->Create(GenerateFragmentUberShader(separable).code.c_str(),
+                            GL_FRAGMENT_SHADER);
+        compile_context = std::move(context);
+        compile_worker = std::make_unique<Common::ThreadWorker>(1, "ShaderCompiler");
+        compile_worker->QueueWork([this] { compile_context->MakeCurrent(); });
+    }
+
+    void QueueFragmentShader(const PicaFSConfig& config, const Pica::Regs& regs) {
+        if (!pending_fragment_shaders.insert(config).second) {
+            return;
+        }
+        const u64 unique_identifier = GetUniqueIdentifier(regs, {});
+        ShaderDiskCacheRaw raw{unique_identifier, ProgramType::FS, regs, {}};
+        compile_worker->QueueWork([this, config, raw = std::move(raw)]() mutable {
+            if (stop_compiling) {
+                return;
+            }
+            auto result = GenerateFragmentShader(config, separable);
+            OGLShader shader;
+            shader.Create(result.code.c_str(), GL_FRAGMENT_SHADER);
+            OGLProgram program;
+            program.Create(true, {shader.handle});
+            // Make sure the program is complete before it is used from the render context
+            glFinish();
+            Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
+
+            std::scoped_lock lock{compiled_mutex};
+            compiled_fragment_shaders.push_back(
+                {config, std::move(raw), std::move(result), std::move(program)});
+        });
+    }
+
+    /// Adds the fragment shaders compiled in the background to the cache
+    void InjectCompiledFragmentShaders() {
+        std::vector<CompiledFragmentShader> compiled;
+        {
+            std::scoped_lock lock{compiled_mutex};
+            compiled.swap(compiled_fragment_shaders);
+        }
+        for (auto& shader : compiled) {
+            pending_fragment_shaders.erase(shader.config);
+            // Failed shaders are cached too, as they would be when compiled on demand
+            const bool valid = shader.program.handle != 0;
+            fragment_shaders.Inject(shader.config, std::move(shader.program));
+            if (valid) {
+                disk_cache.SaveRaw(shader.raw);
+                disk_cache.SaveDecompiled(shader.raw.GetUniqueIdentifier(), shader.result, false);
+            }
+        }
+    }
+
     struct ShaderTuple {
         std::size_t vs_hash = 0;
         std::size_t gs_hash = 0;
@@ -372,10 +457,41 @@ public:
     std::unordered_map<u64, OGLProgram> program_cache;
     OGLPipeline pipeline;
     ShaderDiskCache disk_cache;
+
+    std::optional<OGLShaderStage> uber_shader;
+    bool using_uber_shader = false;
+    std::unordered_set<PicaFSConfig> pending_fragment_shaders;
+    std::mutex compiled_mutex;
+    std::vector<CompiledFragmentShader> compiled_fragment_shaders;
+    std::atomic_bool stop_compiling{false};
+    std::unique_ptr<Frontend::GraphicsContext> compile_context;
+    // Declared last so that it is destroyed before the state its work items use
+    std::unique_ptr<Common::ThreadWorker> compile_worker;
 };
 
 ShaderProgramManager::ShaderProgramManager(Frontend::EmuWindow& emu_window_, Driver& driver, bool separable)
-    : impl(std::make_unique<Impl>(separable)), emu_window{emu_window_}, driver{driver} {}
+    : impl(std::make_unique<Impl>(separable)), emu_window{emu_window_}, driver{driver} {
+    // Background compilation relies on separable programs, which can be linked without the
+    // other stages of the pipeline
+    if (!separable || !Settings::values.async_shader_compilation) {
+        return;
+    }
+
+    emu_window.SaveContext();
+    // On some platforms the shared context has to be created from the GUI thread
+    auto context = emu_window.CreateSharedContext();
+    if (context) {
+        // Release the context, so it can be immediately used by the compiler thread
+        context->DoneCurrent();
+    }
+    emu_window.RestoreContext();
+
+    if (!context) {
+        LOG_WARNING(Render_OpenGL, "Shared contexts are unavailable, compiling shaders on demand");
+        return;
+    }
+    impl->EnableAsyncCompilation(std::move(context));
+}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
@@ -422,6 +538,20 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
 
 void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     PicaFSConfig config = PicaFSConfig::BuildFromRegs(regs);
+    if (impl->compile_worker) {
+        impl->InjectCompiledFragmentShaders();
+        // Render with the ubershader until the specialized shader is ready
+        if (!impl->fragment_shaders.Contains(config) && Pica::Shader::CanUseUberShader(regs)) {
+            impl->QueueFragmentShader(config, regs);
+            impl->current.fs = impl->uber_shader->GetHandle();
+            impl->current.fs_hash = 0;
+            impl->using_uber_shader = true;
+            Core::AddFrameCounter(Core::FrameCounter::UberShaderDraws);
+            return;
+        }
+    }
+    impl->using_uber_shader = false;
+
     auto [handle, result] = impl->fragment_shaders.Get(config);
     impl->current.fs = handle;
     impl->current.fs_hash = config.Hash();
@@ -435,6 +565,10 @@ void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     }
 }
 
+bool ShaderProgramManager::IsUsingUberShader() const {
+    return impl->using_uber_shader;
+}
+
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
     if (impl->separable) {
         if (driver.HasBug(DriverBug::ShaderStageChangeFreeze)) {
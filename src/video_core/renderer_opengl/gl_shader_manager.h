@@ -28,7 +28,7 @@ struct ShaderSetup;
 
 namespace OpenGL {
 
-enum class UniformBindings : u32 { Common, VS, GS };
+enum class UniformBindings : u32 { Common, VS, GS, UberShader };
 
 struct LightSrc {
     alignas(16) Common::Vec3f specular_0;
@@ -129,6 +129,10 @@ public:
 
     void UseFragmentShader(const Pica::Regs& config);
 
+    /// Returns whether the last UseFragmentShader call selected the fragment ubershader because
+    /// the specialized shader is still being compiled
+    bool IsUsingUberShader() const;
+
     void ApplyTo(OpenGLState& state);
 
 private:
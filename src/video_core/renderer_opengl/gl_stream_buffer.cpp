@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/microprofile.h"
@@ -13,7 +14,8 @@ MICROPROFILE_DEFINE(OpenGL_StreamBuffer, "OpenGL", "Stream Buffer Orphaning",
 namespace OpenGL {
 
 OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size, bool readback, bool prefer_coherent)
-    : gl_target(target), buffer_size(size) {
+    : gl_target(target), readback(readback), buffer_size(size),
+      region_size(size / static_cast<GLsizeiptr>(SYNC_REGIONS)) {
     gl_buffer.Create();
     glBindBuffer(gl_target, gl_buffer.handle);
 
@@ -51,21 +53,33 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
     ASSERT(alignment <= buffer_size);
     mapped_size = size;
 
+    // Readback buffers are synchronized by their users, who wait on fences before reading
+    const bool use_fences = persistent && !readback;
+
+    // The commands reading the previous chunk have been issued by now, so the regions it
+    // completed can be fenced
+    if (use_fences) {
+        FenceRegions(static_cast<std::size_t>(buffer_pos / region_size));
+    }
+
     if (alignment > 0) {
         buffer_pos = Common::AlignUp<std::size_t>(buffer_pos, alignment);
     }
 
     bool invalidate = false;
     if (buffer_pos + size > buffer_size) {
+        // Fence the tail of the buffer before starting over from its beginning
+        if (use_fences) {
+            FenceRegions(SYNC_REGIONS);
+            used_region = 0;
+        }
         buffer_pos = 0;
         invalidate = true;
-
-        if (persistent) {
-            glUnmapBuffer(gl_target);
-        }
     }
 
-    if (invalidate || !persistent) {
+    if (use_fences) {
+        WaitRegions(buffer_pos, size);
+    } else if (!persistent) {
         MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
         GLbitfield flags = (readback ? GL_MAP_READ_BIT : GL_MAP_WRITE_BIT) | (persistent ? GL_MAP_PERSISTENT_BIT : 0) |
                            (coherent ? GL_MAP_COHERENT_BIT : 0) | (!coherent && !readback ? GL_MAP_FLUSH_EXPLICIT_BIT : 0) |
@@ -92,4 +106,29 @@ void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     buffer_pos += size;
 }
 
+void OGLStreamBuffer::FenceRegions(std::size_t end_region) {
+    end_region = std::min(end_region, SYNC_REGIONS);
+    for (; used_region < end_region; used_region++) {
+        fences[used_region].Create();
+    }
+}
+
+void OGLStreamBuffer::WaitRegions(GLintptr begin, GLsizeiptr size) {
+    if (size == 0) {
+        return;
+    }
+
+    const std::size_t first_region = static_cast<std::size_t>(begin / region_size);
+    const std::size_t last_region =
+        std::min(static_cast<std::size_t>((begin + size - 1) / region_size), SYNC_REGIONS - 1);
+    for (std::size_t region = first_region; region <= last_region; region++) {
+        if (fences[region]) {
+            MICROPROFILE_SCOPE(OpenGL_StreamBuffer);
+            glClientWaitSync(fences[region].handle, GL_SYNC_FLUSH_COMMANDS_BIT,
+                             GL_TIMEOUT_IGNORED);
+            fences[region].Release();
+        }
+    }
+}
+
 } // namespace OpenGL
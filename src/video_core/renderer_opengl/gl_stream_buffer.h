@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #pragma once
+#include <array>
 #include <tuple>
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 
@@ -19,7 +20,9 @@ public:
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
-     * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
+     * If the buffer is full, allocation starts over from its beginning which invalidates old
+     * chunks. Persistent buffers wait for the GPU to be done with the reused memory, others
+     * are reallocated.
      * The return values are the pointer to the new chunk, the offset within the buffer,
      * and the invalidation flag for previous chunks.
      * The actual used size must be specified on unmapping the chunk.
@@ -29,6 +32,16 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    /// Persistent buffers are split into regions that are each guarded by a fence once written.
+    /// The fences are inserted by the next Map, after the commands using the data are issued.
+    static constexpr std::size_t SYNC_REGIONS = 16;
+
+    /// Inserts fences for the regions written since the last call, up to end_region
+    void FenceRegions(std::size_t end_region);
+
+    /// Waits for the GPU to be done with the regions overlapping the range about to be written
+    void WaitRegions(GLintptr begin, GLsizeiptr size);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
 
@@ -41,6 +54,10 @@ private:
     GLintptr mapped_offset = 0;
     GLsizeiptr mapped_size = 0;
     u8* mapped_ptr = nullptr;
+
+    GLsizeiptr region_size = 0;
+    std::size_t used_region = 0;
+    std::array<OGLSync, SYNC_REGIONS> fences;
 };
 
 } // namespace OpenGL
@@ -84,6 +84,30 @@ StagingData TextureRuntime::FindStaging(u32 size, bool upload) {
                        .buffer_offset = offset};
 }
 
+u64 TextureRuntime::SubmitDownloads() {
+    // Make the pixels written to the persistently mapped download buffer visible to the host
+    if (GLAD_GL_ARB_buffer_storage) {
+        glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+    }
+
+    OGLSync fence;
+    fence.Create();
+    glFlush();
+    download_fences.emplace_back(++download_fence_counter, std::move(fence));
+    return download_fence_counter;
+}
+
+void TextureRuntime::WaitDownloads(u64 fence) {
+    // Fences signal in order, so older ones are done once the requested one is
+    while (!download_fences.empty() && download_fences.front().first <= fence) {
+        auto& [id, sync] = download_fences.front();
+        if (id == fence) {
+            glClientWaitSync(sync.handle, 0, GL_TIMEOUT_IGNORED);
+        }
+        download_fences.pop_front();
+    }
+}
+
 const FormatTuple& TextureRuntime::GetFormatTuple(VideoCore::PixelFormat pixel_format) {
     const auto type = GetFormatType(pixel_format);
     const std::size_t format_index = static_cast<std::size_t>(pixel_format);
@@ -101,8 +125,8 @@ const FormatTuple& TextureRuntime::GetFormatTuple(VideoCore::PixelFormat pixel_f
     return DEFAULT_TUPLE;
 }
 
-void TextureRuntime::FormatConvert(const Surface& surface, bool upload, std::span<std::byte> source,
-                                   std::span<std::byte> dest) {
+void TextureRuntime::FormatConvert(const Surface& surface, bool upload,
+                                   std::span<const std::byte> source, std::span<std::byte> dest) {
     const VideoCore::PixelFormat format = surface.pixel_format;
     if (format == VideoCore::PixelFormat::RGBA8 && driver.IsOpenGLES()) {
         return Pica::Texture::ConvertABGRToRGBA(source, dest);
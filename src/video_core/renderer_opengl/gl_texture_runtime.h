@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #pragma once
+#include <deque>
 #include <set>
 #include <span>
 #include "video_core/rasterizer_cache/rasterizer_cache.h"
@@ -49,8 +50,19 @@ public:
 
     void Finish() const {}
 
+    /// Inserts a fence after the recorded downloads and returns its id
+    u64 SubmitDownloads();
+
+    /// Blocks until the downloads recorded before the fence are complete
+    void WaitDownloads(u64 fence);
+
+    /// Frees the textures of destroyed surfaces that were kept around for reuse
+    void ReleaseRecycledTextures() {
+        texture_recycler.clear();
+    }
+
     /// Performs required format convertions on the staging data
-    void FormatConvert(const Surface& surface, bool upload, std::span<std::byte> source,
+    void FormatConvert(const Surface& surface, bool upload, std::span<const std::byte> source,
                        std::span<std::byte> dest);
 
     /// Allocates an OpenGL texture with the specified dimentions and format
@@ -104,6 +116,8 @@ private:
     std::array<ReinterpreterList, VideoCore::PIXEL_FORMAT_COUNT> reinterpreters;
     std::unordered_multimap<VideoCore::HostTextureTag, OGLTexture> texture_recycler;
     OGLStreamBuffer upload_buffer, download_buffer;
+    std::deque<std::pair<u64, OGLSync>> download_fences;
+    u64 download_fence_counter = 0;
     OGLFramebuffer read_fbo, draw_fbo;
 };
 
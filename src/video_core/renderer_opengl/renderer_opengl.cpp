@@ -411,7 +411,6 @@ void RendererOpenGL::SwapBuffers() {
         ASSERT(secondary_window);
         const auto& secondary_layout = secondary_window->GetFramebufferLayout();
         RenderToMailbox(secondary_layout, secondary_window->mailbox, false);
-        secondary_window->PollEvents();
     }
 #endif
     if (frame_dumper.IsDumping()) {
@@ -422,16 +421,9 @@ void RendererOpenGL::SwapBuffers() {
         }
     }
 
+    rasterizer->TickFrame();
     m_current_frame++;
 
-    Core::System& system = Core::System::GetInstance();
-    system.perf_stats->EndSystemFrame();
-
-    render_window.PollEvents();
-
-    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
-    system.perf_stats->BeginSystemFrame();
-
     prev_state.Apply();
 
     if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
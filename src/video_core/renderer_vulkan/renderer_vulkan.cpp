@@ -1002,16 +1002,9 @@ void RendererVulkan::SwapBuffers() {
     scheduler.Flush(present_ready, image_acquired);
     swapchain.Present();
 
+    rasterizer.TickFrame();
     m_current_frame++;
 
-    Core::System& system = Core::System::GetInstance();
-    system.perf_stats->EndSystemFrame();
-
-    render_window.PollEvents();
-
-    system.frame_limiter.DoFrameLimiting(system.CoreTiming().GetGlobalTimeUs());
-    system.perf_stats->BeginSystemFrame();
-
     if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
         Pica::g_debug_context->recorder->FrameFinished();
     }
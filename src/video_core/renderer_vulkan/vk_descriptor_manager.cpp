@@ -19,8 +19,9 @@ constexpr static std::array RASTERIZER_SETS = {
              .bindings = {vk::DescriptorType::eUniformBuffer, vk::DescriptorType::eUniformBuffer,
                           vk::DescriptorType::eUniformTexelBuffer,
                           vk::DescriptorType::eUniformTexelBuffer,
-                          vk::DescriptorType::eUniformTexelBuffer},
-             .binding_count = 5},
+                          vk::DescriptorType::eUniformTexelBuffer,
+                          vk::DescriptorType::eUniformBuffer},
+             .binding_count = 6},
     Bindings{// Texture set
              .bindings = {vk::DescriptorType::eSampledImage, vk::DescriptorType::eSampledImage,
                           vk::DescriptorType::eSampledImage, vk::DescriptorType::eSampledImage},
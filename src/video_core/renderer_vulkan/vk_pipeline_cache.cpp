@@ -2,11 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <filesystem>
+#include <functional>
+#include <thread>
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/microprofile.h"
 #include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/thread_worker.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "video_core/renderer_vulkan/pica_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -14,9 +22,25 @@
 #include "video_core/renderer_vulkan/vk_renderpass_cache.h"
 #include "video_core/renderer_vulkan/vk_descriptor_manager.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/shader/shader_uniforms.h"
 
 namespace Vulkan {
 
+/// Shader hash of the fragment ubershader, used to tell its pipelines apart
+constexpr u64 UBER_SHADER_HASH = 0xFFFFFFFFFFFFFFFFULL;
+
+constexpr u32 PipelineListVersion = 1;
+
+using ShaderCacheVersionHash = std::array<u8, 64>;
+
+// The recorded shader configs are only valid for the shader generators they were created with
+ShaderCacheVersionHash GetShaderCacheVersionHash() {
+    ShaderCacheVersionHash hash{};
+    const std::size_t length = std::min(std::strlen(Common::g_shader_cache_version), hash.size());
+    std::memcpy(hash.data(), Common::g_shader_cache_version, length);
+    return hash;
+}
+
 u32 AttribBytes(Pica::PipelineRegs::VertexAttributeFormat format, u32 size) {
     switch (format) {
     case Pica::PipelineRegs::VertexAttributeFormat::FLOAT:
@@ -64,6 +88,9 @@ vk::ShaderStageFlagBits ToVkShaderStage(std::size_t index) {
 
 [[nodiscard]] bool IsAttribFormatSupported(const VertexAttribute& attrib, const Instance& instance) {
     static std::unordered_map<vk::Format, bool> format_support_cache;
+    // Pipelines are built from several threads
+    static std::mutex format_support_mutex;
+    std::scoped_lock lock{format_support_mutex};
 
     vk::PhysicalDevice physical_device = instance.GetPhysicalDevice();
     const vk::Format format = ToVkAttributeFormat(attrib.type, attrib.size);
@@ -82,11 +109,33 @@ PipelineCache::PipelineCache(const Instance& instance, Scheduler& scheduler,
     : instance{instance}, scheduler{scheduler}, renderpass_cache{renderpass_cache}, desc_manager{desc_manager} {
     trivial_vertex_shader = Compile(GenerateTrivialVertexShader(), vk::ShaderStageFlagBits::eVertex,
                                     instance.GetDevice(), ShaderOptimization::Debug);
+
+    if (Settings::values.async_shader_compilation) {
+        // SPIR-V fragment shaders are cheap enough to be generated on demand
+        if (!Settings::values.spirv_shader_gen) {
+            uber_shader = Compile(GenerateFragmentUberShader(), vk::ShaderStageFlagBits::eFragment,
+                                  instance.GetDevice(), ShaderOptimization::High);
+        }
+        const std::size_t num_workers = std::max(1U, std::thread::hardware_concurrency() / 2);
+        compile_worker = std::make_unique<Common::ThreadWorker>(num_workers, "ShaderCompiler");
+    }
 }
 
 PipelineCache::~PipelineCache() {
     vk::Device device = instance.GetDevice();
 
+    if (compile_worker) {
+        stop_compiling = true;
+        compile_worker.reset();
+        for (const auto& [config, module] : compiled_fragment_shaders) {
+            device.destroyShaderModule(module);
+        }
+        for (const auto& [hash, pipeline] : built_pipelines) {
+            device.destroyPipeline(pipeline);
+        }
+    }
+    device.destroyShaderModule(uber_shader);
+
     SaveDiskCache();
 
     device.destroyPipelineCache(pipeline_cache);
@@ -115,7 +164,8 @@ PipelineCache::~PipelineCache() {
     graphics_pipelines.clear();
 }
 
-void PipelineCache::LoadDiskCache() {
+void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
+                                  const VideoCore::DiskResourceLoadCallback& callback) {
     if (!Settings::values.use_disk_shader_cache || !EnsureDirectories()) {
         return;
     }
@@ -145,6 +195,10 @@ void PipelineCache::LoadDiskCache() {
 
     vk::Device device = instance.GetDevice();
     pipeline_cache = device.createPipelineCache(cache_info);
+
+    pipeline_list_path = GetPipelineListPath();
+    LoadPipelineList();
+    BuildRecordedPipelines(stop_loading, callback);
 }
 
 void PipelineCache::SaveDiskCache() {
@@ -152,6 +206,8 @@ void PipelineCache::SaveDiskCache() {
         return;
     }
 
+    SavePipelineList();
+
     const std::string cache_file_path = fmt::format("{}{:x}{:x}.bin", GetPipelineCacheDir(),
                                                     instance.GetVendorID(), instance.GetDeviceID());
     FileUtil::IOFile cache_file{cache_file_path, "wb"};
@@ -174,25 +230,42 @@ void PipelineCache::BindPipeline(const PipelineInfo& info) {
     ApplyDynamic(info);
 
     scheduler.Record([this, info](vk::CommandBuffer render_cmdbuf, vk::CommandBuffer) {
-        std::size_t shader_hash = 0;
-        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
-            shader_hash = Common::HashCombine(shader_hash, shader_hashes[i]);
+        if (compile_worker) {
+            InjectCompiledPipelines();
         }
 
-        const u64 info_hash_size = instance.IsExtendedDynamicStateSupported()
-                                       ? offsetof(PipelineInfo, rasterization)
-                                       : offsetof(PipelineInfo, dynamic);
-
-        u64 info_hash = Common::ComputeHash64(&info, info_hash_size);
-        u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
+        const bool uber_fs = shader_hashes[ProgramType::FS] == UBER_SHADER_HASH;
+        const u64 pipeline_hash = ComputePipelineHash(info, shader_hashes);
+        auto it = graphics_pipelines.find(pipeline_hash);
+        if (it == graphics_pipelines.end()) {
+            // Ubershader pipelines are only needed until the specialized shader is ready
+            if (!uber_fs) {
+                recorded_pipelines.push_back(PipelineKey{info, shader_hashes});
+            }
+            // Pipelines are built in the background only when the ubershader can stand in for
+            // them. The ubershader pipelines themselves are the fallback, so they are built here.
+            if (compile_worker && !uber_fs && fs_uber_compatible) {
+                QueuePipeline(pipeline_hash, info);
+                it = graphics_pipelines.emplace(pipeline_hash, vk::Pipeline{}).first;
+            } else if (const vk::Pipeline pipeline = BuildPipeline(info, current_shaders)) {
+                it = graphics_pipelines.emplace(pipeline_hash, pipeline).first;
+            }
+        }
 
-        auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash, vk::Pipeline{});
-        if (new_pipeline) {
-            it->second = BuildPipeline(info);
+        if (it != graphics_pipelines.end() && it->second) {
+            current_pipeline = it->second;
+        } else if (it != graphics_pipelines.end()) {
+            // The pipeline is still being built, render with the ubershader in the meantime
+            current_pipeline = GetUberShaderPipeline(info);
+            Core::AddFrameCounter(Core::FrameCounter::UberShaderDraws);
+        } else {
+            // Building failed, the next bind retries it
+            current_pipeline = VK_NULL_HANDLE;
         }
 
-        render_cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, it->second);
-        current_pipeline = it->second;
+        if (current_pipeline) {
+            render_cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, current_pipeline);
+        }
     });
 
     desc_manager.BindDescriptorSets();
@@ -223,7 +296,12 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::Regs& regs,
         return false;
     }
 
-    scheduler.Record([this, handle = handle, hash = config.Hash()](vk::CommandBuffer, vk::CommandBuffer) {
+    scheduler.Record([this, handle = handle, hash = config.Hash(), state = config.state,
+                      code = std::move(result)](vk::CommandBuffer, vk::CommandBuffer) {
+        // The source is only returned the first time the config is used
+        if (code) {
+            recorded_vs.try_emplace(hash, state, *code);
+        }
         current_shaders[ProgramType::VS] = handle;
         shader_hashes[ProgramType::VS] = hash;
     });
@@ -244,8 +322,10 @@ void PipelineCache::UseFixedGeometryShader(const Pica::Regs& regs) {
     scheduler.Record([this, gs_config](vk::CommandBuffer, vk::CommandBuffer) {
         vk::ShaderModule handle = fixed_geometry_shaders.Get(gs_config, vk::ShaderStageFlagBits::eGeometry,
                                                              instance.GetDevice(), ShaderOptimization::High);
+        const u64 hash = gs_config.Hash();
+        recorded_gs.try_emplace(hash, gs_config.state);
         current_shaders[ProgramType::GS] = handle;
-        shader_hashes[ProgramType::GS] = gs_config.Hash();
+        shader_hashes[ProgramType::GS] = hash;
     });
 }
 
@@ -259,23 +339,120 @@ void PipelineCache::UseTrivialGeometryShader() {
 MICROPROFILE_DEFINE(Vulkan_FragmentGeneration, "Vulkan", "Fragment Shader Compilation", MP_RGB(255, 100, 100));
 void PipelineCache::UseFragmentShader(const Pica::Regs& regs) {
     const PicaFSConfig config{regs, instance};
+    // Logic op emulation is only implemented by the specialized shaders
+    const bool can_use_uber_shader = uber_shader && Pica::Shader::CanUseUberShader(regs) &&
+                                     !config.state.emulate_logic_op;
 
-    scheduler.Record([this, config](vk::CommandBuffer, vk::CommandBuffer) {
+    scheduler.Record([this, config, can_use_uber_shader](vk::CommandBuffer, vk::CommandBuffer) {
         MICROPROFILE_SCOPE(Vulkan_FragmentGeneration);
 
+        const u64 hash = config.Hash();
+        recorded_fs.try_emplace(hash, config.state);
+
+        // Only the GLSL shaders have the ubershader as a fallback
+        fs_uber_compatible = can_use_uber_shader && !Settings::values.spirv_shader_gen;
+
         vk::ShaderModule handle{};
         if (Settings::values.spirv_shader_gen) {
             handle = fragment_shaders_spv.Get(config, instance.GetDevice());
         } else {
+            if (uber_shader) {
+                InjectCompiledFragmentShaders();
+                // Render with the ubershader until the specialized shader is ready
+                if (can_use_uber_shader && !fragment_shaders_glsl.shaders.contains(config)) {
+                    QueueFragmentShader(config);
+                    current_shaders[ProgramType::FS] = uber_shader;
+                    shader_hashes[ProgramType::FS] = UBER_SHADER_HASH;
+                    using_uber_shader.store(true, std::memory_order_relaxed);
+                    Core::AddFrameCounter(Core::FrameCounter::UberShaderDraws);
+                    return;
+                }
+            }
             handle = fragment_shaders_glsl.Get(config, vk::ShaderStageFlagBits::eFragment,
                                               instance.GetDevice(), ShaderOptimization::High);
         }
 
+        using_uber_shader.store(false, std::memory_order_relaxed);
         current_shaders[ProgramType::FS] = handle;
-        shader_hashes[ProgramType::FS] = config.Hash();
+        shader_hashes[ProgramType::FS] = hash;
+    });
+}
+
+void PipelineCache::QueueFragmentShader(const PicaFSConfig& config) {
+    if (!pending_fragment_shaders.insert(config).second) {
+        return;
+    }
+    compile_worker->QueueWork([this, config] {
+        if (stop_compiling) {
+            return;
+        }
+        const vk::ShaderModule module =
+            Compile(GenerateFragmentShader(config), vk::ShaderStageFlagBits::eFragment,
+                    instance.GetDevice(), ShaderOptimization::High);
+        Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
+
+        std::scoped_lock lock{compiled_mutex};
+        compiled_fragment_shaders.emplace_back(config, module);
+    });
+}
+
+void PipelineCache::InjectCompiledFragmentShaders() {
+    std::vector<std::pair<PicaFSConfig, vk::ShaderModule>> compiled;
+    {
+        std::scoped_lock lock{compiled_mutex};
+        compiled.swap(compiled_fragment_shaders);
+    }
+    for (auto& [config, module] : compiled) {
+        pending_fragment_shaders.erase(config);
+        fragment_shaders_glsl.Inject(config, std::move(module));
+    }
+}
+
+void PipelineCache::QueuePipeline(u64 pipeline_hash, const PipelineInfo& info) {
+    compile_worker->QueueWork([this, pipeline_hash, info, shaders = current_shaders] {
+        if (stop_compiling) {
+            return;
+        }
+        const vk::Pipeline pipeline = BuildPipeline(info, shaders);
+
+        std::scoped_lock lock{built_mutex};
+        built_pipelines.emplace_back(pipeline_hash, pipeline);
     });
 }
 
+void PipelineCache::InjectCompiledPipelines() {
+    std::vector<std::pair<u64, vk::Pipeline>> built;
+    {
+        std::scoped_lock lock{built_mutex};
+        built.swap(built_pipelines);
+    }
+    for (const auto& [pipeline_hash, pipeline] : built) {
+        if (pipeline) {
+            graphics_pipelines[pipeline_hash] = pipeline;
+        } else {
+            // Forget the failed pipeline so that the next bind queues it again
+            graphics_pipelines.erase(pipeline_hash);
+        }
+    }
+}
+
+vk::Pipeline PipelineCache::GetUberShaderPipeline(const PipelineInfo& info) {
+    std::array<u64, MAX_SHADER_STAGES> hashes = shader_hashes;
+    hashes[ProgramType::FS] = UBER_SHADER_HASH;
+    const u64 pipeline_hash = ComputePipelineHash(info, hashes);
+    if (const auto it = graphics_pipelines.find(pipeline_hash); it != graphics_pipelines.end()) {
+        return it->second;
+    }
+
+    std::array<vk::ShaderModule, MAX_SHADER_STAGES> shaders = current_shaders;
+    shaders[ProgramType::FS] = uber_shader;
+    const vk::Pipeline pipeline = BuildPipeline(info, shaders);
+    if (pipeline) {
+        graphics_pipelines.emplace(pipeline_hash, pipeline);
+    }
+    return pipeline;
+}
+
 void PipelineCache::BindTexture(u32 binding, vk::ImageView image_view) {
     const vk::DescriptorImageInfo image_info = {
         .imageView = image_view, .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal};
@@ -404,13 +581,29 @@ void PipelineCache::ApplyDynamic(const PipelineInfo& info) {
     }
 }
 
-vk::Pipeline PipelineCache::BuildPipeline(const PipelineInfo& info) {
+u64 PipelineCache::ComputePipelineHash(const PipelineInfo& info,
+                                       const std::array<u64, MAX_SHADER_STAGES>& hashes) const {
+    std::size_t shader_hash = 0;
+    for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+        shader_hash = Common::HashCombine(shader_hash, hashes[i]);
+    }
+
+    const u64 info_hash_size = instance.IsExtendedDynamicStateSupported()
+                                   ? offsetof(PipelineInfo, rasterization)
+                                   : offsetof(PipelineInfo, dynamic);
+
+    const u64 info_hash = Common::ComputeHash64(&info, info_hash_size);
+    return Common::HashCombine(shader_hash, info_hash);
+}
+
+vk::Pipeline PipelineCache::BuildPipeline(
+    const PipelineInfo& info, const std::array<vk::ShaderModule, MAX_SHADER_STAGES>& shaders) {
     vk::Device device = instance.GetDevice();
 
     u32 shader_count = 0;
     std::array<vk::PipelineShaderStageCreateInfo, MAX_SHADER_STAGES> shader_stages;
-    for (std::size_t i = 0; i < current_shaders.size(); i++) {
-        vk::ShaderModule shader = current_shaders[i];
+    for (std::size_t i = 0; i < shaders.size(); i++) {
+        vk::ShaderModule shader = shaders[i];
         if (!shader) {
             continue;
         }
@@ -569,13 +762,332 @@ vk::Pipeline PipelineCache::BuildPipeline(const PipelineInfo& info) {
         result.result == vk::Result::eSuccess) {
         return result.value;
     } else {
-        LOG_CRITICAL(Render_Vulkan, "Graphics pipeline creation failed!");
-        UNREACHABLE();
+        LOG_CRITICAL(Render_Vulkan, "Graphics pipeline creation failed: {}",
+                     vk::to_string(result.result));
     }
 
     return VK_NULL_HANDLE;
 }
 
+void PipelineCache::BuildRecordedPipelines(const std::atomic_bool& stop_loading,
+                                           const VideoCore::DiskResourceLoadCallback& callback) {
+    if (recorded_pipelines.empty()) {
+        return;
+    }
+
+    vk::Device device = instance.GetDevice();
+    const std::size_t num_workers = std::max(1U, std::thread::hardware_concurrency());
+    Common::ThreadWorker workers{num_workers, "PipelineBuilder"};
+
+    // Runs the jobs in batches, so that progress is reported and loading can be stopped
+    const auto run_batched = [&](std::size_t count, VideoCore::LoadCallbackStage stage,
+                                 const std::function<void(std::size_t)>& job) {
+        const std::size_t batch_size = workers.NumWorkers() * 4;
+        if (callback) {
+            callback(stage, 0, count);
+        }
+        for (std::size_t begin = 0; begin < count && !stop_loading; begin += batch_size) {
+            const std::size_t end = std::min(begin + batch_size, count);
+            for (std::size_t i = begin; i < end; i++) {
+                workers.QueueWork([&job, i] { job(i); });
+            }
+            workers.WaitForRequests();
+            if (callback) {
+                callback(stage, end, count);
+            }
+        }
+    };
+
+    struct ShaderJob {
+        ProgramType stage;
+        u64 hash;
+        vk::ShaderModule module{};
+    };
+    std::vector<ShaderJob> shader_jobs;
+    shader_jobs.reserve(recorded_vs.size() + recorded_fs.size() + recorded_gs.size());
+    for (const auto& [hash, vs] : recorded_vs) {
+        shader_jobs.push_back({ProgramType::VS, hash});
+    }
+    for (const auto& [hash, config] : recorded_fs) {
+        shader_jobs.push_back({ProgramType::FS, hash});
+    }
+    for (const auto& [hash, config] : recorded_gs) {
+        shader_jobs.push_back({ProgramType::GS, hash});
+    }
+
+    const bool use_spirv = Settings::values.spirv_shader_gen;
+    run_batched(shader_jobs.size(), VideoCore::LoadCallbackStage::Decompile,
+                [&](std::size_t i) {
+                    ShaderJob& job = shader_jobs[i];
+                    switch (job.stage) {
+                    case ProgramType::VS:
+                        job.module = Compile(recorded_vs.at(job.hash).second,
+                                             vk::ShaderStageFlagBits::eVertex, device,
+                                             ShaderOptimization::High);
+                        break;
+                    case ProgramType::FS: {
+                        const PicaFSConfig config{recorded_fs.at(job.hash)};
+                        job.module = use_spirv ? CompileSPV(GenerateFragmentShaderSPV(config), device)
+                                               : Compile(GenerateFragmentShader(config),
+                                                         vk::ShaderStageFlagBits::eFragment,
+                                                         device, ShaderOptimization::High);
+                        break;
+                    }
+                    case ProgramType::GS: {
+                        const PicaFixedGSConfig config{recorded_gs.at(job.hash)};
+                        job.module = Compile(GenerateFixedGeometryShader(config),
+                                             vk::ShaderStageFlagBits::eGeometry, device,
+                                             ShaderOptimization::High);
+                        break;
+                    }
+                    }
+                });
+
+    // Hand the modules over to the shader caches, so that the draws find them
+    std::array<std::unordered_map<u64, vk::ShaderModule>, MAX_SHADER_STAGES> modules;
+    for (const ShaderJob& job : shader_jobs) {
+        if (!job.module) {
+            continue;
+        }
+        vk::ShaderModule module = job.module;
+        switch (job.stage) {
+        case ProgramType::VS: {
+            const auto& [state, code] = recorded_vs.at(job.hash);
+            const PicaVSConfig config{state};
+            programmable_vertex_shaders.Inject(config, code, vk::ShaderModule{module});
+            // Configs with identical code share the module that was injected first
+            module = *programmable_vertex_shaders.shader_map.at(config);
+            if (module != job.module) {
+                device.destroyShaderModule(job.module);
+            }
+            break;
+        }
+        case ProgramType::FS: {
+            const PicaFSConfig config{recorded_fs.at(job.hash)};
+            if (use_spirv) {
+                fragment_shaders_spv.Inject(config, vk::ShaderModule{module});
+            } else {
+                fragment_shaders_glsl.Inject(config, vk::ShaderModule{module});
+            }
+            break;
+        }
+        case ProgramType::GS:
+            fixed_geometry_shaders.Inject(PicaFixedGSConfig{recorded_gs.at(job.hash)},
+                                          vk::ShaderModule{module});
+            break;
+        }
+        modules[job.stage].emplace(job.hash, module);
+    }
+
+    struct PipelineJob {
+        u64 hash;
+        const PipelineInfo* info;
+        std::array<vk::ShaderModule, MAX_SHADER_STAGES> shaders{};
+        vk::Pipeline pipeline{};
+    };
+    std::vector<PipelineJob> pipeline_jobs;
+    std::vector<PipelineKey> valid_keys;
+    pipeline_jobs.reserve(recorded_pipelines.size());
+    valid_keys.reserve(recorded_pipelines.size());
+    for (const PipelineKey& key : recorded_pipelines) {
+        const u64 pipeline_hash = ComputePipelineHash(key.info, key.shader_hashes);
+        if (graphics_pipelines.contains(pipeline_hash)) {
+            continue;
+        }
+
+        PipelineJob job{pipeline_hash, nullptr};
+        bool has_shaders = true;
+        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+            const u64 shader_hash = key.shader_hashes[i];
+            // A zero hash denotes the trivial vertex shader or the absence of a geometry shader
+            if (shader_hash == 0 && i != ProgramType::FS) {
+                job.shaders[i] = i == ProgramType::VS ? trivial_vertex_shader : vk::ShaderModule{};
+                continue;
+            }
+            const auto it = modules[i].find(shader_hash);
+            if (it == modules[i].end()) {
+                has_shaders = false;
+                break;
+            }
+            job.shaders[i] = it->second;
+        }
+
+        // Drop pipelines whose shaders failed to compile, they are recorded again when used
+        if (has_shaders) {
+            graphics_pipelines.emplace(pipeline_hash, vk::Pipeline{});
+            valid_keys.push_back(key);
+            pipeline_jobs.push_back(job);
+        }
+    }
+    recorded_pipelines = std::move(valid_keys);
+    for (std::size_t i = 0; i < pipeline_jobs.size(); i++) {
+        pipeline_jobs[i].info = &recorded_pipelines[i].info;
+    }
+
+    run_batched(pipeline_jobs.size(), VideoCore::LoadCallbackStage::Build, [&](std::size_t i) {
+        PipelineJob& job = pipeline_jobs[i];
+        job.pipeline = BuildPipeline(*job.info, job.shaders);
+    });
+
+    std::size_t num_built = 0;
+    for (const PipelineJob& job : pipeline_jobs) {
+        if (job.pipeline) {
+            graphics_pipelines[job.hash] = job.pipeline;
+            num_built++;
+        } else {
+            // Loading was stopped before the pipeline was built
+            graphics_pipelines.erase(job.hash);
+        }
+    }
+    LOG_INFO(Render_Vulkan, "Built {} of {} recorded pipelines", num_built, pipeline_jobs.size());
+
+    if (callback) {
+        callback(VideoCore::LoadCallbackStage::Complete, 0, 0);
+    }
+}
+
+void PipelineCache::LoadPipelineList() {
+    if (pipeline_list_path.empty()) {
+        return;
+    }
+
+    FileUtil::IOFile file{pipeline_list_path, "rb"};
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "No pipeline list found for the title");
+        return;
+    }
+
+    const auto read_object = [&file](auto& object) {
+        return file.ReadBytes(&object, sizeof(object)) == sizeof(object);
+    };
+
+    u32 version{};
+    ShaderCacheVersionHash version_hash{};
+    if (!read_object(version) || !read_object(version_hash) || version != PipelineListVersion ||
+        version_hash != GetShaderCacheVersionHash()) {
+        LOG_INFO(Render_Vulkan, "Pipeline list is from a different version, ignoring");
+        return;
+    }
+
+    const auto read_list = [&]() {
+        u32 count{};
+        if (!read_object(count)) {
+            return false;
+        }
+        for (u32 i = 0; i < count; i++) {
+            PicaShaderConfigCommon state;
+            u32 code_size{};
+            if (!read_object(state) || !read_object(code_size)) {
+                return false;
+            }
+            std::string code(code_size, '\0');
+            if (file.ReadArray(code.data(), code_size) != code_size) {
+                return false;
+            }
+            recorded_vs.try_emplace(PicaVSConfig{state}.Hash(), state, std::move(code));
+        }
+
+        if (!read_object(count)) {
+            return false;
+        }
+        for (u32 i = 0; i < count; i++) {
+            PicaFSConfigState state;
+            if (!read_object(state)) {
+                return false;
+            }
+            recorded_fs.try_emplace(PicaFSConfig{state}.Hash(), state);
+        }
+
+        if (!read_object(count)) {
+            return false;
+        }
+        for (u32 i = 0; i < count; i++) {
+            PicaGSConfigCommonRaw state;
+            if (!read_object(state)) {
+                return false;
+            }
+            recorded_gs.try_emplace(PicaFixedGSConfig{state}.Hash(), state);
+        }
+
+        if (!read_object(count)) {
+            return false;
+        }
+        recorded_pipelines.resize(count);
+        return file.ReadArray(recorded_pipelines.data(), count) == count;
+    };
+
+    if (!read_list()) {
+        LOG_ERROR(Render_Vulkan, "Failed to read the pipeline list, ignoring");
+        recorded_vs.clear();
+        recorded_fs.clear();
+        recorded_gs.clear();
+        recorded_pipelines.clear();
+        return;
+    }
+
+    LOG_INFO(Render_Vulkan, "Loaded {} recorded pipelines", recorded_pipelines.size());
+}
+
+void PipelineCache::SavePipelineList() {
+    if (pipeline_list_path.empty() || recorded_pipelines.empty()) {
+        return;
+    }
+
+    FileUtil::IOFile file{pipeline_list_path, "wb"};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Unable to open pipeline list for writing");
+        return;
+    }
+
+    const auto write_object = [&file](const auto& object) {
+        return file.WriteBytes(&object, sizeof(object)) == sizeof(object);
+    };
+
+    const auto write_list = [&]() {
+        if (!write_object(PipelineListVersion) || !write_object(GetShaderCacheVersionHash())) {
+            return false;
+        }
+
+        if (!write_object(static_cast<u32>(recorded_vs.size()))) {
+            return false;
+        }
+        for (const auto& [hash, vs] : recorded_vs) {
+            const auto& [state, code] = vs;
+            const u32 code_size = static_cast<u32>(code.size());
+            if (!write_object(state) || !write_object(code_size) ||
+                file.WriteArray(code.data(), code_size) != code_size) {
+                return false;
+            }
+        }
+
+        if (!write_object(static_cast<u32>(recorded_fs.size()))) {
+            return false;
+        }
+        for (const auto& [hash, state] : recorded_fs) {
+            if (!write_object(state)) {
+                return false;
+            }
+        }
+
+        if (!write_object(static_cast<u32>(recorded_gs.size()))) {
+            return false;
+        }
+        for (const auto& [hash, state] : recorded_gs) {
+            if (!write_object(state)) {
+                return false;
+            }
+        }
+
+        const u32 count = static_cast<u32>(recorded_pipelines.size());
+        return write_object(count) &&
+               file.WriteArray(recorded_pipelines.data(), count) == count;
+    };
+
+    if (!write_list()) {
+        LOG_ERROR(Render_Vulkan, "Error during pipeline list write");
+    }
+}
+
 bool PipelineCache::IsCacheValid(const u8* data, u64 size) const {
     if (size < sizeof(vk::PipelineCacheHeaderVersionOne)) {
         LOG_ERROR(Render_Vulkan, "Pipeline cache failed validation: Invalid header");
@@ -629,11 +1141,25 @@ bool PipelineCache::EnsureDirectories() const {
     };
 
     return CreateDir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
-           CreateDir(GetPipelineCacheDir());
+           CreateDir(GetPipelineCacheDir()) && CreateDir(GetPipelineListDir());
 }
 
 std::string PipelineCache::GetPipelineCacheDir() const {
     return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + "vulkan" + DIR_SEP;
 }
 
+std::string PipelineCache::GetPipelineListDir() const {
+    return GetPipelineCacheDir() + "pipelines" + DIR_SEP;
+}
+
+std::string PipelineCache::GetPipelineListPath() const {
+    u64 program_id{};
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+            Loader::ResultStatus::Success ||
+        program_id == 0) {
+        return {};
+    }
+    return fmt::format("{}{:016X}.bin", GetPipelineListDir(), program_id);
+}
+
 } // namespace Vulkan
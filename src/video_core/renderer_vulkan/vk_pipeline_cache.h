@@ -5,14 +5,27 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/hash.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/regs.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
 #include "video_core/renderer_vulkan/vk_shader_gen_spv.h"
 #include "video_core/shader/shader_cache.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace Vulkan {
 
 constexpr u32 MAX_SHADER_STAGES = 3;
@@ -107,6 +120,16 @@ struct PipelineInfo {
     }
 };
 
+/**
+ * Identifies a rasterizer pipeline by its state and the config hashes of its shader stages.
+ * These are recorded for each title, so that its pipelines can be built ahead of time.
+ */
+struct PipelineKey {
+    PipelineInfo info;
+    std::array<u64, MAX_SHADER_STAGES> shader_hashes;
+};
+static_assert(std::is_trivially_copyable_v<PipelineKey>, "PipelineKey is not trivially copyable");
+
 /**
  * Vulkan specialized PICA shader caches
  */
@@ -136,10 +159,11 @@ public:
                   RenderpassCache& renderpass_cache, DescriptorManager& desc_manager);
     ~PipelineCache();
 
-    /// Loads the pipeline cache stored to disk
-    void LoadDiskCache();
+    /// Loads the pipeline cache stored to disk and builds the pipelines used by the title
+    void LoadDiskCache(const std::atomic_bool& stop_loading,
+                       const VideoCore::DiskResourceLoadCallback& callback);
 
-    /// Stores the generated pipeline cache to disk
+    /// Stores the generated pipeline cache and the pipelines used by the title to disk
     void SaveDiskCache();
 
     /// Binds a pipeline using the provided information
@@ -161,6 +185,23 @@ public:
     /// Binds a fragment shader generated from PICA state
     void UseFragmentShader(const Pica::Regs& regs);
 
+    /// Returns whether missing fragment shaders may be replaced by the fragment ubershader
+    bool IsUberShaderEnabled() const {
+        return uber_shader != VK_NULL_HANDLE;
+    }
+
+    /// Returns whether the last recorded UseFragmentShader selected the fragment ubershader
+    bool IsUsingUberShader() const {
+        return using_uber_shader.load(std::memory_order_relaxed);
+    }
+
+    /// Returns false when the bound pipeline could not be built and draws must be skipped.
+    /// Pipelines that are still being built are replaced by the ubershader pipeline, so they
+    /// don't skip draws. Only valid inside recorded commands.
+    bool IsPipelineReady() const {
+        return current_pipeline != VK_NULL_HANDLE;
+    }
+
     /// Binds a texture to the specified binding
     void BindTexture(u32 binding, vk::ImageView image_view);
 
@@ -189,8 +230,39 @@ private:
     /// Builds the rasterizer pipeline layout
     void BuildLayout();
 
-    /// Builds a rasterizer pipeline using the PipelineInfo struct
-    vk::Pipeline BuildPipeline(const PipelineInfo& info);
+    /// Returns the hash identifying the pipeline built from the provided state and shaders
+    u64 ComputePipelineHash(const PipelineInfo& info,
+                            const std::array<u64, MAX_SHADER_STAGES>& hashes) const;
+
+    /// Builds a rasterizer pipeline using the PipelineInfo struct and the provided shader modules
+    vk::Pipeline BuildPipeline(const PipelineInfo& info,
+                               const std::array<vk::ShaderModule, MAX_SHADER_STAGES>& shaders);
+
+    /// Queues the creation of a pipeline on the compiler threads
+    void QueuePipeline(u64 pipeline_hash, const PipelineInfo& info);
+
+    /// Adds the pipelines built in the background to the cache
+    void InjectCompiledPipelines();
+
+    /// Returns the pipeline with the current shaders and the fragment ubershader, building it
+    /// when it is missing
+    vk::Pipeline GetUberShaderPipeline(const PipelineInfo& info);
+
+    /// Builds the shaders and pipelines recorded by a previous session on the compiler threads
+    void BuildRecordedPipelines(const std::atomic_bool& stop_loading,
+                                const VideoCore::DiskResourceLoadCallback& callback);
+
+    /// Loads the shader configs and pipeline keys recorded for the title
+    void LoadPipelineList();
+
+    /// Stores the shader configs and pipeline keys recorded for the title
+    void SavePipelineList();
+
+    /// Queues the compilation of a fragment shader on the compiler threads
+    void QueueFragmentShader(const PicaFSConfig& config);
+
+    /// Adds the fragment shaders compiled in the background to the cache
+    void InjectCompiledFragmentShaders();
 
     /// Returns true when the disk data can be used by the current driver
     bool IsCacheValid(const u8* data, u64 size) const;
@@ -201,6 +273,12 @@ private:
     /// Returns the pipeline cache storage dir
     std::string GetPipelineCacheDir() const;
 
+    /// Returns the path of the pipeline list of the running title, or an empty string
+    std::string GetPipelineListPath() const;
+
+    /// Returns the pipeline list storage dir
+    std::string GetPipelineListDir() const;
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -223,6 +301,25 @@ private:
     FragmentShadersGLSL fragment_shaders_glsl;
     FragmentShadersSPV fragment_shaders_spv;
     vk::ShaderModule trivial_vertex_shader;
+
+    // Background fragment shader compilation
+    vk::ShaderModule uber_shader{};
+    std::atomic_bool using_uber_shader{false};
+    bool fs_uber_compatible = false;
+    std::unordered_set<PicaFSConfig> pending_fragment_shaders;
+    std::mutex compiled_mutex;
+    std::vector<std::pair<PicaFSConfig, vk::ShaderModule>> compiled_fragment_shaders;
+    std::atomic_bool stop_compiling{false};
+    std::mutex built_mutex;
+    std::vector<std::pair<u64, vk::Pipeline>> built_pipelines;
+    std::unique_ptr<Common::ThreadWorker> compile_worker;
+
+    // Shader configs and pipelines used by the title, stored for the next boot
+    std::unordered_map<u64, std::pair<PicaShaderConfigCommon, std::string>> recorded_vs;
+    std::unordered_map<u64, PicaFSConfigState> recorded_fs;
+    std::unordered_map<u64, PicaGSConfigCommonRaw> recorded_gs;
+    std::vector<PipelineKey> recorded_pipelines;
+    std::string pipeline_list_path;
 };
 
 } // namespace Vulkan
@@ -15,6 +15,7 @@
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/shader/shader_uniforms.h"
 #include "video_core/video_core.h"
 
 #include <vk_mem_alloc.h>
@@ -70,6 +71,8 @@ RasterizerVulkan::RasterizerVulkan(Frontend::EmuWindow& emu_window, const Instan
         Common::AlignUp<std::size_t>(sizeof(Pica::Shader::VSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(Pica::Shader::UniformData), uniform_buffer_alignment);
+    uniform_size_aligned_uber = Common::AlignUp<std::size_t>(sizeof(Pica::Shader::UberShaderData),
+                                                             uniform_buffer_alignment);
 
     // Define vertex layout for software shaders
     MakeSoftwareVertexLayout();
@@ -93,6 +96,8 @@ RasterizerVulkan::RasterizerVulkan(Frontend::EmuWindow& emu_window, const Instan
     pipeline_cache.BindTexelBuffer(2, texture_lf_buffer.GetView());
     pipeline_cache.BindTexelBuffer(3, texture_buffer.GetView(0));
     pipeline_cache.BindTexelBuffer(4, texture_buffer.GetView(1));
+    pipeline_cache.BindBuffer(5, uniform_buffer.GetHandle(), 0,
+                              sizeof(Pica::Shader::UberShaderData));
 
     for (u32 i = 0; i < 4; i++) {
         pipeline_cache.BindTexture(i, null_surface.GetImageView());
@@ -126,7 +131,7 @@ RasterizerVulkan::~RasterizerVulkan() {
 
 void RasterizerVulkan::LoadDiskResources(const std::atomic_bool& stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
-    pipeline_cache.LoadDiskCache();
+    pipeline_cache.LoadDiskCache(stop_loading, callback);
 }
 
 void RasterizerVulkan::SyncEntireState() {
@@ -350,6 +355,10 @@ bool RasterizerVulkan::SetupGeometryShader() {
     return true;
 }
 
+bool RasterizerVulkan::FitsDrawBatch(std::size_t vs_input_size, std::size_t index_size) const {
+    return vs_input_size <= VERTEX_BUFFER_SIZE && index_size <= INDEX_BUFFER_SIZE;
+}
+
 bool RasterizerVulkan::AccelerateDrawBatch(bool is_indexed) {
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
@@ -407,12 +416,18 @@ bool RasterizerVulkan::AccelerateDrawBatchInternal(bool is_indexed) {
 
         scheduler.Record([this, offset = index_offset, num_vertices = regs.pipeline.num_vertices,
                          index_u16, vertex_offset = vs_input_index_min](vk::CommandBuffer render_cmdbuf, vk::CommandBuffer) {
+            if (!pipeline_cache.IsPipelineReady()) {
+                return;
+            }
             const vk::IndexType index_type = index_u16 ? vk::IndexType::eUint16 : vk::IndexType::eUint8EXT;
             render_cmdbuf.bindIndexBuffer(index_buffer.GetHandle(), offset, index_type);
             render_cmdbuf.drawIndexed(num_vertices, 1, 0, -vertex_offset, 0);
         });
     } else {
-        scheduler.Record([num_vertices = regs.pipeline.num_vertices](vk::CommandBuffer render_cmdbuf, vk::CommandBuffer) {
+        scheduler.Record([this, num_vertices = regs.pipeline.num_vertices](vk::CommandBuffer render_cmdbuf, vk::CommandBuffer) {
+            if (!pipeline_cache.IsPipelineReady()) {
+                return;
+            }
             render_cmdbuf.draw(num_vertices, 1, 0, 0);
         });
     }
@@ -658,8 +673,10 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
                                viewport_rect_unscaled.GetWidth() * res_scale,
                                viewport_rect_unscaled.GetHeight() * res_scale);
 
-    // Sync and bind the shader
-    if (shader_dirty) {
+    // Sync and bind the shader. While the ubershader is in use, keep checking whether the
+    // specialized shader has finished compiling.
+    if (shader_dirty || pipeline_cache.IsUsingUberShader()) {
+        uber_shader_data_dirty |= shader_dirty;
         pipeline_cache.UseFragmentShader(regs);
         shader_dirty = false;
     }
@@ -747,6 +764,9 @@ bool RasterizerVulkan::Draw(bool accelerate, bool is_indexed) {
 
             scheduler.Record([this, vertices, base_vertex,
                              offset = offset](vk::CommandBuffer render_cmdbuf, vk::CommandBuffer){
+                if (!pipeline_cache.IsPipelineReady()) {
+                    return;
+                }
                 render_cmdbuf.bindVertexBuffers(0, vertex_buffer.GetHandle(), offset);
                 render_cmdbuf.draw(vertices, 1, base_vertex, 0);
             });
@@ -871,6 +891,25 @@ void RasterizerVulkan::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
+void RasterizerVulkan::TickFrame() {
+    MICROPROFILE_SCOPE(Vulkan_CacheManagement);
+    res_cache.TickFrame();
+
+    // Drop the framebuffers of the textures released by the cache, before their views are
+    // destroyed and their handles reused
+    if (runtime.HasReleasedViews()) {
+        std::erase_if(framebuffers, [this](const auto& pair) {
+            const auto& [info, framebuffer] = pair;
+            if (!runtime.IsViewReleased(info.color) && !runtime.IsViewReleased(info.depth)) {
+                return false;
+            }
+            runtime.DestroyFramebuffer(framebuffer);
+            return true;
+        });
+    }
+    runtime.DestroyReleasedResources();
+}
+
 MICROPROFILE_DEFINE(Vulkan_Blits, "Vulkan", "Blits", MP_RGB(100, 100, 255));
 bool RasterizerVulkan::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     MICROPROFILE_SCOPE(Vulkan_Blits);
@@ -1427,13 +1466,18 @@ void RasterizerVulkan::SyncAndUploadLUTs() {
 void RasterizerVulkan::UploadUniforms(bool accelerate_draw) {
     const bool sync_vs = accelerate_draw;
     const bool sync_fs = uniform_block_data.dirty;
+    // The shader is selected on the scheduler thread, so keep the ubershader state up to date
+    // whenever it might be picked
+    const bool use_uber = pipeline_cache.IsUberShaderEnabled();
+    const bool sync_uber = use_uber && uber_shader_data_dirty;
 
-    if (!sync_vs && !sync_fs) {
+    if (!sync_vs && !sync_fs && !sync_uber) {
         return;
     }
 
     u32 used_bytes = 0;
-    const u32 uniform_size = static_cast<u32>(uniform_size_aligned_vs + uniform_size_aligned_fs);
+    const u32 uniform_size = static_cast<u32>(uniform_size_aligned_vs + uniform_size_aligned_fs +
+                                              uniform_size_aligned_uber);
     auto [uniforms, offset, invalidate] =
         uniform_buffer.Map(uniform_size, static_cast<u32>(uniform_buffer_alignment));
 
@@ -1457,6 +1501,17 @@ void RasterizerVulkan::UploadUniforms(bool accelerate_draw) {
         used_bytes += static_cast<u32>(uniform_size_aligned_fs);
     }
 
+    if (sync_uber || (use_uber && invalidate)) {
+        Pica::Shader::UberShaderData uber_data;
+        uber_data.SetFromRegs(Pica::g_state.regs);
+        std::memcpy(uniforms + used_bytes, &uber_data, sizeof(uber_data));
+
+        pipeline_cache.BindBuffer(5, uniform_buffer.GetHandle(), offset + used_bytes,
+                                  sizeof(uber_data));
+        uber_shader_data_dirty = false;
+        used_bytes += static_cast<u32>(uniform_size_aligned_uber);
+    }
+
     uniform_buffer.Commit(used_bytes);
 }
 
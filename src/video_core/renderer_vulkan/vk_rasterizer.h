@@ -88,12 +88,14 @@ public:
     void FlushRegion(PAddr addr, u32 size) override;
     void InvalidateRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void TickFrame() override;
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info);
     bool AccelerateDrawBatch(bool is_indexed) override;
+    bool FitsDrawBatch(std::size_t vs_input_size, std::size_t index_size) const override;
 
     /// Syncs entire status to match PICA registers
     void SyncEntireState() override;
@@ -207,6 +209,9 @@ private:
     std::size_t uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
     std::size_t uniform_size_aligned_fs;
+    std::size_t uniform_size_aligned_uber;
+    /// Whether the ubershader state has to be uploaded before the next draw that may use it
+    bool uber_shader_data_dirty = true;
 };
 
 } // namespace Vulkan
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <utility>
 #include "common/microprofile.h"
+#include "common/scope_exit.h"
 #include "core/settings.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -91,7 +92,10 @@ void Scheduler::DispatchWork() {
     AcquireNewChunk();
 }
 
+MICROPROFILE_DEFINE(Vulkan_Record, "Vulkan", "Record Commands", MP_RGB(192, 192, 255));
 void Scheduler::WorkerThread() {
+    MicroProfileOnThreadCreate("VulkanWorker");
+    SCOPE_EXIT({ MicroProfileOnThreadExit(); });
     do {
         std::unique_ptr<CommandChunk> work;
         bool has_submit{false};
@@ -108,6 +112,7 @@ void Scheduler::WorkerThread() {
             work_queue.pop();
 
             has_submit = work->HasSubmit();
+            MICROPROFILE_SCOPE(Vulkan_Record);
             work->ExecuteAll(render_cmdbuf, upload_cmdbuf);
         }
         if (has_submit) {
@@ -135,6 +135,9 @@ struct PicaFSConfigState {
  */
 struct PicaFSConfig : Common::HashableStruct<PicaFSConfigState> {
     PicaFSConfig(const Pica::Regs& regs, const Instance& instance);
+    explicit PicaFSConfig(const PicaFSConfigState& conf) {
+        state = conf;
+    }
 
     bool TevStageUpdatesCombinerBufferColor(unsigned stage_index) const {
         return (stage_index < 4) && (state.combiner_buffer_input & (1 << stage_index));
@@ -201,6 +204,9 @@ struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigCommonRaw> {
     explicit PicaFixedGSConfig(const Pica::Regs& regs) {
         state.Init(regs);
     }
+    explicit PicaFixedGSConfig(const PicaGSConfigCommonRaw& conf) {
+        state = conf;
+    }
 };
 
 /**
@@ -233,6 +239,14 @@ std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config);
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config);
 
+/**
+ * Generates the GLSL fragment ubershader program source code. Instead of baking the Pica state
+ * into the code, it reads it from the uber_data uniform block, so a single module can render any
+ * configuration accepted by Pica::Shader::CanUseUberShader.
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader();
+
 } // namespace Vulkan
 
 namespace std {
@@ -137,21 +137,18 @@ EShLanguage ToEshShaderStage(vk::ShaderStageFlagBits stage) {
 }
 
 bool InitializeCompiler() {
-    static bool glslang_initialized = false;
-
-    if (glslang_initialized) {
+    // Shaders may be compiled from several threads, so initialize glslang exactly once
+    static const bool glslang_initialized = [] {
+        if (!glslang::InitializeProcess()) {
+            LOG_CRITICAL(Render_Vulkan, "Failed to initialize glslang shader compiler");
+            return false;
+        }
+
+        std::atexit([]() { glslang::FinalizeProcess(); });
         return true;
-    }
-
-    if (!glslang::InitializeProcess()) {
-        LOG_CRITICAL(Render_Vulkan, "Failed to initialize glslang shader compiler");
-        return false;
-    }
-
-    std::atexit([]() { glslang::FinalizeProcess(); });
+    }();
 
-    glslang_initialized = true;
-    return true;
+    return glslang_initialized;
 }
 
 vk::ShaderModule Compile(std::string_view code, vk::ShaderStageFlagBits stage, vk::Device device,
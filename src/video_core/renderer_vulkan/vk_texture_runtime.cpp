@@ -80,29 +80,25 @@ TextureRuntime::TextureRuntime(const Instance& instance, Scheduler& scheduler,
 }
 
 TextureRuntime::~TextureRuntime() {
-    VmaAllocator allocator = instance.GetAllocator();
     vk::Device device = instance.GetDevice();
     device.waitIdle();
 
     for (const auto& [key, alloc] : texture_recycler) {
-        vmaDestroyImage(allocator, alloc.image, alloc.allocation);
-        device.destroyImageView(alloc.image_view);
-        if (alloc.base_view) {
-            device.destroyImageView(alloc.base_view);
-        }
-        if (alloc.depth_view) {
-            device.destroyImageView(alloc.depth_view);
-            device.destroyImageView(alloc.stencil_view);
-        }
-        if (alloc.storage_view) {
-            device.destroyImageView(alloc.storage_view);
-        }
+        DestroyAlloc(alloc);
+    }
+
+    for (const auto& [tick, alloc] : released_textures) {
+        DestroyAlloc(alloc);
     }
 
     for (const auto& [key, framebuffer] : clear_framebuffers) {
         device.destroyFramebuffer(framebuffer);
     }
 
+    for (const auto& [tick, framebuffer] : released_framebuffers) {
+        device.destroyFramebuffer(framebuffer);
+    }
+
     texture_recycler.clear();
 }
 
@@ -128,6 +124,18 @@ void TextureRuntime::Finish() {
     download_buffer.Invalidate();
 }
 
+u64 TextureRuntime::SubmitDownloads() {
+    const u64 tick = scheduler.CurrentTick();
+    scheduler.Flush();
+    return tick;
+}
+
+void TextureRuntime::WaitDownloads(u64 tick) {
+    MICROPROFILE_SCOPE(Vulkan_Finish);
+    scheduler.Wait(tick);
+    download_buffer.Invalidate();
+}
+
 ImageAlloc TextureRuntime::Allocate(u32 width, u32 height, VideoCore::PixelFormat format,
                                     VideoCore::TextureType type) {
     const FormatTraits traits = instance.GetTraits(format);
@@ -276,8 +284,59 @@ void TextureRuntime::Recycle(const HostTextureTag tag, ImageAlloc&& alloc) {
     texture_recycler.emplace(tag, std::move(alloc));
 }
 
-void TextureRuntime::FormatConvert(const Surface& surface, bool upload, std::span<std::byte> source,
-                                   std::span<std::byte> dest) {
+void TextureRuntime::ReleaseRecycledTextures() {
+    const u64 tick = scheduler.CurrentTick();
+    for (auto& [tag, alloc] : texture_recycler) {
+        // Surfaces are attached to framebuffers through their base view
+        if (const vk::ImageView view = alloc.base_view) {
+            if (const auto it = clear_framebuffers.find(view); it != clear_framebuffers.end()) {
+                DestroyFramebuffer(it->second);
+                clear_framebuffers.erase(it);
+            }
+            released_views.insert(view);
+        }
+        released_textures.emplace_back(tick, std::move(alloc));
+    }
+    texture_recycler.clear();
+}
+
+void TextureRuntime::DestroyFramebuffer(vk::Framebuffer framebuffer) {
+    released_framebuffers.emplace_back(scheduler.CurrentTick(), framebuffer);
+}
+
+void TextureRuntime::DestroyReleasedResources() {
+    released_views.clear();
+
+    vk::Device device = instance.GetDevice();
+    while (!released_framebuffers.empty() &&
+           scheduler.IsFree(released_framebuffers.front().first)) {
+        device.destroyFramebuffer(released_framebuffers.front().second);
+        released_framebuffers.pop_front();
+    }
+    while (!released_textures.empty() && scheduler.IsFree(released_textures.front().first)) {
+        DestroyAlloc(released_textures.front().second);
+        released_textures.pop_front();
+    }
+}
+
+void TextureRuntime::DestroyAlloc(const ImageAlloc& alloc) {
+    vk::Device device = instance.GetDevice();
+    vmaDestroyImage(instance.GetAllocator(), alloc.image, alloc.allocation);
+    device.destroyImageView(alloc.image_view);
+    if (alloc.base_view) {
+        device.destroyImageView(alloc.base_view);
+    }
+    if (alloc.depth_view) {
+        device.destroyImageView(alloc.depth_view);
+        device.destroyImageView(alloc.stencil_view);
+    }
+    if (alloc.storage_view) {
+        device.destroyImageView(alloc.storage_view);
+    }
+}
+
+void TextureRuntime::FormatConvert(const Surface& surface, bool upload,
+                                   std::span<const std::byte> source, std::span<std::byte> dest) {
     if (!NeedsConvertion(surface.pixel_format)) {
         std::memcpy(dest.data(), source.data(), source.size());
         return;
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <deque>
 #include <set>
 #include <span>
+#include <unordered_set>
 #include <vulkan/vulkan_hash.hpp>
 #include "video_core/rasterizer_cache/rasterizer_cache.h"
 #include "video_core/rasterizer_cache/surface_base.h"
@@ -95,9 +97,36 @@ public:
     /// Causes a GPU command flush
     void Finish();
 
+    /// Submits the recorded downloads and returns the tick that signals their completion
+    u64 SubmitDownloads();
+
+    /// Blocks until the downloads submitted at the tick are complete
+    void WaitDownloads(u64 tick);
+
     /// Takes back ownership of the allocation for recycling
     void Recycle(const HostTextureTag tag, ImageAlloc&& alloc);
 
+    /// Releases the recycled allocations. They are destroyed by DestroyReleasedResources once
+    /// the GPU has finished the commands recorded so far.
+    void ReleaseRecycledTextures();
+
+    /// Returns true if the view belongs to a texture released since the last
+    /// DestroyReleasedResources, in which case the framebuffers keyed by it must be destroyed
+    [[nodiscard]] bool IsViewReleased(vk::ImageView view) const {
+        return released_views.contains(view);
+    }
+
+    /// Returns true if textures were released since the last DestroyReleasedResources
+    [[nodiscard]] bool HasReleasedViews() const {
+        return !released_views.empty();
+    }
+
+    /// Destroys the framebuffer once the GPU has finished the commands recorded so far
+    void DestroyFramebuffer(vk::Framebuffer framebuffer);
+
+    /// Destroys the released textures and framebuffers the GPU no longer uses
+    void DestroyReleasedResources();
+
     /// Maps an internal staging buffer of the provided size of pixel uploads/downloads
     [[nodiscard]] StagingData FindStaging(u32 size, bool upload);
 
@@ -111,7 +140,7 @@ public:
                                       vk::ImageUsageFlags usage);
 
     /// Performs required format convertions on the staging data
-    void FormatConvert(const Surface& surface, bool upload, std::span<std::byte> source,
+    void FormatConvert(const Surface& surface, bool upload, std::span<const std::byte> source,
                        std::span<std::byte> dest);
 
     /// Transitions the mip level range of the surface to new_layout
@@ -151,6 +180,9 @@ private:
         return scheduler;
     }
 
+    /// Destroys the image and views of the allocation
+    void DestroyAlloc(const ImageAlloc& alloc);
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -162,6 +194,9 @@ private:
     std::array<ReinterpreterList, VideoCore::PIXEL_FORMAT_COUNT> reinterpreters;
     std::unordered_multimap<HostTextureTag, ImageAlloc> texture_recycler;
     std::unordered_map<vk::ImageView, vk::Framebuffer> clear_framebuffers;
+    std::deque<std::pair<u64, ImageAlloc>> released_textures;
+    std::deque<std::pair<u64, vk::Framebuffer>> released_framebuffers;
+    std::unordered_set<vk::ImageView> released_views;
 };
 
 class Surface : public VideoCore::SurfaceBase<Surface> {
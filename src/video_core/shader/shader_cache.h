@@ -7,6 +7,7 @@
 #include <optional>
 #include <tuple>
 #include <unordered_map>
+#include "core/perf_stats.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
@@ -27,6 +28,7 @@ public:
         auto& shader = iter->second;
 
         if (new_shader) {
+            Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
             const auto code = CodeGenerator(config);
             shader = ModuleCompiler(code, args...);
             return shader;
@@ -71,6 +73,7 @@ public:
             auto& shader = iter->second;
 
             if (new_shader) {
+                Core::AddFrameCounter(Core::FrameCounter::ShaderCompiles);
                 shader = ModuleCompiler(program, args...);
             }
 
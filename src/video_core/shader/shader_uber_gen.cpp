@@ -0,0 +1,541 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/shader/shader_uber_gen.h"
+
+namespace Pica::Shader {
+
+/// Declaration of the uber_data block, following its layout qualifiers
+constexpr std::string_view UberShaderBlockDef = R"(uniform uber_data {
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int depthmap_enable;
+    int fog_mode;
+    int fog_flip;
+    int shadow_texture_orthographic;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_config;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_enable_primary_alpha;
+    int lighting_enable_secondary_alpha;
+    int lighting_enable_shadow;
+    int lighting_shadow_primary;
+    int lighting_shadow_secondary;
+    int lighting_shadow_invert;
+    int lighting_shadow_alpha;
+    int lighting_shadow_selector;
+    uvec4 tev_stages[NUM_TEV_STAGES];
+    ivec4 light_config[NUM_LIGHTS];
+    ivec4 lut_config[7];
+    vec4 lut_scale[2];
+};
+)";
+
+/// Mirrors the code the fragment shader generators emit, with the decisions they make from
+/// PicaFSConfig taken at runtime from the uber_data uniform block.
+constexpr std::string_view UberShaderMain = R"(
+vec4 rounded_primary_color;
+vec4 primary_fragment_color = vec4(0.0);
+vec4 secondary_fragment_color = vec4(0.0);
+vec4 combiner_buffer = vec4(0.0);
+vec4 last_tex_env_out = vec4(0.0);
+vec4 tex_color[4];
+
+vec4 SampleTexture0() {
+    switch (texture0_type) {
+    case 0:
+        return textureLod(TEX0, texcoord0, getLod(texcoord0 * vec2(textureSize(TEX0, 0))));
+    case 1:
+        return texture(TEX_CUBE, vec3(texcoord0, texcoord0_w));
+    case 2:
+        return shadowTexture(texcoord0, texcoord0_w);
+    case 3:
+        return textureProj(TEX0, vec3(texcoord0, texcoord0_w));
+    case 4:
+        return shadowTextureCube(texcoord0, texcoord0_w);
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec4 SampleTexture2() {
+    vec2 coord = texture2_use_coord1 != 0 ? texcoord1 : texcoord2;
+    return textureLod(TEX2, coord, getLod(coord * vec2(textureSize(TEX2, 0))));
+}
+
+vec4 GetSource(uint source, int stage) {
+    switch (source) {
+    case 0u:
+        return rounded_primary_color;
+    case 1u:
+        return primary_fragment_color;
+    case 2u:
+        return secondary_fragment_color;
+    case 3u:
+        return tex_color[0];
+    case 4u:
+        return tex_color[1];
+    case 5u:
+        return tex_color[2];
+    case 6u:
+        return tex_color[3];
+    case 13u:
+        return combiner_buffer;
+    case 14u:
+        return const_color[stage];
+    case 15u:
+        return last_tex_env_out;
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec3 GetColorModifier(uint modifier, vec4 value) {
+    switch (modifier) {
+    case 0u:
+        return value.rgb;
+    case 1u:
+        return vec3(1.0) - value.rgb;
+    case 2u:
+        return value.aaa;
+    case 3u:
+        return vec3(1.0) - value.aaa;
+    case 4u:
+        return value.rrr;
+    case 5u:
+        return vec3(1.0) - value.rrr;
+    case 8u:
+        return value.ggg;
+    case 9u:
+        return vec3(1.0) - value.ggg;
+    case 12u:
+        return value.bbb;
+    case 13u:
+        return vec3(1.0) - value.bbb;
+    default:
+        return vec3(0.0);
+    }
+}
+
+float GetAlphaModifier(uint modifier, vec4 value) {
+    switch (modifier) {
+    case 0u:
+        return value.a;
+    case 1u:
+        return 1.0 - value.a;
+    case 2u:
+        return value.r;
+    case 3u:
+        return 1.0 - value.r;
+    case 4u:
+        return value.g;
+    case 5u:
+        return 1.0 - value.g;
+    case 6u:
+        return value.b;
+    case 7u:
+        return 1.0 - value.b;
+    default:
+        return 0.0;
+    }
+}
+
+vec3 ColorCombine(uint op, vec3 c0, vec3 c1, vec3 c2) {
+    vec3 result;
+    switch (op) {
+    case 0u:
+        result = c0;
+        break;
+    case 1u:
+        result = c0 * c1;
+        break;
+    case 2u:
+        result = c0 + c1;
+        break;
+    case 3u:
+        result = c0 + c1 - vec3(0.5);
+        break;
+    case 4u:
+        result = c0 * c2 + c1 * (vec3(1.0) - c2);
+        break;
+    case 5u:
+        result = c0 - c1;
+        break;
+    case 6u:
+    case 7u:
+        result = vec3(dot(c0 - vec3(0.5), c1 - vec3(0.5)) * 4.0);
+        break;
+    case 8u:
+        result = c0 * c1 + c2;
+        break;
+    case 9u:
+        result = min(c0 + c1, vec3(1.0)) * c2;
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float AlphaCombine(uint op, float a0, float a1, float a2) {
+    float result;
+    switch (op) {
+    case 0u:
+        result = a0;
+        break;
+    case 1u:
+        result = a0 * a1;
+        break;
+    case 2u:
+        result = a0 + a1;
+        break;
+    case 3u:
+        result = a0 + a1 - 0.5;
+        break;
+    case 4u:
+        result = a0 * a2 + a1 * (1.0 - a2);
+        break;
+    case 5u:
+        result = a0 - a1;
+        break;
+    case 8u:
+        result = a0 * a1 + a2;
+        break;
+    case 9u:
+        result = min(a0 + a1, 1.0) * a2;
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float GetTevMultiplier(uint scale) {
+    return scale < 3u ? float(1u << scale) : 1.0;
+}
+
+bool AlphaTestFails(int alpha) {
+    switch (alpha_test_func) {
+    case 0:
+        return true;
+    case 2:
+        return alpha != alphatest_ref;
+    case 3:
+        return alpha == alphatest_ref;
+    case 4:
+        return alpha >= alphatest_ref;
+    case 5:
+        return alpha > alphatest_ref;
+    case 6:
+        return alpha <= alphatest_ref;
+    case 7:
+        return alpha < alphatest_ref;
+    default:
+        return false;
+    }
+}
+
+float GetLightingLutValue(int lut, int sampler, bool two_sided, vec3 normal, vec3 tangent,
+                          vec3 light_vector, vec3 spot_dir, vec3 half_vector) {
+    ivec4 config = lut_config[lut];
+    float index;
+    switch (config.z) {
+    case 0:
+        index = dot(normal, normalize(half_vector));
+        break;
+    case 1:
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case 2:
+        index = dot(normal, normalize(view));
+        break;
+    case 3:
+        index = dot(light_vector, normal);
+        break;
+    case 4:
+        index = dot(light_vector, spot_dir);
+        break;
+    case 5:
+        // CP input is only available with configuration 7
+        if (lighting_config == 8) {
+            index = dot(normalize(half_vector) - normal * dot(normal, normalize(half_vector)),
+                        tangent);
+        } else {
+            index = 0.0;
+        }
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    float value;
+    if (config.y != 0) {
+        index = two_sided ? abs(index) : max(index, 0.0);
+        value = LookupLightingLUTUnsigned(sampler, index);
+    } else {
+        value = LookupLightingLUTSigned(sampler, index);
+    }
+    return lut_scale[lut >> 2][lut & 3] * value;
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec3 refl_value = vec3(0.0);
+    float clamp_highlights = 1.0;
+    float geo_factor = 1.0;
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (lighting_bump_mode == 1) {
+        surface_normal = 2.0 * tex_color[lighting_bump_selector].rgb - 1.0;
+        if (lighting_bump_renorm != 0) {
+            surface_normal.z = sqrt(max(1.0 - (surface_normal.x * surface_normal.x +
+                                               surface_normal.y * surface_normal.y), 0.0));
+        }
+    } else if (lighting_bump_mode == 2) {
+        surface_tangent = 2.0 * tex_color[lighting_bump_selector].rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    vec3 normal = quaternion_rotate(normalized_normquat, surface_normal);
+    vec3 tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (lighting_enable_shadow != 0) {
+        shadow = tex_color[lighting_shadow_selector];
+        if (lighting_shadow_invert != 0) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    for (int light_index = 0; light_index < lighting_src_num; ++light_index) {
+        int num = light_config[light_index].x;
+        int flags = light_config[light_index].y;
+        LightSrc light = light_src[num];
+        // The specialized shader selects the two-sided flag of the LUT inputs by light number
+        bool lut_two_sided = (light_config[num].y & 2) != 0;
+
+        vec3 light_vector = (flags & 1) != 0 ? normalize(light.position)
+                                             : normalize(light.position + view);
+        vec3 spot_dir = light.spot_direction;
+        vec3 half_vector = normalize(view) + light_vector;
+        float dot_product = (flags & 2) != 0 ? abs(dot(light_vector, normal))
+                                             : max(dot(light_vector, normal), 0.0);
+        if (lighting_clamp_highlights != 0) {
+            clamp_highlights = sign(dot_product);
+        }
+
+        float spot_atten = 1.0;
+        if ((flags & 8) != 0 && lut_config[2].x != 0) {
+            spot_atten = GetLightingLutValue(2, 8 + num, lut_two_sided, normal, tangent,
+                                             light_vector, spot_dir, half_vector);
+        }
+
+        float dist_atten = 1.0;
+        if ((flags & 4) != 0) {
+            float index = clamp(light.dist_atten_scale * length(-view - light.position) +
+                                light.dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        if ((flags & 48) != 0) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        float d0_lut_value = 1.0;
+        if (lut_config[0].x != 0) {
+            d0_lut_value = GetLightingLutValue(0, 0, lut_two_sided, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        vec3 specular_0 = d0_lut_value * light.specular_0;
+        if ((flags & 16) != 0) {
+            specular_0 *= geo_factor;
+        }
+
+        refl_value.r = 1.0;
+        if (lut_config[6].x != 0) {
+            refl_value.r = GetLightingLutValue(6, 6, lut_two_sided, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        refl_value.g = refl_value.r;
+        if (lut_config[5].x != 0) {
+            refl_value.g = GetLightingLutValue(5, 5, lut_two_sided, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        refl_value.b = refl_value.r;
+        if (lut_config[4].x != 0) {
+            refl_value.b = GetLightingLutValue(4, 4, lut_two_sided, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+
+        float d1_lut_value = 1.0;
+        if (lut_config[1].x != 0) {
+            d1_lut_value = GetLightingLutValue(1, 1, lut_two_sided, normal, tangent, light_vector,
+                                               spot_dir, half_vector);
+        }
+        vec3 specular_1 = d1_lut_value * refl_value * light.specular_1;
+        if ((flags & 32) != 0) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (light_index == lighting_src_num - 1 && lut_config[3].x != 0) {
+            float value = GetLightingLutValue(3, 3, lut_two_sided, normal, tangent, light_vector,
+                                              spot_dir, half_vector);
+            if (lighting_enable_primary_alpha != 0) {
+                diffuse_sum.a = value;
+            }
+            if (lighting_enable_secondary_alpha != 0) {
+                specular_sum.a = value;
+            }
+        }
+
+        bool shadow_enable = (flags & 64) != 0;
+        vec3 shadow_primary = lighting_shadow_primary != 0 && shadow_enable ? shadow.rgb
+                                                                            : vec3(1.0);
+        vec3 shadow_secondary = lighting_shadow_secondary != 0 && shadow_enable ? shadow.rgb
+                                                                                : vec3(1.0);
+
+        diffuse_sum.rgb += ((light.diffuse * dot_product) + light.ambient) * dist_atten *
+                           spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if (lighting_shadow_alpha != 0) {
+        if (lighting_enable_primary_alpha != 0) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if (lighting_enable_secondary_alpha != 0) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+void main() {
+    if (alpha_test_func == 0) {
+        discard;
+    }
+
+    if (scissor_test_mode != 0) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        // Include mode keeps the pixels inside the scissor box, exclude mode the ones outside
+        if (inside == (scissor_test_mode != 3)) {
+            discard;
+        }
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (depthmap_enable == 0) {
+        depth /= gl_FragCoord.w;
+    }
+
+    rounded_primary_color = byteround(primary_color);
+    tex_color[0] = SampleTexture0();
+    tex_color[1] = textureLod(TEX1, texcoord1, getLod(texcoord1 * vec2(textureSize(TEX1, 0))));
+    tex_color[2] = SampleTexture2();
+    tex_color[3] = vec4(0.0);
+
+    if (lighting_enable != 0) {
+        ComputeLighting();
+    }
+
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        uint sources = tev_stages[i].x;
+        uint modifiers = tev_stages[i].y;
+        uint ops = tev_stages[i].z;
+        uint scales = tev_stages[i].w;
+        uint color_op = ops & 0xFu;
+        uint alpha_op = (ops >> 16) & 0xFu;
+
+        vec3 color_results_1 = GetColorModifier(modifiers & 0xFu, GetSource(sources & 0xFu, i));
+        vec3 color_results_2 = GetColorModifier((modifiers >> 4) & 0xFu,
+                                                GetSource((sources >> 4) & 0xFu, i));
+        vec3 color_results_3 = GetColorModifier((modifiers >> 8) & 0xFu,
+                                                GetSource((sources >> 8) & 0xFu, i));
+        // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+        vec3 color_output = byteround(ColorCombine(color_op, color_results_1, color_results_2,
+                                                   color_results_3));
+
+        float alpha_output;
+        if (color_op == 7u) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output[0];
+        } else {
+            float alpha_results_1 = GetAlphaModifier((modifiers >> 12) & 0x7u,
+                                                     GetSource((sources >> 16) & 0xFu, i));
+            float alpha_results_2 = GetAlphaModifier((modifiers >> 16) & 0x7u,
+                                                     GetSource((sources >> 20) & 0xFu, i));
+            float alpha_results_3 = GetAlphaModifier((modifiers >> 20) & 0x7u,
+                                                     GetSource((sources >> 24) & 0xFu, i));
+            alpha_output = byteround(AlphaCombine(alpha_op, alpha_results_1, alpha_results_2,
+                                                  alpha_results_3));
+        }
+
+        last_tex_env_out =
+            vec4(clamp(color_output * GetTevMultiplier(scales & 0x3u), vec3(0.0), vec3(1.0)),
+                 clamp(alpha_output * GetTevMultiplier((scales >> 16) & 0x3u), 0.0, 1.0));
+
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4) {
+            if (((combiner_buffer_input >> i) & 1) != 0) {
+                next_combiner_buffer.rgb = last_tex_env_out.rgb;
+            }
+            if (((combiner_buffer_input >> (i + 4)) & 1) != 0) {
+                next_combiner_buffer.a = last_tex_env_out.a;
+            }
+        }
+    }
+
+    if (AlphaTestFails(int(last_tex_env_out.a * 255.0))) {
+        discard;
+    }
+
+    if (fog_mode == 5) {
+        float fog_index = (fog_flip != 0 ? 1.0 - depth : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    // Round the final fragment color to maintain the PICA's 8 bits of precision
+    color = byteround(last_tex_env_out);
+}
+)";
+
+std::string GenerateUberShaderBlockDef(std::string_view layout) {
+    std::string out = "\nlayout (";
+    out += layout;
+    out += ") ";
+    out += UberShaderBlockDef;
+    return out;
+}
+
+std::string_view GetUberShaderMain() {
+    return UberShaderMain;
+}
+
+} // namespace Pica::Shader
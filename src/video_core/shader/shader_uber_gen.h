@@ -0,0 +1,27 @@
+// Copyright 2023 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Pica::Shader {
+
+/**
+ * Generates the GLSL declaration of the uber_data uniform block, which holds the fragment state
+ * the ubershader reads at runtime (see UberShaderData).
+ * @param layout Layout qualifiers of the block, such as its binding
+ */
+std::string GenerateUberShaderBlockDef(std::string_view layout);
+
+/**
+ * Returns the GLSL body of the fragment ubershader, shared by the OpenGL and Vulkan backends.
+ * The backend must declare the fragment inputs, the shader_data and uber_data blocks and the
+ * lighting and shadow helper functions before it, and define TEX0, TEX1, TEX2 and TEX_CUBE as
+ * the expressions that sample its textures.
+ */
+std::string_view GetUberShaderMain();
+
+} // namespace Pica::Shader
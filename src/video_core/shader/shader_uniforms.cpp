@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include "video_core/regs.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_uniforms.h"
 
@@ -23,4 +24,98 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+void UberShaderData::SetFromRegs(const Pica::Regs& regs) {
+    const auto& output_merger = regs.framebuffer.output_merger;
+    alpha_test_func = static_cast<int>(output_merger.alpha_test.enable
+                                           ? output_merger.alpha_test.func.Value()
+                                           : FramebufferRegs::CompareFunc::Always);
+    scissor_test_mode = static_cast<int>(regs.rasterizer.scissor_test.mode.Value());
+    texture0_type = static_cast<int>(regs.texturing.texture0.type.Value());
+    texture2_use_coord1 = regs.texturing.main_config.texture2_use_coord1 != 0;
+    combiner_buffer_input = regs.texturing.tev_combiner_buffer_input.update_mask_rgb.Value() |
+                            regs.texturing.tev_combiner_buffer_input.update_mask_a.Value() << 4;
+    depthmap_enable = static_cast<int>(regs.rasterizer.depthmap_enable.Value());
+    fog_mode = static_cast<int>(regs.texturing.fog_mode.Value());
+    fog_flip = regs.texturing.fog_flip != 0;
+    shadow_texture_orthographic = regs.texturing.shadow.orthographic != 0;
+
+    const auto& stages = regs.texturing.GetTevStages();
+    for (std::size_t i = 0; i < stages.size(); i++) {
+        const auto& stage = stages[i];
+        tev_stages[i] = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw, stage.scales_raw};
+    }
+
+    const auto& lighting = regs.lighting;
+    lighting_enable = !lighting.disable;
+    lighting_src_num = lighting.max_light_index + 1;
+    lighting_config = static_cast<int>(lighting.config0.config.Value());
+    lighting_bump_mode = static_cast<int>(lighting.config0.bump_mode.Value());
+    lighting_bump_selector = lighting.config0.bump_selector;
+    lighting_bump_renorm = lighting.config0.disable_bump_renorm == 0;
+    lighting_clamp_highlights = lighting.config0.clamp_highlights != 0;
+    lighting_enable_primary_alpha = lighting.config0.enable_primary_alpha != 0;
+    lighting_enable_secondary_alpha = lighting.config0.enable_secondary_alpha != 0;
+    lighting_enable_shadow = lighting.config0.enable_shadow != 0;
+    lighting_shadow_primary = lighting.config0.shadow_primary != 0;
+    lighting_shadow_secondary = lighting.config0.shadow_secondary != 0;
+    lighting_shadow_invert = lighting.config0.shadow_invert != 0;
+    lighting_shadow_alpha = lighting.config0.shadow_alpha != 0;
+    lighting_shadow_selector = lighting.config0.shadow_selector;
+
+    for (int light_index = 0; light_index < 8; ++light_index) {
+        if (light_index >= lighting_src_num) {
+            light_config[light_index] = {};
+            continue;
+        }
+        const unsigned num = lighting.light_enable.GetNum(light_index);
+        const auto& light = lighting.light[num];
+        int flags = 0;
+        flags |= light.config.directional ? Directional : 0;
+        flags |= light.config.two_sided_diffuse ? TwoSidedDiffuse : 0;
+        flags |= !lighting.IsDistAttenDisabled(num) ? DistAttenEnable : 0;
+        flags |= !lighting.IsSpotAttenDisabled(num) ? SpotAttenEnable : 0;
+        flags |= light.config.geometric_factor_0 ? GeometricFactor0 : 0;
+        flags |= light.config.geometric_factor_1 ? GeometricFactor1 : 0;
+        flags |= !lighting.IsShadowDisabled(num) ? ShadowEnable : 0;
+        light_config[light_index] = {static_cast<int>(num), flags, 0, 0};
+    }
+
+    const auto config = lighting.config0.config.Value();
+    const auto set_lut = [&](UberShaderLut lut, LightingRegs::LightingSampler sampler, bool enable,
+                             bool abs_input, LightingRegs::LightingLutInput input,
+                             LightingRegs::LightingScale scale) {
+        const auto index = static_cast<u32>(lut);
+        const bool supported = LightingRegs::IsLightingSamplerSupported(config, sampler);
+        lut_config[index] = {enable && supported, abs_input, static_cast<int>(input), 0};
+        lut_scale[index / 4][index % 4] = lighting.lut_scale.GetScale(scale);
+    };
+    using Sampler = LightingRegs::LightingSampler;
+    set_lut(UberShaderLut::D0, Sampler::Distribution0, lighting.config1.disable_lut_d0 == 0,
+            lighting.abs_lut_input.disable_d0 == 0, lighting.lut_input.d0, lighting.lut_scale.d0);
+    set_lut(UberShaderLut::D1, Sampler::Distribution1, lighting.config1.disable_lut_d1 == 0,
+            lighting.abs_lut_input.disable_d1 == 0, lighting.lut_input.d1, lighting.lut_scale.d1);
+    // There is no register to disable the spotlight LUT, it is enabled per light instead
+    set_lut(UberShaderLut::SP, Sampler::SpotlightAttenuation, true,
+            lighting.abs_lut_input.disable_sp == 0, lighting.lut_input.sp, lighting.lut_scale.sp);
+    set_lut(UberShaderLut::FR, Sampler::Fresnel, lighting.config1.disable_lut_fr == 0,
+            lighting.abs_lut_input.disable_fr == 0, lighting.lut_input.fr, lighting.lut_scale.fr);
+    set_lut(UberShaderLut::RB, Sampler::ReflectBlue, lighting.config1.disable_lut_rb == 0,
+            lighting.abs_lut_input.disable_rb == 0, lighting.lut_input.rb, lighting.lut_scale.rb);
+    set_lut(UberShaderLut::RG, Sampler::ReflectGreen, lighting.config1.disable_lut_rg == 0,
+            lighting.abs_lut_input.disable_rg == 0, lighting.lut_input.rg, lighting.lut_scale.rg);
+    set_lut(UberShaderLut::RR, Sampler::ReflectRed, lighting.config1.disable_lut_rr == 0,
+            lighting.abs_lut_input.disable_rr == 0, lighting.lut_input.rr, lighting.lut_scale.rr);
+}
+
+bool CanUseUberShader(const Pica::Regs& regs) {
+    if (regs.texturing.main_config.texture3_enable) {
+        return false;
+    }
+    if (regs.framebuffer.output_merger.fragment_operation_mode ==
+        FramebufferRegs::FragmentOperationMode::Shadow) {
+        return false;
+    }
+    return regs.texturing.fog_mode != TexturingRegs::FogMode::Gas;
+}
+
 } // namespace Pica::Shader
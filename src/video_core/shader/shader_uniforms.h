@@ -8,8 +8,9 @@
 #include "video_core/regs_lighting.h"
 
 namespace Pica {
+struct Regs;
 struct ShaderRegs;
-}
+} // namespace Pica
 
 namespace Pica::Shader {
 
@@ -95,4 +96,78 @@ static_assert(sizeof(VSUniformData) == 1856,
 static_assert(sizeof(VSUniformData) < 16384,
               "VSUniformData structure must be less than 16kb as per the OpenGL spec");
 
+/**
+ * Uniform struct for the Uniform Buffer Object that describes the fragment pipeline state to the
+ * fragment ubershader. It carries the state that the specialized fragment shaders bake into their
+ * code, so that the ubershader can render any configuration CanUseUberShader accepts while the
+ * specialized shader is compiled in the background.
+ * NOTE: the same rule from UniformData also applies here.
+ */
+struct UberShaderData {
+    void SetFromRegs(const Pica::Regs& regs);
+
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int depthmap_enable;
+    int fog_mode;
+    int fog_flip;
+    int shadow_texture_orthographic;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_config;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_enable_primary_alpha;
+    int lighting_enable_secondary_alpha;
+    int lighting_enable_shadow;
+    int lighting_shadow_primary;
+    int lighting_shadow_secondary;
+    int lighting_shadow_invert;
+    int lighting_shadow_alpha;
+    int lighting_shadow_selector;
+    // Raw sources, modifiers, ops and scales of each TEV stage
+    alignas(16) Common::Vec4u tev_stages[6];
+    // Hardware light number and flags (see UberShaderLightFlags) of each enabled light
+    alignas(16) Common::Vec4i light_config[8];
+    // Enable, absolute input and input selector of each lighting LUT (see UberShaderLut)
+    alignas(16) Common::Vec4i lut_config[7];
+    alignas(16) Common::Vec4f lut_scale[2];
+};
+
+static_assert(sizeof(UberShaderData) == 464,
+              "The size of the UberShaderData does not match the structure in the shader");
+
+/// Flags of UberShaderData::light_config
+enum UberShaderLightFlags : int {
+    Directional = 1 << 0,
+    TwoSidedDiffuse = 1 << 1,
+    DistAttenEnable = 1 << 2,
+    SpotAttenEnable = 1 << 3,
+    GeometricFactor0 = 1 << 4,
+    GeometricFactor1 = 1 << 5,
+    ShadowEnable = 1 << 6,
+};
+
+/// Indices of the lighting LUTs in UberShaderData::lut_config and lut_scale
+enum class UberShaderLut : u32 {
+    D0 = 0,
+    D1 = 1,
+    SP = 2,
+    FR = 3,
+    RB = 4,
+    RG = 5,
+    RR = 6,
+};
+
+/**
+ * Returns whether the fragment ubershader can render the given configuration. Procedural
+ * textures, shadow rendering and gas fog are only implemented by the specialized shaders.
+ */
+bool CanUseUberShader(const Pica::Regs& regs);
+
 } // namespace Pica::Shader
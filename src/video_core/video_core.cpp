@@ -6,6 +6,7 @@
 #include "common/archives.h"
 #include "common/logging/log.h"
 #include "core/settings.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
@@ -39,12 +40,8 @@ Layout::FramebufferLayout g_screenshot_framebuffer_layout;
 
 Memory::MemorySystem* g_memory;
 
-/// Initialize the video core
-ResultStatus Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondary_window,
-                  Memory::MemorySystem& memory) {
-    g_memory = &memory;
-    Pica::Init();
-
+static ResultStatus CreateRenderer(Frontend::EmuWindow& emu_window,
+                                   Frontend::EmuWindow* secondary_window) {
     const Settings::GraphicsAPI graphics_api = Settings::values.graphics_api;
     switch (graphics_api) {
     case Settings::GraphicsAPI::OpenGL:
@@ -60,7 +57,34 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondar
         UNREACHABLE();
     }
 
-    ResultStatus result = g_renderer->Init();
+    return g_renderer->Init();
+}
+
+/// Initialize the video core
+ResultStatus Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondary_window,
+                  Memory::MemorySystem& memory) {
+    g_memory = &memory;
+    Pica::Init();
+
+    std::unique_ptr<Frontend::GraphicsContext> gpu_context;
+    if (Settings::values.use_async_gpu) {
+        gpu_context = emu_window.CreateSharedContext();
+        if (!gpu_context) {
+            LOG_WARNING(Render, "Frontend cannot provide a context for the GPU thread, "
+                                "falling back to synchronous GPU emulation");
+        }
+    }
+
+    ResultStatus result;
+    if (gpu_context) {
+        // The renderer is created on the GPU thread, which owns it from then on
+        g_gpu_thread = std::make_unique<GPUThread>(std::move(gpu_context));
+        g_gpu_thread->PushCommandSync(FunctionCommand{
+            [&] { result = CreateRenderer(emu_window, secondary_window); }});
+    } else {
+        result = CreateRenderer(emu_window, secondary_window);
+    }
+
     if (result != ResultStatus::Success) {
         LOG_ERROR(Render, "Video core initialization failed");
     } else {
@@ -72,10 +96,20 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondar
 
 /// Shutdown the video core
 void Shutdown() {
-    Pica::Shutdown();
+    const auto shutdown = [] {
+        Pica::Shutdown();
 
-    g_renderer->ShutDown();
-    g_renderer.reset();
+        g_renderer->ShutDown();
+        g_renderer.reset();
+    };
+
+    if (g_gpu_thread) {
+        // Queued work is finished before the renderer is destroyed on the GPU thread
+        g_gpu_thread->PushCommandSync(FunctionCommand{shutdown});
+        g_gpu_thread.reset();
+    } else {
+        shutdown();
+    }
 
     LOG_DEBUG(Render, "shutdown OK");
 }
@@ -92,6 +126,19 @@ void RequestScreenshot(void* data, std::function<void()> callback,
     g_renderer_screenshot_requested = true;
 }
 
+void RunOnRenderer(const std::function<void()>& func) {
+    if (g_gpu_thread) {
+        g_gpu_thread->PushCommandSync(FunctionCommand{func});
+    } else {
+        func();
+    }
+}
+
+void LoadDiskResources(const std::atomic_bool& stop_loading,
+                       const DiskResourceLoadCallback& callback) {
+    RunOnRenderer([&] { g_renderer->Rasterizer()->LoadDiskResources(stop_loading, callback); });
+}
+
 u16 GetResolutionScaleFactor() {
     if (g_hw_renderer_enabled) {
         return Settings::values.resolution_factor
@@ -105,6 +152,9 @@ u16 GetResolutionScaleFactor() {
 
 template <class Archive>
 void serialize(Archive& ar, const unsigned int) {
+    if (g_gpu_thread) {
+        g_gpu_thread->WaitIdle();
+    }
     ar& Pica::g_state;
 }
 
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <memory>
 #include "core/frontend/emu_window.h"
+#include "video_core/rasterizer_interface.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -56,6 +57,16 @@ ResultStatus Init(Frontend::EmuWindow& emu_window, Frontend::EmuWindow* secondar
 /// Shutdown the video core
 void Shutdown();
 
+/**
+ * Runs a function that accesses the renderer and waits for it. It runs on the GPU thread if
+ * asynchronous GPU emulation is enabled, as the renderer may only be used from there.
+ */
+void RunOnRenderer(const std::function<void()>& func);
+
+/// Loads the disk shader cache, on the GPU thread if asynchronous GPU emulation is enabled
+void LoadDiskResources(const std::atomic_bool& stop_loading,
+                       const DiskResourceLoadCallback& callback);
+
 /// Request a screenshot of the next frame
 void RequestScreenshot(void* data, std::function<void()> callback,
                        const Layout::FramebufferLayout& layout);